@@ -0,0 +1,201 @@
+#include "TrafficGen.h"
+
+#include <cstring>
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+#include "comm/GcsIdentity.h"
+
+namespace {
+
+struct Rng {
+    uint32_t s;
+
+    uint32_t next() {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        return s;
+    }
+};
+
+enum class Kind {
+    ATTITUDE,
+    POSITION,
+    SYS_STATUS,
+    ESTIMATOR,
+    EXTENDED_STATE,
+    HEARTBEAT,
+    RADIO,
+    STATUSTEXT,
+    COMMAND_ACK,
+    HIGHRES_IMU,        // unhandled
+    SERVO_OUTPUT_RAW    // unhandled
+};
+
+struct Weight {
+    Kind kind;
+    uint32_t weight;
+    bool handled;
+};
+
+// Relative rates of a default PX4 UDP stream set
+constexpr Weight MIX[] = {
+    { Kind::ATTITUDE,         30, true  },
+    { Kind::POSITION,         20, true  },
+    { Kind::SYS_STATUS,        5, true  },
+    { Kind::ESTIMATOR,         5, true  },
+    { Kind::EXTENDED_STATE,    5, true  },
+    { Kind::HEARTBEAT,         2, true  },
+    { Kind::RADIO,             2, true  },
+    { Kind::STATUSTEXT,        1, true  },
+    { Kind::COMMAND_ACK,       1, true  },
+    { Kind::HIGHRES_IMU,      20, false },
+    { Kind::SERVO_OUTPUT_RAW, 10, false },
+};
+
+Kind pick(Rng& rng, bool include_unhandled) {
+    uint32_t total = 0;
+    for (const Weight& w : MIX)
+        if (w.handled || include_unhandled)
+            total += w.weight;
+
+    uint32_t r = rng.next() % total;
+    for (const Weight& w : MIX) {
+        if (!w.handled && !include_unhandled)
+            continue;
+        if (r < w.weight)
+            return w.kind;
+        r -= w.weight;
+    }
+    return Kind::ATTITUDE;
+}
+
+void encode(Kind kind, uint8_t sysid, uint32_t t, mavlink_message_t& msg) {
+    const uint8_t comp = MAV_COMP_ID_AUTOPILOT1;
+
+    switch (kind) {
+    case Kind::ATTITUDE: {
+        mavlink_attitude_t att{};
+        att.time_boot_ms = t;
+        att.roll = 0.1f; att.pitch = -0.2f; att.yaw = 1.5f;
+        att.rollspeed = 0.01f;
+        mavlink_msg_attitude_encode(sysid, comp, &msg, &att);
+        break;
+    }
+    case Kind::POSITION: {
+        mavlink_global_position_int_t pos{};
+        pos.time_boot_ms = t;
+        pos.lat = 473977420 + int32_t(t % 1000);
+        pos.lon = 85455940;
+        pos.alt = 488000; pos.relative_alt = 10000;
+        pos.hdg = 9000;
+        mavlink_msg_global_position_int_encode(sysid, comp, &msg, &pos);
+        break;
+    }
+    case Kind::SYS_STATUS: {
+        mavlink_sys_status_t sys{};
+        sys.battery_remaining = 75;
+        sys.voltage_battery = 16200;
+        mavlink_msg_sys_status_encode(sysid, comp, &msg, &sys);
+        break;
+    }
+    case Kind::ESTIMATOR: {
+        mavlink_estimator_status_t est{};
+        est.time_usec = uint64_t(t) * 1000;
+        est.flags = 0x3;
+        mavlink_msg_estimator_status_encode(sysid, comp, &msg, &est);
+        break;
+    }
+    case Kind::EXTENDED_STATE: {
+        mavlink_extended_sys_state_t ext{};
+        ext.landed_state = MAV_LANDED_STATE_ON_GROUND;
+        mavlink_msg_extended_sys_state_encode(sysid, comp, &msg, &ext);
+        break;
+    }
+    case Kind::HEARTBEAT:
+        mavlink_msg_heartbeat_pack(
+            sysid, comp, &msg,
+            MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4,
+            MAV_MODE_FLAG_CUSTOM_MODE_ENABLED, 0, MAV_STATE_STANDBY);
+        break;
+    case Kind::RADIO: {
+        mavlink_radio_status_t radio{};
+        radio.rssi = 180; radio.remrssi = 170;
+        mavlink_msg_radio_status_encode(sysid, comp, &msg, &radio);
+        break;
+    }
+    case Kind::STATUSTEXT: {
+        mavlink_statustext_t text{};
+        text.severity = MAV_SEVERITY_INFO;
+        std::strncpy(text.text, "Preflight checks pass", sizeof(text.text));
+        mavlink_msg_statustext_encode(sysid, comp, &msg, &text);
+        break;
+    }
+    case Kind::COMMAND_ACK:
+        // Nobody drains the ACK queue here; once full the handler drops them
+        mavlink_msg_command_ack_pack(
+            sysid, comp, &msg,
+            MAV_CMD_COMPONENT_ARM_DISARM, MAV_RESULT_ACCEPTED,
+            0, 0, GCS_COMMAND_SYS_ID, MAV_COMP_ID_MISSIONPLANNER);
+        break;
+    case Kind::HIGHRES_IMU: {
+        mavlink_highres_imu_t imu{};
+        imu.time_usec = uint64_t(t) * 1000;
+        imu.xacc = 0.02f; imu.zacc = -9.81f;
+        imu.abs_pressure = 1013.2f; imu.temperature = 31.5f;
+        imu.fields_updated = 0x1fff;
+        mavlink_msg_highres_imu_encode(sysid, comp, &msg, &imu);
+        break;
+    }
+    case Kind::SERVO_OUTPUT_RAW: {
+        mavlink_servo_output_raw_t servo{};
+        servo.time_usec = t;
+        servo.servo1_raw = servo.servo2_raw = 1500;
+        servo.servo3_raw = servo.servo4_raw = 1500;
+        mavlink_msg_servo_output_raw_encode(sysid, comp, &msg, &servo);
+        break;
+    }
+    }
+}
+
+} // namespace
+
+std::vector<Datagram> makeTraffic(const TrafficMix& mix) {
+    std::vector<Datagram> out(mix.datagrams);
+    Rng rng{mix.seed ? mix.seed : 1};
+
+    for (size_t i = 0; i < mix.datagrams; i++) {
+        Datagram& d = out[i];
+        const int frames = 1 + static_cast<int>(rng.next() % mix.max_frames_per_datagram);
+        const uint8_t sysid = static_cast<uint8_t>(1 + i % mix.vehicles);
+
+        for (int f = 0; f < frames; f++) {
+            mavlink_message_t msg{};
+            encode(pick(rng, mix.include_unhandled), sysid,
+                   static_cast<uint32_t>(i * 4), msg);
+
+            uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+            const uint16_t len = mavlink_msg_to_send_buffer(buf, &msg);
+            d.bytes.insert(d.bytes.end(), buf, buf + len);
+            d.frames++;
+        }
+    }
+    return out;
+}
+
+size_t trafficBytes(const std::vector<Datagram>& traffic) {
+    size_t n = 0;
+    for (const Datagram& d : traffic)
+        n += d.bytes.size();
+    return n;
+}
+
+size_t trafficFrames(const std::vector<Datagram>& traffic) {
+    size_t n = 0;
+    for (const Datagram& d : traffic)
+        n += d.frames;
+    return n;
+}
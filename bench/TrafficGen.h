@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One UDP payload as a PX4 link would send it
+struct Datagram {
+    std::vector<uint8_t> bytes;
+    size_t frames = 0;
+};
+
+struct TrafficMix {
+    size_t datagrams = 4096;
+    int max_frames_per_datagram = 3;
+    int vehicles = 1;                 // sysids 1..vehicles
+    bool include_unhandled = true;    // frames no handler decodes
+    uint32_t seed = 1;
+};
+
+// -------------------------------------------------
+// Deterministic synthetic MAVLink traffic: the
+// high-rate streams at roughly PX4's relative rates,
+// a sprinkle of low-rate status, and payloads from
+// 4 to 63 bytes. The same seed yields the same bytes.
+// -------------------------------------------------
+std::vector<Datagram> makeTraffic(const TrafficMix& mix = TrafficMix{});
+
+size_t trafficBytes(const std::vector<Datagram>& traffic);
+size_t trafficFrames(const std::vector<Datagram>& traffic);
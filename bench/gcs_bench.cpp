@@ -0,0 +1,458 @@
+// Microbenchmarks for the GCS hot paths. Results go to stdout as one
+// JSON document so CI can diff them run over run; progress goes to stderr.
+//
+//   gcs_bench [--min-time SECONDS] [--filter SUBSTR]
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "TrafficGen.h"
+
+#include "comm/GcsHeartbeat.h"
+#include "comm/GcsIdentity.h"
+#include "comm/TxQueue.h"
+#include "command/CommandManager.h"
+#include "command/CommandTable.h"
+#include "command/MavlinkCommandSender.h"
+#include "core/GcsClock.h"
+#include "core/Logger.h"
+#include "core/StateManager.h"
+#include "core/TimerWheel.h"
+#include "mission/MissionPlan.h"
+#include "mission/MissionTransfer.h"
+#include "param/ParamTransfer.h"
+#include "record/TlogRecorder.h"
+#include "telemetry/MavlinkFrameScanner.h"
+#include "telemetry/MessageDispatcher.h"
+#include "telemetry/TelemetryData.h"
+#include "telemetry/TelemetryHistory.h"
+#include "telemetry/TelemetryParser.h"
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations = 0;
+    double seconds = 0;
+    double bytes = 0;        // per iteration, 0 when not meaningful
+    double frames = 0;
+};
+
+static double min_time = 1.0;
+static const char* filter = nullptr;
+static std::vector<BenchResult> results;
+
+// Calls fn() in growing batches until min_time has passed.
+// One call of fn is one "op"; bytes/frames are per op.
+template <typename Fn>
+static void run(const std::string& name, double bytes, double frames, Fn&& fn) {
+    if (filter && name.find(filter) == std::string::npos)
+        return;
+
+    std::fprintf(stderr, "%-28s ...", name.c_str());
+
+    fn();   // warm caches and lazily built tables
+
+    uint64_t iterations = 0;
+    uint64_t batch = 1;
+    double elapsed = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    do {
+        for (uint64_t i = 0; i < batch; i++)
+            fn();
+        iterations += batch;
+        if (batch < (uint64_t(1) << 20))
+            batch *= 2;
+        elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < min_time);
+
+    std::fprintf(stderr, " %10.1f ns/op\n", elapsed * 1e9 / double(iterations));
+    results.push_back({name, iterations, elapsed, bytes, frames});
+}
+
+static void writeJson() {
+    std::printf("{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        const double ops = double(r.iterations) / r.seconds;
+
+        std::printf("    {\"name\": \"%s\", \"iterations\": %llu, "
+                    "\"seconds\": %.6f, \"ns_per_op\": %.3f, \"ops_per_s\": %.1f",
+                    r.name.c_str(),
+                    static_cast<unsigned long long>(r.iterations),
+                    r.seconds, 1e9 / ops, ops);
+        if (r.bytes > 0)
+            std::printf(", \"bytes_per_s\": %.1f", r.bytes * ops);
+        if (r.frames > 0)
+            std::printf(", \"frames_per_s\": %.1f", r.frames * ops);
+        std::printf("}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+}
+
+// ---------------- Ingest ----------------
+static void benchIngest() {
+    const std::vector<Datagram> traffic = makeTraffic();
+    const double bytes = double(trafficBytes(traffic));
+    const double frames = double(trafficFrames(traffic));
+
+    TelemetryData telemetry;
+    StateManager stateManager;
+    TelemetryHistory history;   // unconfigured: recording is a no-op
+    CommandAckQueue acks;
+    MissionEventQueue missions;
+    ParamEventQueue params;
+    StreamAckQueue stream_acks;
+    TelemetryParser parser({telemetry, stateManager, history, acks, missions, params, stream_acks});
+    MavlinkFrameScanner scanner;
+
+    // One op = one pass over the whole traffic set
+    run("parse_bytewise", bytes, frames, [&]() {
+        for (const Datagram& d : traffic)
+            parser.parse(d.bytes.data(), d.bytes.size());
+    });
+
+    run("scan_dispatch", bytes, frames, [&]() {
+        for (const Datagram& d : traffic) {
+            scanner.scan(d.bytes.data(), d.bytes.size(),
+                [&](const MavlinkFrameView& frame) {
+                    parser.handleFrame(frame);
+                });
+        }
+    });
+
+    TelemetryHistory recording;
+    recording.configure(HistoryConfig{});
+    TelemetryParser recording_parser({telemetry, stateManager, recording, acks, missions, params, stream_acks});
+
+    run("scan_dispatch_history", bytes, frames, [&]() {
+        for (const Datagram& d : traffic) {
+            scanner.scan(d.bytes.data(), d.bytes.size(),
+                [&](const MavlinkFrameView& frame) {
+                    recording_parser.handleFrame(frame);
+                });
+        }
+    });
+
+    // Handler cost alone: frames are validated once up front
+    std::vector<MavlinkFrameView> views;
+    MavlinkFrameScanner prescan;
+    for (const Datagram& d : traffic) {
+        prescan.scan(d.bytes.data(), d.bytes.size(),
+            [&](const MavlinkFrameView& frame) {
+                views.push_back(frame);
+            });
+    }
+
+    MessageDispatcher& dispatcher = MessageDispatcher::shared();
+    TelemetryContext ctx{telemetry, stateManager, history, acks, missions, params, stream_acks};
+
+    run("dispatch_only", 0, double(views.size()), [&]() {
+        for (const MavlinkFrameView& v : views)
+            dispatcher.dispatch(v, ctx);
+    });
+}
+
+// ---------------- Commands ----------------
+static sockaddr_in vehicleAddr() {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(14580);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+static TelemetryData armableTelemetry() {
+    TelemetryData t;
+    t.heartbeat_received = true;
+    t.ekf_ok = true;
+    t.battery_ok = true;
+    t.flight_phase = FlightPhase::ON_GROUND;
+    t.arm_state = ArmState::DISARMED;
+    t.status = VehicleStatus::HEARTBEAT | VehicleStatus::EKF_OK |
+               VehicleStatus::BATTERY_OK | VehicleStatus::LANDED;
+    return t;
+}
+
+// requestCommand + matching ACK + update, with `background` other
+// commands left in flight so lookups run against a non-empty table
+static void benchCommandRoundTrip(int background) {
+    constexpr uint8_t SYSID = 1;
+
+    TxQueue tx;
+    TimerWheel wheel(GcsClock::now());
+    MavlinkCommandSender sender(tx, SYSID, vehicleAddr());
+    CommandManager manager;
+    manager.setCommandSender(&sender);
+    manager.setTimerWheel(&wheel);
+
+    CommandAckQueue acks;
+    SystemState state = SystemState::CONNECTED;
+    const TelemetryData landed = armableTelemetry();
+
+    // LAND is the only CONCURRENT command; the wheel never advances,
+    // so it stays pending for the whole run
+    if (background > 0) {
+        TelemetryData airborne = landed;
+        airborne.flight_phase = FlightPhase::IN_AIR;
+        airborne.setStatus(VehicleStatus::LANDED, false);
+        airborne.setStatus(VehicleStatus::AIRBORNE, true);
+        manager.requestCommand(VehicleCommand::LAND, true, airborne);
+        tx.discard();
+    }
+
+    CommandAckData ack;
+    ack.command_id = MAV_CMD_COMPONENT_ARM_DISARM;
+    ack.result = MAV_RESULT_ACCEPTED;
+    ack.source_sysid = SYSID;
+    ack.source_compid = MAV_COMP_ID_AUTOPILOT1;
+
+    const size_t pending = 1 + manager.pendingCount();
+
+    run("command_roundtrip/pending:" + std::to_string(pending), 0, 0, [&]() {
+        state = SystemState::CONNECTED;
+        manager.requestCommand(VehicleCommand::ARM, true, landed);
+        acks.push(ack);
+        manager.update(acks, state);
+        tx.discard();
+    });
+
+    // ACKs for nothing in flight: the miss path of the pending index
+    CommandAckData stray = ack;
+    stray.command_id = MAV_CMD_DO_SET_MODE;
+    constexpr int STRAY_BATCH = 8;
+
+    run("ack_stray/pending:" + std::to_string(manager.pendingCount()),
+        0, STRAY_BATCH, [&]() {
+            for (int i = 0; i < STRAY_BATCH; i++)
+                acks.push(stray);
+            manager.update(acks, state);
+        });
+}
+
+// ---------------- Preconditions ----------------
+// Every command against one status word, as a UI refresh would
+static void benchRules() {
+    uint32_t statuses[64];
+    uint32_t x = 1;
+    for (uint32_t& s : statuses) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        s = x & ((1u << VehicleStatus::BITS) - 1);
+    }
+
+    size_t i = 0;
+    uint32_t sink = 0;
+    run("rule_eval_all_commands", 0, 0, [&]() {
+        sink += allowedCommands(statuses[i++ & 63]);
+    });
+
+    run("rule_check_with_reason", 0, 0, [&]() {
+        const auto cmd = static_cast<VehicleCommand>(i % VEHICLE_COMMAND_COUNT);
+        sink += static_cast<uint32_t>(
+            checkRule(commandDefinition(cmd).rule, statuses[i++ & 63]));
+    });
+
+    if (sink == 0xdeadbeef)
+        std::fprintf(stderr, "\n");
+}
+
+// ---------------- Mission ----------------
+static void benchMission() {
+    constexpr uint16_t ITEMS = 1000;
+    const MissionPlan plan = MissionPlan::survey(ITEMS, 473977420, 85455940, 30.0f);
+
+    TxQueue tx;
+    TimerWheel wheel(GcsClock::now());
+    MissionTransfer transfer(tx, 1, vehicleAddr());
+    transfer.setTimerWheel(&wheel);
+    transfer.startUpload(plan);
+    tx.discard();
+
+    // One op = one MISSION_REQUEST answered from the pre-encoded cache
+    MissionEventQueue events;
+    MissionEvent request;
+    request.type = MissionEventType::REQUEST;
+
+    run("mission_item_serve", 0, 1, [&]() {
+        request.value = static_cast<uint16_t>((request.value + 1) % ITEMS);
+        events.push(request);
+        transfer.update(events);
+        tx.discard();
+    });
+
+    // The same reply encoded per request, as without the cache
+    const sockaddr_in addr = vehicleAddr();
+    uint16_t seq = 0;
+
+    run("mission_item_encode", 0, 1, [&]() {
+        mavlink_mission_item_int_t item = plan[seq];
+        item.target_system = 1;
+        item.target_component = MAV_COMP_ID_AUTOPILOT1;
+
+        mavlink_message_t msg;
+        mavlink_msg_mission_item_int_encode(GCS_COMMAND_SYS_ID, GCS_COMP_ID, &msg, &item);
+        tx.enqueue(tx.pushFrame(msg), addr);
+        tx.discard();
+        seq = static_cast<uint16_t>((seq + 1) % ITEMS);
+    });
+}
+
+// ---------------- Parameters ----------------
+static void benchParams() {
+    constexpr uint16_t PARAMS = 1000;
+    constexpr uint16_t DROP_EVERY = 10;     // 10% of the stream lost
+
+    std::vector<mavlink_param_value_t> values(PARAMS);
+    for (uint16_t i = 0; i < PARAMS; i++) {
+        mavlink_param_value_t& pv = values[i];
+        std::snprintf(pv.param_id, sizeof(pv.param_id), "BENCH_P%04u", unsigned(i));
+        pv.param_value = float(i);
+        pv.param_count = PARAMS;
+        pv.param_index = i;
+        pv.param_type = MAV_PARAM_TYPE_REAL32;
+    }
+
+    TxQueue tx;
+    TimerWheel wheel(GcsClock::now());
+    ParamEventQueue events;
+    std::optional<ParamTransfer> transfer;
+
+    auto feed = [&](uint16_t i) {
+        if (!events.push(values[i])) {
+            transfer->update(events);
+            events.push(values[i]);
+        }
+    };
+
+    // One op = a whole list: streamed with gaps, then the gaps read
+    // back by index once the stream goes quiet
+    run("param_download/params:1000", 0, PARAMS, [&]() {
+        transfer.emplace(tx, 1, vehicleAddr());
+        transfer->setTimerWheel(&wheel);
+        transfer->start(0, 0);
+
+        for (uint16_t i = 0; i < PARAMS; i++) {
+            if (i % DROP_EVERY != DROP_EVERY - 1)
+                feed(i);
+        }
+        transfer->update(events);
+
+        wheel.advance(GcsClock::now() + std::chrono::seconds(1));
+        for (uint16_t i = DROP_EVERY - 1; i < PARAMS; i += DROP_EVERY)
+            feed(i);
+        transfer->update(events);
+
+        transfer.reset();
+        tx.discard();
+    });
+}
+
+// ---------------- Encode ----------------
+static void benchEncode() {
+    TxQueue tx;
+
+    for (int targets : {1, 16, 128}) {
+        GcsHeartbeat heartbeat(tx);   // starts with the SITL target
+        for (int i = 1; i < targets; i++) {
+            sockaddr_in addr = vehicleAddr();
+            addr.sin_port = htons(static_cast<uint16_t>(20000 + i));
+            heartbeat.addTarget(addr);
+        }
+
+        run("heartbeat_encode/targets:" + std::to_string(targets), 0, targets, [&]() {
+            heartbeat.send();
+            tx.discard();
+        });
+    }
+
+    MavlinkCommandSender sender(tx, 1, vehicleAddr());
+    run("command_encode", 0, 1, [&]() {
+        sender.sendArm();
+        tx.discard();
+    });
+}
+
+// ---------------- Recording ----------------
+static void benchRecord() {
+    constexpr size_t SEGMENT_BYTES = 64u << 20;
+    constexpr uint64_t SPAN_BYTES = 256u << 20;    // disk held at any time
+
+    const std::vector<Datagram> traffic = makeTraffic();
+    const double bytes = double(trafficBytes(traffic) + traffic.size() * TLOG_RECORD_HEADER_BYTES);
+
+    char dir[] = "/tmp/gcs_bench_XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::perror("mkdtemp");
+        return;
+    }
+
+    TlogRecorder recorder;
+    if (!recorder.open(dir, SEGMENT_BYTES)) {
+        std::filesystem::remove_all(dir);
+        return;
+    }
+
+    const sockaddr_in src = vehicleAddr();
+    timespec rx_time;
+    clock_gettime(CLOCK_REALTIME, &rx_time);
+    uint64_t span_start = 0;
+
+    // One op = the traffic set appended once; segments roll as they
+    // fill, and every span the files are dropped to bound disk use
+    run("record_append", bytes, double(trafficFrames(traffic)), [&]() {
+        for (const Datagram& d : traffic)
+            recorder.record(rx_time, src, d.bytes.data(), static_cast<uint16_t>(d.bytes.size()));
+
+        if (recorder.stats().bytes - span_start >= SPAN_BYTES) {
+            recorder.close();
+            for (const auto& entry : std::filesystem::directory_iterator(dir))
+                std::filesystem::remove(entry.path());
+            recorder.open(dir, SEGMENT_BYTES);
+            span_start = recorder.stats().bytes;
+        }
+    });
+
+    recorder.close();
+    std::filesystem::remove_all(dir);
+}
+
+int main(int argc, char** argv) {
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            min_time = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            std::fprintf(stderr,
+                "usage: %s [--min-time SECONDS] [--filter SUBSTR]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    // Per-command INFO lines would dominate the command benchmarks
+    Logger::setMinLevel(LogLevel::ERROR);
+
+    benchIngest();
+    benchRecord();
+    benchCommandRoundTrip(0);
+    benchCommandRoundTrip(1);
+    benchRules();
+    benchMission();
+    benchParams();
+    benchEncode();
+
+    writeJson();
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "comm/FramePool.h"
+#include "core/Logger.h"
+#include "core/Metrics.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int numaNodeOfCpu(int cpu) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+
+    DIR* dir = opendir(path);
+    if (!dir)
+        return -1;
+
+    int node = -1;
+    while (dirent* e = readdir(dir)) {
+        if (std::sscanf(e->d_name, "node%d", &node) == 1)
+            break;
+        node = -1;
+    }
+    closedir(dir);
+    return node;
+}
+
+FramePool::~FramePool() {
+    if (!slabs_)
+        return;
+
+    Metrics::instance().removeCollector(metrics_collector);
+    munmap(slabs_, map_len);
+}
+
+bool FramePool::init(uint32_t slabs, int numa_node) {
+    map_len = slabs * sizeof(FrameSlab);
+
+    void* mem = mmap(nullptr, map_len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+
+    // Before the first touch, so the pages fault in on that node
+    if (numa_node >= 0) {
+        unsigned long mask = 1UL << numa_node;
+        if (syscall(__NR_mbind, mem, map_len, MPOL_PREFERRED, &mask,
+                    sizeof(mask) * 8, 0) < 0)
+            LOG_WARN("POOL", "mbind to node {}: {}", numa_node, std::strerror(errno));
+    }
+
+    slabs_ = static_cast<FrameSlab*>(mem);
+    count_ = slabs;
+
+    // Built back to front so alloc() hands out ascending addresses
+    for (uint32_t i = slabs; i-- > 0;) {
+        FrameSlab* s = new (&slabs_[i]) FrameSlab;
+        s->pool = this;
+        s->index = i;
+        s->next = i + 1 < slabs ? i + 2 : 0;
+    }
+    free_head_.store(slabs ? 1 : 0, std::memory_order_release);
+
+    metrics_collector = Metrics::instance().addCollector([this](std::string& out) {
+        const Stats s = stats();
+
+        Metrics::family(out, "gcs_frame_pool_slabs", "gauge", "Receive buffers in the frame pool");
+        Metrics::sample(out, "gcs_frame_pool_slabs", nullptr, double(s.slabs));
+        Metrics::family(out, "gcs_frame_pool_in_use", "gauge", "Frame slabs out of the pool: posted for receive or held by a consumer");
+        Metrics::sample(out, "gcs_frame_pool_in_use", nullptr, double(s.in_use));
+        Metrics::family(out, "gcs_frame_pool_in_use_max", "gauge", "Most frame slabs held at once");
+        Metrics::sample(out, "gcs_frame_pool_in_use_max", nullptr, double(s.in_use_max));
+    });
+
+    if (numa_node >= 0)
+        LOG_INFO("POOL", "{} frame slabs ({} KiB) on NUMA node {}",
+                 slabs, map_len >> 10, numa_node);
+    else
+        LOG_INFO("POOL", "{} frame slabs ({} KiB)", slabs, map_len >> 10);
+    return true;
+}
+
+FrameSlab* FramePool::alloc() {
+    uint32_t head = free_head_.load(std::memory_order_acquire);
+    FrameSlab* s;
+
+    do {
+        if (head == 0)
+            return nullptr;
+        s = &slabs_[head - 1];
+    } while (!free_head_.compare_exchange_weak(head, s->next,
+                                               std::memory_order_acquire,
+                                               std::memory_order_acquire));
+
+    s->refs.store(1, std::memory_order_relaxed);
+
+    const uint32_t allocated = allocated_.load(std::memory_order_relaxed) + 1;
+    allocated_.store(allocated, std::memory_order_relaxed);
+
+    const uint32_t in_use = allocated - freed_.load(std::memory_order_relaxed);
+    if (in_use > in_use_max_.load(std::memory_order_relaxed))
+        in_use_max_.store(in_use, std::memory_order_relaxed);
+
+    return s;
+}
+
+void FramePool::free(FrameSlab* s) {
+    uint32_t head = free_head_.load(std::memory_order_relaxed);
+    do {
+        s->next = head;
+    } while (!free_head_.compare_exchange_weak(head, s->index + 1,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+
+    freed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+FramePool::Stats FramePool::stats() const {
+    // Two unsynchronised counters; a scrape may see a free before its alloc
+    const uint32_t allocated = allocated_.load(std::memory_order_relaxed);
+    const uint32_t freed = freed_.load(std::memory_order_relaxed);
+
+    Stats s;
+    s.slabs = count_;
+    s.in_use = allocated > freed ? allocated - freed : 0;
+    s.in_use_max = in_use_max_.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "comm/RxDatagram.h"
+
+class FramePool;
+
+// Slabs per pool: every datagram in flight between receive and the
+// last consumer (parse queue, router backlog) holds one
+static constexpr uint32_t FRAME_POOL_SLABS = 1024;
+
+// -------------------------------------------------
+// One pooled receive buffer. The header sits on its
+// own cache line, so under io_uring the kernel writing
+// the datagram never touches the refcount.
+// -------------------------------------------------
+struct FrameSlab {
+    std::atomic<uint32_t> refs{0};
+    uint32_t next = 0;              // free-list link (index + 1, 0 = end)
+    FramePool* pool = nullptr;
+    uint32_t index = 0;
+
+    RxDatagram dgram;
+
+    // Another holder; only from one that already has a reference
+    void retain() { refs.fetch_add(1, std::memory_order_relaxed); }
+
+    // Last one out returns the slab to its pool; any thread
+    void release();
+};
+
+// -------------------------------------------------
+// Fixed pool of FrameSlabs, mapped once at startup and
+// never grown, so receiving allocates nothing on the
+// heap. Receive fills a slab once; parser, router and
+// recorder read it in place and any of them may keep
+// it past the batch with retain(). The memory is bound
+// to the receiving thread's NUMA node.
+//
+// alloc() has one caller (the receiving thread);
+// release() may come from any. Frees push onto a
+// lock-free stack; a single popper cannot suffer ABA.
+// -------------------------------------------------
+class FramePool {
+public:
+    struct Stats {
+        uint32_t slabs;
+        uint32_t in_use;
+        uint32_t in_use_max;
+    };
+
+    FramePool() = default;
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // node -1: wherever the first touch lands
+    bool init(uint32_t slabs = FRAME_POOL_SLABS, int numa_node = -1);
+
+    // One reference, or nullptr when every slab is held
+    FrameSlab* alloc();
+
+    FrameSlab& slab(uint32_t index) { return slabs_[index]; }
+    uint32_t size() const { return count_; }
+
+    Stats stats() const;
+
+private:
+    friend struct FrameSlab;
+    void free(FrameSlab* slab);
+
+    FrameSlab* slabs_ = nullptr;
+    size_t map_len = 0;
+    uint32_t count_ = 0;
+
+    std::atomic<uint32_t> free_head_{0};      // index + 1, 0 = empty
+
+    // Written by the allocating thread only
+    std::atomic<uint32_t> allocated_{0};
+    std::atomic<uint32_t> in_use_max_{0};
+    alignas(64) std::atomic<uint32_t> freed_{0};  // any releasing thread
+
+    int metrics_collector = 0;
+};
+
+inline void FrameSlab::release() {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        pool->free(this);
+}
+
+// NUMA node of a CPU, or -1 when the machine doesn't say
+int numaNodeOfCpu(int cpu);
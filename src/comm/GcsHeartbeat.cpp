@@ -1,18 +1,18 @@
 #include "comm/GcsHeartbeat.h"
+#include "comm/GcsIdentity.h"
+#include "comm/TxQueue.h"
 
+#include <arpa/inet.h>
 #include <cstring>
-#include <unistd.h>
 
 extern "C" {
 #include "mavlink/common/mavlink.h"
 }
 
-static constexpr uint8_t GCS_SYS_ID  = 50;
-static constexpr uint8_t GCS_COMP_ID = MAV_COMP_ID_MISSIONPLANNER;
-
-GcsHeartbeat::GcsHeartbeat(int socket_fd)
-    : sockfd(socket_fd) {
+GcsHeartbeat::GcsHeartbeat(TxQueue& tx)
+    : txQueue(tx) {
 
+    sockaddr_in target_addr;
     std::memset(&target_addr, 0, sizeof(target_addr));
     target_addr.sin_family = AF_INET;
 
@@ -20,15 +20,25 @@ GcsHeartbeat::GcsHeartbeat(int socket_fd)
     target_addr.sin_port = htons(18570);
 
     target_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    targets.push_back(target_addr);
+}
+
+void GcsHeartbeat::addTarget(const sockaddr_in& addr) {
+    for (const auto& t : targets) {
+        if (t.sin_addr.s_addr == addr.sin_addr.s_addr &&
+            t.sin_port == addr.sin_port)
+            return;
+    }
+    targets.push_back(addr);
 }
 
 void GcsHeartbeat::send() {
 
     mavlink_message_t msg;
-    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
 
     mavlink_msg_heartbeat_pack(
-        GCS_SYS_ID,
+        GCS_HEARTBEAT_SYS_ID,
         GCS_COMP_ID,
         &msg,
         MAV_TYPE_GCS,
@@ -38,14 +48,11 @@ void GcsHeartbeat::send() {
         MAV_STATE_ACTIVE
     );
 
-    uint16_t len = mavlink_msg_to_send_buffer(buffer, &msg);
+    // One encode, N destinations, one sendmmsg at flush time
+    int frame = txQueue.pushFrame(msg);
+    if (frame < 0)
+        return;
 
-    sendto(
-        sockfd,
-        buffer,
-        len,
-        0,
-        reinterpret_cast<sockaddr*>(&target_addr),
-        sizeof(target_addr)
-    );
+    for (const auto& t : targets)
+        txQueue.enqueue(frame, t);
 }
@@ -2,14 +2,21 @@
 
 #include <cstdint>
 #include <netinet/in.h>
+#include <vector>
+
+class TxQueue;
 
 class GcsHeartbeat {
 public:
-    explicit GcsHeartbeat(int socket_fd);
+    // Starts with the PX4 SITL listening port as the only target
+    explicit GcsHeartbeat(TxQueue& tx);
+
+    void addTarget(const sockaddr_in& addr);
 
+    // Encodes once and queues one copy per target
     void send();
 
 private:
-    int sockfd;
-    sockaddr_in target_addr;
+    TxQueue& txQueue;
+    std::vector<sockaddr_in> targets;
 };
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+// GCS identity on the wire. Heartbeats and commands go out under
+// different system ids; both must be ignored when they echo back.
+static constexpr uint8_t GCS_HEARTBEAT_SYS_ID = 50;
+static constexpr uint8_t GCS_COMMAND_SYS_ID   = 250;  // QGC-style valid GCS ID
+static constexpr uint8_t GCS_COMP_ID          = MAV_COMP_ID_MISSIONPLANNER;
+
+inline bool isGcsSystemId(uint8_t sysid) {
+    return sysid == GCS_HEARTBEAT_SYS_ID || sysid == GCS_COMMAND_SYS_ID;
+}
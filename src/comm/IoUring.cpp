@@ -0,0 +1,173 @@
+#include "comm/IoUring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int ioUringSetup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+static int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(
+        syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+IoUring::~IoUring() {
+    unmap();
+    if (ring_fd >= 0)
+        close(ring_fd);
+}
+
+void IoUring::unmap() {
+    if (buf_ring)
+        munmap(buf_ring, buf_ring_len);
+    if (sqes)
+        munmap(sqes, sqes_len);
+    if (cq_map && cq_map != sq_map)
+        munmap(cq_map, cq_map_len);
+    if (sq_map)
+        munmap(sq_map, sq_map_len);
+
+    buf_ring = nullptr;
+    sqes = nullptr;
+    cq_map = sq_map = nullptr;
+}
+
+bool IoUring::setup(unsigned sq_entries, unsigned cq_entries) {
+    io_uring_params p{};
+    p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_R_DISABLED;
+    p.cq_entries = cq_entries;
+
+    ring_fd = ioUringSetup(sq_entries, &p);
+    if (ring_fd < 0)
+        return false;
+
+    if (!map(p)) {
+        const int err = errno;
+        unmap();
+        close(ring_fd);
+        ring_fd = -1;
+        errno = err;
+        return false;
+    }
+    return true;
+}
+
+bool IoUring::map(const io_uring_params& p) {
+    sq_map_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_map_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+
+    // Every kernel with SINGLE_ISSUER maps both rings at once
+    const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single)
+        sq_map_len = cq_map_len = std::max(sq_map_len, cq_map_len);
+
+    void* sq_mem = mmap(nullptr, sq_map_len, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (sq_mem == MAP_FAILED)
+        return false;
+    sq_map = sq_mem;
+
+    if (single) {
+        cq_map = sq_map;
+    } else {
+        void* cq_mem = mmap(nullptr, cq_map_len, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (cq_mem == MAP_FAILED)
+            return false;
+        cq_map = cq_mem;
+    }
+
+    sqes_len = p.sq_entries * sizeof(io_uring_sqe);
+    void* sqe_mem = mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (sqe_mem == MAP_FAILED)
+        return false;
+    sqes = static_cast<io_uring_sqe*>(sqe_mem);
+
+    uint8_t* sq = static_cast<uint8_t*>(sq_map);
+    sq_head = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    sq_mask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_entries_ = p.sq_entries;
+    sq_local_tail = *sq_tail;
+
+    uint8_t* cq = static_cast<uint8_t*>(cq_map);
+    cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    cq_mask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    return true;
+}
+
+bool IoUring::enable() {
+    if (ioUringRegister(ring_fd, IORING_REGISTER_ENABLE_RINGS, nullptr, 0) < 0)
+        return false;
+    enabled_ = true;
+    return true;
+}
+
+io_uring_sqe* IoUring::getSqe() {
+    const unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    if (sq_local_tail - head >= sq_entries_)
+        return nullptr;
+
+    const unsigned idx = sq_local_tail++ & sq_mask;
+    sq_array[idx] = idx;
+
+    io_uring_sqe* sqe = &sqes[idx];
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int IoUring::submit(unsigned wait_for) {
+    const unsigned to_submit = sq_local_tail - *sq_tail;
+    __atomic_store_n(sq_tail, sq_local_tail, __ATOMIC_RELEASE);
+
+    if (to_submit == 0 && wait_for == 0)
+        return 0;
+
+    const unsigned flags = wait_for ? IORING_ENTER_GETEVENTS : 0;
+    int n;
+    do {
+        n = ioUringEnter(ring_fd, to_submit, wait_for, flags);
+    } while (n < 0 && errno == EINTR);
+
+    return n;
+}
+
+io_uring_buf_ring* IoUring::registerBufRing(unsigned entries, uint16_t bgid) {
+    buf_ring_len = entries * sizeof(io_uring_buf);
+
+    void* mem = mmap(nullptr, buf_ring_len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (mem == MAP_FAILED) {
+        perror("mmap");
+        return nullptr;
+    }
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(mem);
+    reg.ring_entries = entries;
+    reg.bgid = bgid;
+
+    if (ioUringRegister(ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        perror("io_uring_register(PBUF_RING)");
+        munmap(mem, buf_ring_len);
+        return nullptr;
+    }
+
+    buf_ring = static_cast<io_uring_buf_ring*>(mem);
+    buf_ring->tail = 0;
+    return buf_ring;
+}
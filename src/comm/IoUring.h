@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+
+// -------------------------------------------------
+// Minimal io_uring over the raw syscalls: one SQ/CQ
+// pair mapped at setup, plus provided-buffer rings.
+// Single issuer: the ring is created disabled and
+// belongs to the thread that enables it, which alone
+// submits and reaps. No liburing dependency.
+// -------------------------------------------------
+class IoUring {
+public:
+    IoUring() = default;
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // False (errno set) when the kernel lacks io_uring or the
+    // single-issuer mode multishot receive arrived with (6.0)
+    bool setup(unsigned sq_entries, unsigned cq_entries);
+
+    // On the owning thread, before the first submit()
+    bool enable();
+
+    bool isOpen() const { return ring_fd >= 0; }
+    bool isEnabled() const { return enabled_; }
+
+    // Readable while completions are waiting; epoll-able
+    int fd() const { return ring_fd; }
+
+    // Zeroed SQE, or nullptr when the SQ is full; goes out on submit()
+    io_uring_sqe* getSqe();
+
+    // Submits every prepared SQE and waits for `wait_for` completions.
+    // Returns the number submitted, or -1 with errno set.
+    int submit(unsigned wait_for = 0);
+
+    // Up to `max` completions in order; consumed once the callback returns
+    template <typename Fn>
+    unsigned reap(Fn&& fn, unsigned max = ~0u) {
+        unsigned head = *cq_head;
+        const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        const unsigned n = std::min(tail - head, max);
+
+        for (unsigned i = 0; i < n; i++, head++)
+            fn(cqes[head & cq_mask]);
+
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        return n;
+    }
+
+    // Kernel-shared ring of `entries` buffers (a power of two) for
+    // IOSQE_BUFFER_SELECT reads in group `bgid`
+    io_uring_buf_ring* registerBufRing(unsigned entries, uint16_t bgid);
+
+private:
+    bool map(const io_uring_params& p);
+    void unmap();
+
+    int ring_fd = -1;
+    bool enabled_ = false;
+
+    void* sq_map = nullptr;
+    size_t sq_map_len = 0;
+    void* cq_map = nullptr;
+    size_t cq_map_len = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_len = 0;
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned sq_mask = 0;
+    unsigned sq_entries_ = 0;
+    unsigned sq_local_tail = 0;     // prepared, not yet published
+
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned cq_mask = 0;
+
+    io_uring_buf_ring* buf_ring = nullptr;
+    size_t buf_ring_len = 0;
+};
+
+// Appends one buffer at `offset` past the ring's tail; advanceBufRing()
+// publishes a run of them at once
+inline void addBuffer(io_uring_buf_ring* ring, unsigned mask, unsigned offset,
+                      void* addr, uint32_t len, uint16_t bid) {
+    // Indexed from the ring itself: in C++ the header's flex-array
+    // wrapper shifts `bufs` off the kernel's layout
+    io_uring_buf& b = reinterpret_cast<io_uring_buf*>(ring)[(ring->tail + offset) & mask];
+    b.addr = reinterpret_cast<uint64_t>(addr);
+    b.len = len;
+    b.bid = bid;
+}
+
+inline void advanceBufRing(io_uring_buf_ring* ring, unsigned count) {
+    __atomic_store_n(&ring->tail, static_cast<uint16_t>(ring->tail + count), __ATOMIC_RELEASE);
+}
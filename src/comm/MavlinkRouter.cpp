@@ -0,0 +1,456 @@
+#include "comm/MavlinkRouter.h"
+#include "core/Logger.h"
+#include "core/Metrics.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+// Vehicle endpoints live in one atomic word: addr << 16 | port
+static uint64_t packAddr(const sockaddr_in& addr) {
+    return (uint64_t(addr.sin_addr.s_addr) << 16) | addr.sin_port;
+}
+
+static sockaddr_in unpackAddr(uint64_t packed) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = static_cast<uint32_t>(packed >> 16);
+    addr.sin_port = static_cast<uint16_t>(packed);
+    return addr;
+}
+
+// Zero-truncated v2 payloads read as target 0, a broadcast
+static int targetSystem(const MavlinkFrameView& frame) {
+    const mavlink_msg_entry_t* e = mavlink_get_msg_entry(frame.msgid);
+    if (!e || !(e->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM))
+        return -1;
+    return e->target_system_ofs < frame.payload_len ? frame.payload[e->target_system_ofs] : 0;
+}
+
+MavlinkRouter::~MavlinkRouter() {
+    if (metrics_collector)
+        Metrics::instance().removeCollector(metrics_collector);
+    if (sockfd >= 0)
+        close(sockfd);
+}
+
+bool MavlinkRouter::start(
+    int port,
+    int vehicle_fd_,
+    const std::vector<RouteConfig>& routes,
+    FramePool& pool) {
+
+    if (routes.empty() || routes.size() > ROUTER_MAX_ROUTES) {
+        LOG_ERROR("ROUTE", "{} routes configured, 1 to {} supported",
+                  routes.size(), ROUTER_MAX_ROUTES);
+        return false;
+    }
+
+    route_count = routes.size();
+    routes_.reset(new Route[route_count]);
+
+    for (size_t r = 0; r < route_count; r++) {
+        Route& route = routes_[r];
+        route.config = routes[r];
+
+        for (uint32_t id : route.config.msgids) {
+            if (route.msgid_bits.size() <= id / 64)
+                route.msgid_bits.resize(id / 64 + 1);
+            route.msgid_bits[id / 64] |= uint64_t(1) << (id % 64);
+        }
+    }
+
+    sockfd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (sockfd < 0) {
+        perror("socket");
+        return false;
+    }
+
+    sockaddr_in local_addr{};
+    local_addr.sin_family = AF_INET;
+    local_addr.sin_addr.s_addr = INADDR_ANY;
+    local_addr.sin_port = htons(port);
+
+    if (bind(sockfd,
+             reinterpret_cast<sockaddr*>(&local_addr),
+             sizeof(local_addr)) < 0) {
+        perror("bind");
+        close(sockfd);
+        sockfd = -1;
+        return false;
+    }
+
+    vehicle_fd = vehicle_fd_;
+    pool_ = &pool;
+
+    metrics_collector = Metrics::instance().addCollector([this](std::string& out) {
+        collectMetrics(out);
+    });
+
+    for (size_t r = 0; r < route_count; r++)
+        LOG_INFO("ROUTE", "Route {} -> {}", r, routeName(r).c_str());
+    LOG_INFO("ROUTE", "Router listening on port {}", port);
+    return true;
+}
+
+std::string MavlinkRouter::routeName(size_t route) const {
+    const sockaddr_in& dest = routes_[route].config.dest;
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &dest.sin_addr, ip, sizeof(ip));
+    return std::string(ip) + ":" + std::to_string(ntohs(dest.sin_port));
+}
+
+bool MavlinkRouter::Route::allows(uint8_t sysid, uint32_t msgid) const {
+    if (config.sysids.any() && !config.sysids.test(sysid))
+        return false;
+    if (msgid_bits.empty())
+        return true;
+    return msgid / 64 < msgid_bits.size() &&
+           ((msgid_bits[msgid / 64] >> (msgid % 64)) & 1);
+}
+
+void MavlinkRouter::TxBatch::add(
+    const sockaddr_in& to,
+    int r,
+    FrameSlab& from,
+    const uint8_t* data,
+    size_t len) {
+
+    if (count > sealed && route[count - 1] == r && sameAddr(dest[count - 1], to)) {
+        iovec& last = iov[iovs - 1];
+        if (static_cast<const uint8_t*>(last.iov_base) + last.iov_len == data) {
+            last.iov_len += len;
+            frames[count - 1]++;
+            return;
+        }
+
+        // Same datagram, one more piece
+        iov[iovs].iov_base = const_cast<uint8_t*>(data);
+        iov[iovs].iov_len = len;
+        iovs++;
+        msgs[count - 1].msg_hdr.msg_iovlen++;
+        frames[count - 1]++;
+        return;
+    }
+
+    from.retain();
+    slab[count] = &from;
+
+    dest[count] = to;
+    route[count] = r;
+    frames[count] = 1;
+
+    iov[iovs].iov_base = const_cast<uint8_t*>(data);
+    iov[iovs].iov_len = len;
+
+    msghdr& hdr = msgs[count].msg_hdr;
+    hdr.msg_name = &dest[count];
+    hdr.msg_namelen = sizeof(sockaddr_in);
+    hdr.msg_iov = &iov[iovs];
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = nullptr;
+    hdr.msg_controllen = 0;
+    hdr.msg_flags = 0;
+
+    iovs++;
+    count++;
+}
+
+void MavlinkRouter::TxBatch::consume(size_t n) {
+    for (size_t i = 0; i < n; i++)
+        slab[i]->release();
+
+    if (n == count) {
+        count = 0;
+        iovs = 0;
+        sealed = 0;
+        return;
+    }
+
+    const size_t kept = count - n;
+    const size_t first_iov = static_cast<size_t>(msgs[n].msg_hdr.msg_iov - iov);
+
+    std::copy(msgs + n, msgs + count, msgs);
+    std::copy(dest + n, dest + count, dest);
+    std::copy(route + n, route + count, route);
+    std::copy(frames + n, frames + count, frames);
+    std::copy(slab + n, slab + count, slab);
+    std::copy(iov + first_iov, iov + iovs, iov);
+
+    for (size_t i = 0; i < kept; i++) {
+        msghdr& hdr = msgs[i].msg_hdr;
+        hdr.msg_name = &dest[i];
+        hdr.msg_iov -= first_iov;
+    }
+
+    count = kept;
+    iovs -= first_iov;
+    sealed = count;
+}
+
+// ================= DOWNSTREAM =================
+void MavlinkRouter::beginDatagram(const sockaddr_in& src, FrameSlab& slab) {
+    src_ = src;
+    slab_ = &slab;
+    seg_count = 0;
+}
+
+void MavlinkRouter::onFrame(const MavlinkFrameView& frame) {
+
+    // Learn where each vehicle talks from; only a move dirties the line
+    const uint64_t at = packAddr(src_);
+    std::atomic<uint64_t>& known = vehicles_[frame.sysid];
+    if (known.load(std::memory_order_relaxed) != at)
+        known.store(at, std::memory_order_relaxed);
+
+    if (!frame.frame)
+        return;
+
+    uint32_t mask = 0;
+    for (size_t r = 0; r < route_count; r++) {
+        if (routes_[r].allows(frame.sysid, frame.msgid))
+            mask |= uint32_t(1) << r;
+    }
+
+    if (mask)
+        segs_[seg_count++] = Segment{frame.frame, frame.frame_len, mask};
+}
+
+void MavlinkRouter::endDatagram() {
+    if (seg_count == 0)
+        return;
+
+    for (size_t r = 0; r < route_count; r++) {
+        const uint32_t bit = uint32_t(1) << r;
+
+        size_t taken = 0;
+        for (size_t i = 0; i < seg_count; i++)
+            taken += (segs_[i].routes & bit) != 0;
+        if (taken == 0)
+            continue;
+
+        if (!down_.fits(taken)) {
+            flush();
+
+            // Still full of what the clients refused
+            if (!down_.fits(taken)) {
+                bump(routes_[r].drops, taken);
+                continue;
+            }
+        }
+
+        const int route = static_cast<int>(r);
+        const sockaddr_in& dest = routes_[r].config.dest;
+
+        // One outbound datagram per route per vehicle datagram
+        down_.seal();
+        for (size_t i = 0; i < seg_count; i++) {
+            if (segs_[i].routes & bit)
+                down_.add(dest, route, *slab_, segs_[i].data, segs_[i].len);
+        }
+    }
+
+    seg_count = 0;
+}
+
+int MavlinkRouter::flush() {
+    return send(sockfd, down_, false);
+}
+
+// ================= SEND =================
+int MavlinkRouter::send(int fd, TxBatch& batch, bool upstream) {
+    size_t head = 0;
+    int total = 0;
+
+    while (head < batch.count) {
+        int sent = sendmmsg(fd, batch.msgs + head,
+                            static_cast<unsigned>(batch.count - head), MSG_DONTWAIT);
+
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+
+            // Drop the entry that failed so the rest can go
+            LOG_ERROR("ROUTE", "sendmmsg: {}", std::strerror(errno));
+            Route& route = routes_[batch.route[head]];
+            bump(upstream ? route.up_drops : route.drops, batch.frames[head]);
+            head++;
+            continue;
+        }
+
+        for (int i = 0; i < sent; i++) {
+            const size_t m = head + i;
+            Route& route = routes_[batch.route[m]];
+            if (upstream) {
+                bump(route.up_frames, batch.frames[m]);
+                bump(route.up_bytes, batch.msgs[m].msg_len);
+            } else {
+                bump(route.frames, batch.frames[m]);
+                bump(route.bytes, batch.msgs[m].msg_len);
+            }
+        }
+
+        total += sent;
+        head += sent;
+    }
+
+    if (upstream) {
+        for (; head < batch.count; head++)
+            bump(routes_[batch.route[head]].up_drops, batch.frames[head]);
+    }
+
+    batch.consume(head);
+    return total;
+}
+
+// ================= UPSTREAM =================
+int MavlinkRouter::findClient(const sockaddr_in& src) const {
+    for (size_t r = 0; r < route_count; r++) {
+        if (sameAddr(routes_[r].config.dest, src))
+            return static_cast<int>(r);
+    }
+    return -1;
+}
+
+void MavlinkRouter::receiveUpstream() {
+    for (;;) {
+        FrameSlab* slabs[RX_BATCH_SIZE];
+        int count = 0;
+        while (count < RX_BATCH_SIZE && (slabs[count] = pool_->alloc()))
+            count++;
+
+        // Every slab is held; the socket buffer keeps the rest
+        starved_ = count == 0;
+        if (starved_)
+            return;
+
+        for (int i = 0; i < count; i++) {
+            RxDatagram& slot = slabs[i]->dgram;
+
+            rx_iov[i].iov_base = slot.data;
+            rx_iov[i].iov_len = sizeof(slot.data);
+
+            msghdr& hdr = rx_msgs[i].msg_hdr;
+            hdr.msg_name = &slot.src;
+            hdr.msg_namelen = sizeof(slot.src);
+            hdr.msg_iov = &rx_iov[i];
+            hdr.msg_iovlen = 1;
+            hdr.msg_control = nullptr;
+            hdr.msg_controllen = 0;
+            hdr.msg_flags = 0;
+        }
+
+        int n = recvmmsg(sockfd, rx_msgs, count, MSG_DONTWAIT, nullptr);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            perror("recvmmsg");
+
+        for (int i = 0; i < n; i++) {
+            RxDatagram& dgram = slabs[i]->dgram;
+            dgram.len = rx_msgs[i].msg_len;
+
+            // Only configured clients may command the fleet
+            const int route = findClient(dgram.src);
+            if (route < 0) {
+                bump(unknown_clients_, 1);
+                continue;
+            }
+
+            forwardUpstream(route, *slabs[i]);
+        }
+
+        if (n > 0)
+            send(vehicle_fd, up_, true);
+
+        // Anything still queued holds its own reference
+        for (int i = 0; i < count; i++)
+            slabs[i]->release();
+
+        if (n < count)
+            return;
+    }
+}
+
+void MavlinkRouter::forwardUpstream(int route, FrameSlab& slab) {
+    const RxDatagram& dgram = slab.dgram;
+
+    up_.seal();
+    scanner_.scan(dgram.data, dgram.len, [&](const MavlinkFrameView& frame) {
+        const int target = targetSystem(frame);
+
+        if (target > 0) {
+            const uint64_t at = vehicles_[target].load(std::memory_order_relaxed);
+            if (!at) {
+                bump(routes_[route].up_drops, 1);
+                return;
+            }
+            queueUpstream(route, unpackAddr(at), slab, frame);
+            return;
+        }
+
+        // Broadcast: once per vehicle endpoint, however many sysids share it
+        uint64_t sent_to[256];
+        size_t endpoints = 0;
+
+        for (int sysid = 1; sysid < 256; sysid++) {
+            const uint64_t at = vehicles_[sysid].load(std::memory_order_relaxed);
+            if (!at || std::find(sent_to, sent_to + endpoints, at) != sent_to + endpoints)
+                continue;
+            sent_to[endpoints++] = at;
+            queueUpstream(route, unpackAddr(at), slab, frame);
+        }
+    });
+}
+
+void MavlinkRouter::queueUpstream(
+    int route,
+    const sockaddr_in& dest,
+    FrameSlab& slab,
+    const MavlinkFrameView& frame) {
+
+    if (!up_.fits(1))
+        send(vehicle_fd, up_, true);
+    up_.add(dest, route, slab, frame.frame, frame.frame_len);
+}
+
+MavlinkRouter::RouteStats MavlinkRouter::stats(size_t route) const {
+    const Route& r = routes_[route];
+    RouteStats s;
+    s.frames = r.frames.load(std::memory_order_relaxed);
+    s.bytes = r.bytes.load(std::memory_order_relaxed);
+    s.drops = r.drops.load(std::memory_order_relaxed);
+    s.up_frames = r.up_frames.load(std::memory_order_relaxed);
+    s.up_bytes = r.up_bytes.load(std::memory_order_relaxed);
+    s.up_drops = r.up_drops.load(std::memory_order_relaxed);
+    return s;
+}
+
+void MavlinkRouter::collectMetrics(std::string& out) {
+    auto perRoute = [&](const char* name, const char* help, uint64_t RouteStats::*field) {
+        Metrics::family(out, name, "counter", help);
+
+        for (size_t r = 0; r < route_count; r++) {
+            const std::string labels = "route=\"" + routeName(r) + "\"";
+            Metrics::sample(out, name, labels.c_str(), double(stats(r).*field));
+        }
+    };
+
+    perRoute("gcs_route_frames_total", "Vehicle frames forwarded to the client",
+             &RouteStats::frames);
+    perRoute("gcs_route_bytes_total", "Bytes forwarded to the client",
+             &RouteStats::bytes);
+    perRoute("gcs_route_drops_total", "Vehicle frames dropped with the client queue full or a send failing",
+             &RouteStats::drops);
+    perRoute("gcs_route_upstream_frames_total", "Client frames forwarded to vehicles",
+             &RouteStats::up_frames);
+    perRoute("gcs_route_upstream_bytes_total", "Client bytes forwarded to vehicles",
+             &RouteStats::up_bytes);
+    perRoute("gcs_route_upstream_drops_total",
+             "Client frames for an unknown vehicle or lost sending",
+             &RouteStats::up_drops);
+
+    Metrics::family(out, "gcs_route_unknown_client_total", "counter",
+                    "Datagrams on the router port from no configured client");
+    Metrics::sample(out, "gcs_route_unknown_client_total", nullptr, double(unknownClients()));
+}
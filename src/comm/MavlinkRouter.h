@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+
+#include "comm/FramePool.h"
+#include "comm/RxDatagram.h"
+#include "telemetry/MavlinkFrameScanner.h"
+
+// Local port downstream clients talk to
+static constexpr int ROUTER_DEFAULT_PORT = 14551;
+
+// One bit per route in a frame's fan-out mask
+static constexpr size_t ROUTER_MAX_ROUTES = 32;
+
+// Smallest frame is a v1 header + CRC with no payload
+static constexpr size_t ROUTER_MAX_FRAMES_PER_DATAGRAM = RX_DATAGRAM_MAX / 8;
+
+// Outbound datagrams and iovecs per sendmmsg
+static constexpr size_t ROUTER_TX_BATCH = 256;
+static constexpr size_t ROUTER_TX_IOV = 2048;
+
+// One downstream GCS client. Frames pass when their sysid and
+// msgid are both allowed; an empty filter allows everything.
+struct RouteConfig {
+    sockaddr_in dest{};
+    std::bitset<256> sysids;
+    std::vector<uint32_t> msgids;
+};
+
+// -------------------------------------------------
+// Router mode: fans vehicle traffic out to downstream
+// GCS clients and passes their traffic back up.
+//
+// Down (parse side): every frame the GroundStation
+// scans is checked against each route's filters, and
+// the frames a route takes go out as one datagram whose
+// iovecs point into the receive slab itself, merged
+// where they are contiguous. Nothing is copied: each
+// queued datagram holds a reference to its slab, so
+// what a full client socket refuses stays queued for
+// the next flush() instead of being dropped.
+//
+// Up (router socket): client frames go to the vehicle
+// that owns their target_system, looked up in a sysid
+// -> endpoint table learned from vehicle traffic.
+// Broadcasts and untargeted frames go to every vehicle.
+// They leave through the vehicle socket, so vehicles
+// keep a single peer address. Client datagrams are
+// received into slabs from the same pool.
+// -------------------------------------------------
+class MavlinkRouter {
+public:
+    struct RouteStats {
+        uint64_t frames = 0;        // vehicle frames sent to the client
+        uint64_t bytes = 0;
+        uint64_t drops = 0;         // frames lost to a full queue or failed send
+        uint64_t up_frames = 0;     // client frames passed to vehicles
+        uint64_t up_bytes = 0;
+        uint64_t up_drops = 0;      // client frames for an unknown vehicle or lost sending
+    };
+
+    ~MavlinkRouter();
+
+    // Binds the router socket on `port`; upstream frames are sent
+    // on `vehicle_fd` and received into slabs from `pool`, on the
+    // pool's allocating thread. Fails on a bad route list or socket error.
+    bool start(int port, int vehicle_fd, const std::vector<RouteConfig>& routes,
+               FramePool& pool);
+
+    int getSocketFd() const { return sockfd; }
+    size_t routeCount() const { return route_count; }
+    std::string routeName(size_t route) const;
+
+    // ---------- Parse side ----------
+    // The GroundStation brackets every vehicle datagram it scans
+    void beginDatagram(const sockaddr_in& src, FrameSlab& slab);
+    void onFrame(const MavlinkFrameView& frame);
+    void endDatagram();
+
+    // Sends what the client sockets take; the rest stays queued.
+    // Returns the datagrams sent.
+    int flush();
+    bool backlogged() const { return down_.count != 0; }
+
+    // ---------- Router socket side ----------
+    // Drains client traffic and forwards it upstream
+    void receiveUpstream();
+
+    // The last receiveUpstream() stopped with no free slab to fill
+    bool starved() const { return starved_; }
+
+    // Any thread
+    RouteStats stats(size_t route) const;
+    uint64_t unknownClients() const { return unknown_clients_.load(std::memory_order_relaxed); }
+
+private:
+    struct Route {
+        RouteConfig config;
+        std::vector<uint64_t> msgid_bits;   // empty: every msgid
+
+        bool allows(uint8_t sysid, uint32_t msgid) const;
+
+        // Each counter has a single writer: the parse side
+        // for downstream, the router socket side for upstream
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> drops{0};
+        std::atomic<uint64_t> up_frames{0};
+        std::atomic<uint64_t> up_bytes{0};
+        std::atomic<uint64_t> up_drops{0};
+    };
+
+    // A frame of the current datagram and the routes taking it
+    struct Segment {
+        const uint8_t* data;
+        uint16_t len;
+        uint32_t routes;
+    };
+
+    // Outbound datagrams gathered from receive slabs, one
+    // reference held per datagram until it is sent or dropped
+    struct TxBatch {
+        mmsghdr msgs[ROUTER_TX_BATCH];
+        iovec iov[ROUTER_TX_IOV];
+        sockaddr_in dest[ROUTER_TX_BATCH];
+        int route[ROUTER_TX_BATCH];
+        uint32_t frames[ROUTER_TX_BATCH];
+        FrameSlab* slab[ROUTER_TX_BATCH];
+        size_t count = 0;
+        size_t iovs = 0;
+        size_t sealed = 0;          // datagrams below this take no more pieces
+
+        bool fits(size_t n) const {
+            return count < ROUTER_TX_BATCH && iovs + n <= ROUTER_TX_IOV;
+        }
+
+        // Extends the last datagram when it is unsealed and goes to
+        // the same place (one iovec when `data` follows on), else
+        // opens a new one
+        void seal() { sealed = count; }
+        void add(const sockaddr_in& to, int r, FrameSlab& from,
+                 const uint8_t* data, size_t len);
+
+        // Releases datagrams [0, n) and moves the rest to the front
+        void consume(size_t n);
+    };
+
+    static bool sameAddr(const sockaddr_in& a, const sockaddr_in& b) {
+        return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+    }
+
+    static void bump(std::atomic<uint64_t>& c, uint64_t n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // sendmmsg until done or EAGAIN. Downstream keeps what is left
+    // for the next flush; upstream drops it, clients retry commands.
+    int send(int fd, TxBatch& batch, bool upstream);
+
+    int findClient(const sockaddr_in& src) const;
+    void forwardUpstream(int route, FrameSlab& slab);
+    void queueUpstream(int route, const sockaddr_in& dest, FrameSlab& slab,
+                       const MavlinkFrameView& frame);
+
+    // Per-route families; runs on the metrics scraper
+    void collectMetrics(std::string& out);
+
+    int sockfd = -1;
+    int vehicle_fd = -1;
+    std::unique_ptr<Route[]> routes_;
+    size_t route_count = 0;
+
+    // ---- Parse side ----
+    sockaddr_in src_{};
+    FrameSlab* slab_ = nullptr;
+    Segment segs_[ROUTER_MAX_FRAMES_PER_DATAGRAM];
+    size_t seg_count = 0;
+    TxBatch down_;
+
+    // sysid -> vehicle endpoint (addr << 16 | port), 0 until heard.
+    // Written by the parse side, read by the router socket side.
+    std::atomic<uint64_t> vehicles_[256] = {};
+
+    // ---- Router socket side ----
+    FramePool* pool_ = nullptr;
+    mmsghdr rx_msgs[RX_BATCH_SIZE];
+    iovec rx_iov[RX_BATCH_SIZE];
+    bool starved_ = false;
+    MavlinkFrameScanner scanner_;
+    TxBatch up_;
+
+    std::atomic<uint64_t> unknown_clients_{0};
+    int metrics_collector = 0;
+};
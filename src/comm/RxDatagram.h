@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <netinet/in.h>
+
+static constexpr size_t RX_DATAGRAM_MAX = 2048;
+static constexpr int RX_BATCH_SIZE = 64;
+
+// One received UDP datagram, filled in place by recvmmsg or io_uring;
+// lives in a FrameSlab
+struct RxDatagram {
+    uint32_t len = 0;
+    sockaddr_in src{};
+    timespec rx_time{};        // kernel receive time (SO_TIMESTAMPNS, CLOCK_REALTIME)
+    alignas(64) uint8_t data[RX_DATAGRAM_MAX];
+};
@@ -0,0 +1,252 @@
+#include "comm/TxQueue.h"
+#include "comm/IoUring.h"
+
+#include "core/Logger.h"
+#include "core/Metrics.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+// Completions for a full queue of sends, with room to spare
+static constexpr unsigned TX_URING_CQ_ENTRIES = 2 * TX_QUEUE_DEPTH;
+
+TxQueue::TxQueue() = default;
+TxQueue::~TxQueue() = default;
+
+bool TxQueue::useUring() {
+    auto ring = std::make_unique<IoUring>();
+    if (!ring->setup(TX_QUEUE_DEPTH, TX_URING_CQ_ENTRIES))
+        return false;
+
+    uring = std::move(ring);
+    return true;
+}
+
+int TxQueue::pushFrame(const mavlink_message_t& msg) {
+    if (frame_count >= TX_QUEUE_FRAMES) {
+        stats_.dropped_full++;
+        Metrics::local().add(Counter::TX_DROPPED);
+        return -1;
+    }
+
+    Frame& f = frames[frame_count];
+    f.len = mavlink_msg_to_send_buffer(f.data, &msg);
+    return frame_count++;
+}
+
+int TxQueue::pushEncoded(const uint8_t* data, size_t len) {
+    if (frame_count >= TX_QUEUE_FRAMES || len > MAVLINK_MAX_PACKET_LEN) {
+        stats_.dropped_full++;
+        Metrics::local().add(Counter::TX_DROPPED);
+        return -1;
+    }
+
+    Frame& f = frames[frame_count];
+    std::memcpy(f.data, data, len);
+    f.len = static_cast<uint16_t>(len);
+    return frame_count++;
+}
+
+bool TxQueue::enqueue(int frame, const sockaddr_in& dest) {
+    if (frame < 0 || frame >= frame_count || queued >= TX_QUEUE_DEPTH) {
+        stats_.dropped_full++;
+        Metrics::local().add(Counter::TX_DROPPED);
+        return false;
+    }
+
+    entries[queued++] = Entry{frame, dest};
+    return true;
+}
+
+void TxQueue::reset() {
+    head = 0;
+    queued = 0;
+    frame_count = 0;
+}
+
+int TxQueue::flush() {
+    if (head == queued) {
+        reset();
+        return 0;
+    }
+
+    stats_.flush_calls++;
+
+    MetricsShard& m = Metrics::local();
+    int total = 0;
+
+    while (head < queued) {
+        int count = queued - head;
+
+        for (int i = 0; i < count; i++) {
+            const Entry& e = entries[head + i];
+            Frame& f = frames[e.frame];
+
+            tx_iov[i].iov_base = f.data;
+            tx_iov[i].iov_len = f.len;
+
+            msghdr& hdr = tx_msgs[i].msg_hdr;
+            hdr.msg_name = const_cast<sockaddr_in*>(&e.dest);
+            hdr.msg_namelen = sizeof(e.dest);
+            hdr.msg_iov = &tx_iov[i];
+            hdr.msg_iovlen = 1;
+            hdr.msg_control = nullptr;
+            hdr.msg_controllen = 0;
+            hdr.msg_flags = 0;
+        }
+
+        if (uring) {
+            const int sent = sendUring(count);
+            if (sent < 0)
+                continue;       // ring gone; sendmmsg takes over
+
+            total += sent;
+            if (head < queued) {
+                m.set(Gauge::TX_QUEUE_DEPTH, static_cast<int64_t>(pending()));
+                return total;
+            }
+            break;
+        }
+
+        int sent = sendmmsg(sockfd, tx_msgs, count, MSG_DONTWAIT);
+
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                stats_.eagain++;
+                m.add(Counter::TX_EAGAIN);
+                m.set(Gauge::TX_QUEUE_DEPTH, static_cast<int64_t>(pending()));
+                return total;
+            }
+
+            // The first entry failed hard; drop it so the rest can go
+            LOG_ERROR("TX", "sendmmsg: {}", std::strerror(errno));
+            stats_.send_errors++;
+            m.add(Counter::TX_ERRORS);
+            head++;
+            continue;
+        }
+
+        uint64_t bytes = 0;
+        for (int i = 0; i < sent; i++)
+            bytes += tx_msgs[i].msg_len;
+
+        stats_.bytes_sent += bytes;
+        stats_.frames_sent += sent;
+        m.add(Counter::BYTES_OUT, bytes);
+        m.add(Counter::DATAGRAMS_OUT, static_cast<uint64_t>(sent));
+        total += sent;
+        head += sent;
+
+        if (sent < count)
+            stats_.partial_sends++;
+    }
+
+    m.set(Gauge::TX_QUEUE_DEPTH, 0);
+    reset();
+    return total;
+}
+
+// Every entry goes out in one submit; unlike sendmmsg a failure does
+// not stop the ones behind it. EAGAIN entries stay queued, in order,
+// for the next flush; hard errors drop just that entry. Entries the
+// kernel never took or never completed count as EAGAIN too. Returns
+// the number sent, or -1 when the ring itself failed (nothing was sent).
+int TxQueue::sendUring(int count) {
+    if (!uring->isEnabled() && !uring->enable()) {
+        LOG_WARN("TX", "io_uring enable: {}, back to sendmmsg", std::strerror(errno));
+        uring.reset();
+        return -1;
+    }
+
+    // The SQ holds a full queue, so this only stops short on a bug
+    int prepared = 0;
+    for (; prepared < count; prepared++) {
+        io_uring_sqe* sqe = uring->getSqe();
+        if (!sqe)
+            break;
+
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = sockfd;
+        sqe->addr = reinterpret_cast<uint64_t>(&tx_msgs[prepared].msg_hdr);
+        sqe->len = 1;
+        sqe->msg_flags = MSG_DONTWAIT;
+        sqe->user_data = static_cast<uint64_t>(prepared);
+    }
+
+    const int submitted = uring->submit(static_cast<unsigned>(prepared));
+    if (submitted < 0) {
+        LOG_ERROR("TX", "io_uring_enter: {}, back to sendmmsg", std::strerror(errno));
+        uring.reset();
+        return -1;
+    }
+
+    // A send the ring took but never completed may already be on the
+    // wire, so it counts as an error rather than going out twice.
+    // Only what the ring never took is retried.
+    int results[TX_QUEUE_DEPTH];
+    std::fill(results, results + submitted, -ECANCELED);
+    std::fill(results + submitted, results + count, -EAGAIN);
+
+    // tx_msgs is rebuilt on the next flush: every submitted send
+    // must have completed before this returns
+    bool ring_failed = submitted < prepared;
+    int reaped = 0;
+    for (;;) {
+        reaped += static_cast<int>(uring->reap([&](const io_uring_cqe& cqe) {
+            if (cqe.user_data < static_cast<uint64_t>(count))
+                results[cqe.user_data] = cqe.res;
+        }));
+
+        if (reaped >= submitted)
+            break;
+        if (uring->submit(static_cast<unsigned>(submitted - reaped)) < 0) {
+            ring_failed = true;
+            break;
+        }
+    }
+
+    // Tearing the ring down discards SQEs it never took and cancels
+    // whatever is still in flight; sendmmsg sends the rest
+    if (ring_failed) {
+        LOG_ERROR("TX", "io_uring took {} of {} sends, {} completed, {} dropped; back to sendmmsg",
+                  submitted, count, reaped, submitted - reaped);
+        uring.reset();
+    }
+
+    MetricsShard& m = Metrics::local();
+    int keep = head;
+    int sent = 0;
+    uint64_t bytes = 0;
+
+    for (int i = 0; i < count; i++) {
+        const int r = results[i];
+        if (r >= 0) {
+            sent++;
+            bytes += static_cast<uint64_t>(r);
+        } else if (r == -EAGAIN) {
+            entries[keep++] = entries[head + i];
+        } else {
+            // Unreaped sends were reported above
+            if (r != -ECANCELED)
+                LOG_ERROR("TX", "sendmsg: {}", std::strerror(-r));
+            stats_.send_errors++;
+            m.add(Counter::TX_ERRORS);
+        }
+    }
+
+    if (keep != head) {
+        stats_.eagain++;
+        m.add(Counter::TX_EAGAIN);
+    }
+    if (sent > 0 && sent < count)
+        stats_.partial_sends++;
+
+    stats_.bytes_sent += bytes;
+    stats_.frames_sent += sent;
+    m.add(Counter::BYTES_OUT, bytes);
+    m.add(Counter::DATAGRAMS_OUT, static_cast<uint64_t>(sent));
+
+    queued = keep;
+    return sent;
+}
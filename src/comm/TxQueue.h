@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+static constexpr int TX_QUEUE_FRAMES = 256;
+static constexpr int TX_QUEUE_DEPTH  = 512;
+
+class IoUring;
+
+// -------------------------------------------------
+// Outbound frame queue flushed with one sendmmsg.
+// Frames are encoded once into a preallocated arena
+// and may be queued to any number of destinations;
+// every destination shares the same frame bytes.
+//
+// With io_uring, a flush is one SENDMSG SQE per entry
+// submitted in a single io_uring_enter that also waits
+// for their completions; the arena is reused only
+// once the kernel is done with every frame.
+// -------------------------------------------------
+class TxQueue {
+public:
+    struct Stats {
+        uint64_t frames_sent = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t flush_calls = 0;
+        uint64_t partial_sends = 0;   // sendmmsg sent fewer than queued
+        uint64_t eagain = 0;          // socket buffer full, retried next flush
+        uint64_t send_errors = 0;     // entry dropped after a hard error
+        uint64_t dropped_full = 0;    // no room in arena or queue
+    };
+
+    TxQueue();
+    ~TxQueue();
+
+    void bind(int socket_fd) { sockfd = socket_fd; }
+
+    // Sends through io_uring from here on; false (sendmmsg stays)
+    // when the kernel can't. The thread of the first flush owns the ring.
+    bool useUring();
+    bool usesUring() const { return uring != nullptr; }
+
+    // Encodes msg straight into the arena. Returns a frame
+    // handle for enqueue(), or -1 when the arena is full.
+    int pushFrame(const mavlink_message_t& msg);
+
+    // Copies a frame encoded earlier (e.g. a cached mission item);
+    // same handle and arena rules as pushFrame()
+    int pushEncoded(const uint8_t* data, size_t len);
+
+    bool enqueue(int frame, const sockaddr_in& dest);
+
+    // Sends everything queued; unsent entries stay queued on EAGAIN.
+    // Returns the number of datagrams sent.
+    int flush();
+
+    // Drops everything queued without sending (replay has no peers)
+    void discard() { reset(); }
+
+    size_t pending() const { return static_cast<size_t>(queued - head); }
+
+    // Frames that can still be pushed before the next flush
+    size_t framesFree() const { return static_cast<size_t>(TX_QUEUE_FRAMES - frame_count); }
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Frame {
+        uint16_t len;
+        uint8_t data[MAVLINK_MAX_PACKET_LEN];
+    };
+
+    struct Entry {
+        int frame;
+        sockaddr_in dest;
+    };
+
+    void reset();
+    int sendUring(int count);
+
+    int sockfd = -1;
+    std::unique_ptr<IoUring> uring;
+
+    Frame frames[TX_QUEUE_FRAMES];
+    int frame_count = 0;
+
+    Entry entries[TX_QUEUE_DEPTH];
+    int head = 0;
+    int queued = 0;
+
+    mmsghdr tx_msgs[TX_QUEUE_DEPTH];
+    iovec tx_iov[TX_QUEUE_DEPTH];
+
+    Stats stats_;
+};
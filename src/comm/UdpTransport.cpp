@@ -1,18 +1,74 @@
 #include "comm/UdpTransport.h"
+#include "comm/IoUring.h"
+#include "core/Logger.h"
+#include "core/Metrics.h"
 
+#include <algorithm>
 #include <arpa/inet.h>
+#include <cerrno>
+#include <cstddef>
 #include <cstring>
-#include <iostream>
 #include <unistd.h>
 
-bool UdpTransport::start(int port) {
+// Buffer group of the receive slabs
+static constexpr uint16_t URING_RX_BGID = 0;
 
-    sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+// Room for one SCM_TIMESTAMPNS
+static constexpr size_t URING_CMSG_SPACE = CMSG_SPACE(sizeof(timespec));
+
+// The kernel lays out a multishot RECVMSG buffer as header, name,
+// control, payload. Sized like this, a slab's datagram is the
+// buffer: the payload lands in data and the prefix overlays len,
+// src and rx_time, which are filled in from it afterwards.
+static constexpr size_t URING_RX_PREFIX =
+    sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_in) + URING_CMSG_SPACE;
+static_assert(URING_RX_PREFIX == offsetof(RxDatagram, data),
+              "recvmsg prefix must end where RxDatagram::data starts");
+
+const char* udpBackendName(UdpBackend backend) {
+    switch (backend) {
+    case UdpBackend::EPOLL: return "epoll";
+    case UdpBackend::URING: return "io_uring";
+    }
+    return "unknown";
+}
+
+// Kernel receive time if SO_TIMESTAMPNS delivered one, else now
+static void stampSlot(msghdr& hdr, RxDatagram& slot) {
+    for (cmsghdr* c = CMSG_FIRSTHDR(&hdr); c; c = CMSG_NXTHDR(&hdr, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+            std::memcpy(&slot.rx_time, CMSG_DATA(c), sizeof(slot.rx_time));
+            return;
+        }
+    }
+    clock_gettime(CLOCK_REALTIME, &slot.rx_time);
+}
+
+UdpTransport::UdpTransport() = default;
+UdpTransport::~UdpTransport() = default;
+
+bool UdpTransport::start(int port, FramePool& pool, UdpBackend backend) {
+
+    pool_ = &pool;
+
+    // Non-blocking: the event loop drains the socket until EAGAIN
+    sockfd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
     if (sockfd < 0) {
         perror("socket");
         return false;
     }
 
+    // Kernel receive timestamps ride along as SCM_TIMESTAMPNS
+    int on = 1;
+    if (setsockopt(sockfd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) < 0)
+        perror("setsockopt(SO_TIMESTAMPNS)");
+
+    // A fleet answering a burst of windowed mission requests at once
+    // outruns the default buffer; the kernel caps this at rmem_max
+    int rcvbuf = UDP_RCVBUF_BYTES;
+    if (setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) < 0)
+        perror("setsockopt(SO_RCVBUF)");
+
     sockaddr_in local_addr{};
     local_addr.sin_family = AF_INET;
     local_addr.sin_addr.s_addr = INADDR_ANY;
@@ -26,14 +82,231 @@ bool UdpTransport::start(int port) {
         return false;
     }
 
-    std::cout << "[UDP] Listening on port " << port << std::endl;
+    tx.bind(sockfd);
+
+    if (backend == UdpBackend::URING) {
+        if (setupRing()) {
+            backend_ = UdpBackend::URING;
+            if (!tx.useUring())
+                LOG_WARN("UDP", "io_uring send unavailable ({}), using sendmmsg",
+                         std::strerror(errno));
+        } else {
+            LOG_WARN("UDP", "io_uring unavailable ({}), using epoll", std::strerror(errno));
+        }
+    }
+
+    LOG_INFO("UDP", "Listening on port {} ({})", port, udpBackendName(backend_));
     return true;
 }
 
-int UdpTransport::receive(uint8_t* buffer, size_t len) {
-    return recvfrom(sockfd, buffer, len, 0, nullptr, nullptr);
+int UdpTransport::receive(FrameSlab** out, int max) {
+    return backend_ == UdpBackend::URING ? receiveRing(out, max) : receiveMmsg(out, max);
+}
+
+// ---------------- epoll receive ----------------
+int UdpTransport::receiveMmsg(FrameSlab** out, int max) {
+
+    int count = 0;
+    while (count < max && (out[count] = pool_->alloc()))
+        count++;
+
+    // Every slab is held: leave the datagrams in the socket buffer
+    starved_ = count == 0;
+    if (starved_)
+        return 0;
+
+    for (int i = 0; i < count; i++) {
+        RxDatagram& slot = out[i]->dgram;
+
+        rx_iov[i].iov_base = slot.data;
+        rx_iov[i].iov_len = sizeof(slot.data);
+
+        msghdr& hdr = rx_msgs[i].msg_hdr;
+        hdr.msg_name = &slot.src;
+        hdr.msg_namelen = sizeof(slot.src);
+        hdr.msg_iov = &rx_iov[i];
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = rx_cmsg[i];
+        hdr.msg_controllen = RX_CMSG_SPACE;
+        hdr.msg_flags = 0;
+    }
+
+    int n = recvmmsg(sockfd, rx_msgs, count, MSG_DONTWAIT, nullptr);
+    const int err = errno;
+
+    // Unfilled slabs go straight back
+    for (int i = n > 0 ? n : 0; i < count; i++)
+        out[i]->release();
+
+    if (n < 0)
+        return (err == EAGAIN || err == EWOULDBLOCK) ? 0 : -1;
+
+    size_t bytes = 0;
+
+    for (int i = 0; i < n; i++) {
+        RxDatagram& slot = out[i]->dgram;
+        msghdr& hdr = rx_msgs[i].msg_hdr;
+
+        slot.len = rx_msgs[i].msg_len;
+        bytes += slot.len;
+
+        stampSlot(hdr, slot);
+    }
+
+    MetricsShard& m = Metrics::local();
+    m.add(Counter::DATAGRAMS_IN, static_cast<uint64_t>(n));
+    m.add(Counter::BYTES_IN, bytes);
+
+    return n;
+}
+
+// ---------------- io_uring receive ----------------
+bool UdpTransport::setupRing() {
+    const uint32_t slabs = pool_->size();
+    if (slabs == 0 || (slabs & (slabs - 1)) != 0) {
+        errno = EINVAL;     // buffer rings are a power of two
+        return false;
+    }
+
+    auto ring = std::make_unique<IoUring>();
+
+    // One SQE re-arms; the CQ absorbs every slab's datagram and then some
+    if (!ring->setup(8, 2 * slabs))
+        return false;
+
+    ring_bufs = ring->registerBufRing(slabs, URING_RX_BGID);
+    if (!ring_bufs)
+        return false;
+    ring_mask = slabs - 1;
+
+    ring_msg.msg_namelen = sizeof(sockaddr_in);
+    ring_msg.msg_controllen = URING_CMSG_SPACE;
+
+    rx_ring = std::move(ring);
+    return true;
+}
+
+bool UdpTransport::startRing() {
+    if (!rx_ring->enable()) {
+        perror("io_uring_register(ENABLE_RINGS)");
+        return false;
+    }
+
+    refillRing();
+    return arm();
+}
+
+// Free slabs go to the kernel, each keeping the reference alloc()
+// gave it; the datagram's receiver inherits that reference
+void UdpTransport::refillRing() {
+    unsigned added = 0;
+    while (FrameSlab* slab = pool_->alloc()) {
+        addBuffer(ring_bufs, ring_mask, added++, &slab->dgram, sizeof(RxDatagram),
+                  static_cast<uint16_t>(slab->index));
+    }
+
+    if (added == 0)
+        return;
+
+    advanceBufRing(ring_bufs, added);
+    ring_free += added;
+}
+
+bool UdpTransport::arm() {
+    io_uring_sqe* sqe = rx_ring->getSqe();
+    if (!sqe)
+        return false;
+
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = sockfd;
+    sqe->addr = reinterpret_cast<uint64_t>(&ring_msg);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_RX_BGID;
+
+    if (rx_ring->submit() < 0) {
+        LOG_ERROR("UDP", "io_uring_enter: {}", std::strerror(errno));
+        return false;
+    }
+
+    armed = true;
+    starved_ = false;
+    return true;
+}
+
+int UdpTransport::receiveRing(FrameSlab** out, int max) {
+    refillRing();
+
+    int n = 0;
+    size_t bytes = 0;
+    bool failed = false;
+
+    rx_ring->reap([&](const io_uring_cqe& cqe) {
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            FrameSlab& slab = pool_->slab(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            RxDatagram& dgram = slab.dgram;
+            ring_free--;
+
+            // Copy the prefix out before the fields it overlays are written
+            const uint8_t* raw = reinterpret_cast<const uint8_t*>(&dgram);
+            io_uring_recvmsg_out msg_out;
+            std::memcpy(&msg_out, raw, sizeof(msg_out));
+
+            sockaddr_in src{};
+            std::memcpy(&src, raw + sizeof(msg_out),
+                        std::min<size_t>(msg_out.namelen, sizeof(src)));
+
+            alignas(cmsghdr) uint8_t control[URING_CMSG_SPACE];
+            const size_t control_len = std::min<size_t>(msg_out.controllen, URING_CMSG_SPACE);
+            std::memcpy(control, raw + sizeof(msg_out) + sizeof(src), control_len);
+
+            // Truncated like recvmmsg: what fit in data
+            dgram.len = std::min<uint32_t>(msg_out.payloadlen, RX_DATAGRAM_MAX);
+            dgram.src = src;
+
+            msghdr hdr{};
+            hdr.msg_control = control;
+            hdr.msg_controllen = control_len;
+            stampSlot(hdr, dgram);
+
+            bytes += dgram.len;
+            out[n++] = &slab;
+        }
+
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            armed = false;
+            if (cqe.res == -ENOBUFS) {
+                Metrics::local().add(Counter::UDP_RING_STARVED);
+            } else if (cqe.res < 0) {
+                LOG_ERROR("UDP", "multishot recvmsg: {}", std::strerror(-cqe.res));
+                failed = cqe.res != -EINTR && cqe.res != -ECANCELED;
+            }
+        }
+    }, static_cast<unsigned>(max));
+
+    // Ended with slabs to spare (CQ overflow, signal): go again at once.
+    // With none, the next receive after some are released re-arms.
+    if (!armed && !failed) {
+        if (ring_free > 0)
+            failed = !arm();
+        else
+            starved_ = true;
+    }
+
+    if (n > 0) {
+        MetricsShard& m = Metrics::local();
+        m.add(Counter::DATAGRAMS_IN, static_cast<uint64_t>(n));
+        m.add(Counter::BYTES_IN, bytes);
+    }
+
+    return n > 0 ? n : (failed ? -1 : 0);
 }
 
 int UdpTransport::getSocketFd() const {
     return sockfd;
 }
+
+int UdpTransport::getReceiveFd() const {
+    return backend_ == UdpBackend::URING ? rx_ring->fd() : sockfd;
+}
@@ -1,13 +1,94 @@
 #pragma once
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
+#include "comm/FramePool.h"
+#include "comm/RxDatagram.h"
+#include "comm/TxQueue.h"
+
+static constexpr int UDP_RCVBUF_BYTES = 4 * 1024 * 1024;
+
+class IoUring;
+struct io_uring_buf_ring;
+
+enum class UdpBackend : uint8_t {
+    EPOLL,      // readiness, then recvmmsg/sendmmsg into pool slabs
+    URING       // multishot RECVMSG into a provided-buffer ring
+};
+
+const char* udpBackendName(UdpBackend backend);
+
+// -------------------------------------------------
+// The vehicle-facing socket. Datagrams land in slabs
+// from the FramePool and are handed out with one
+// reference each.
+//
+// Under io_uring a single multishot RECVMSG stays
+// armed and the kernel writes each datagram straight
+// into a slab from a registered buffer ring. Slabs
+// return to the ring from the pool, so only once every
+// holder (parser, recorder, router) has released them.
+// With none free the receive disarms and datagrams
+// wait in the socket buffer until slabs come back.
+// -------------------------------------------------
 class UdpTransport {
 public:
-    bool start(int port);
-    int receive(uint8_t* buffer, size_t len);
+    UdpTransport();
+    ~UdpTransport();
+
+    // The receiving thread is the pool's only allocator. URING falls
+    // back to EPOLL, with a warning, when the kernel can't.
+    bool start(int port, FramePool& pool, UdpBackend backend = UdpBackend::EPOLL);
+    UdpBackend backend() const { return backend_; }
+
+    // URING only: on the receiving thread, before the first receive;
+    // that thread owns the ring from then on
+    bool startRing();
+
+    // Up to max (at most RX_BATCH_SIZE) datagrams, each in a slab the
+    // caller holds one reference to. 0 when drained or starved, -1 on error.
+    int receive(FrameSlab** out, int max);
+
+    // The last receive() had no free slab to fill (EPOLL), or the ring
+    // is disarmed (URING); a later receive() after releases recovers
+    bool starved() const { return starved_; }
+
     int getSocketFd() const;
 
+    // Readable when datagrams are waiting: the socket, or the ring
+    int getReceiveFd() const;
+
+    // Outbound frames; flushed once per event-loop iteration
+    TxQueue& txQueue() { return tx; }
+
 private:
+    // Preallocated recvmmsg scaffolding, re-pointed at the batch per call
+    static constexpr size_t RX_CMSG_SPACE = 64;
+
+    int receiveMmsg(FrameSlab** out, int max);
+    int receiveRing(FrameSlab** out, int max);
+
+    bool setupRing();
+    void refillRing();
+    bool arm();
+
     int sockfd = -1;
+    UdpBackend backend_ = UdpBackend::EPOLL;
+    FramePool* pool_ = nullptr;
+    bool starved_ = false;
+    TxQueue tx;
+
+    std::unique_ptr<IoUring> rx_ring;
+    io_uring_buf_ring* ring_bufs = nullptr;
+    uint32_t ring_mask = 0;
+    msghdr ring_msg{};          // name and control sizes for the kernel's layout
+    uint32_t ring_free = 0;     // slabs the kernel can fill
+    bool armed = false;
+
+    mmsghdr rx_msgs[RX_BATCH_SIZE];
+    iovec rx_iov[RX_BATCH_SIZE];
+    alignas(cmsghdr) uint8_t rx_cmsg[RX_BATCH_SIZE][RX_CMSG_SPACE];
 };
@@ -1,10 +1,24 @@
 #pragma once
+#include <cstdint>
+
 #include "VehicleCommand.h"
-#include "telemetry/TelemetryData.h"
+#include "CommandRules.h"
+
+// How a command may overlap with others in flight on the same vehicle.
+// Two commands with the same (target comp, command id) never overlap:
+// their ACKs could not be told apart.
+enum class CommandConcurrency : uint8_t {
+    SERIAL,       // flight-state chain (ARM -> AUTO -> TAKEOFF): one at a time
+    CONCURRENT    // independent of the chain, e.g. LAND must never queue
+};
 
 struct CommandDefinition {
     VehicleCommand logical;
     uint16_t mavlink_id;
+    float param1;                 // e.g. 1 = arm, 0 = disarm
+
+    CommandRule rule;
 
-    bool (*allowed)(const TelemetryData&);
+    CommandConcurrency concurrency = CommandConcurrency::SERIAL;
+    uint8_t target_comp = MAV_COMP_ID_AUTOPILOT1;
 };
@@ -1,155 +1,215 @@
 #include "command/CommandManager.h"
 #include "command/MavlinkCommandSender.h"
+#include "command/CommandTable.h"
+
+#include "core/Logger.h"
+#include "core/Metrics.h"
 
-#include <iostream>
 #include <chrono>
 
 using namespace std;
 
-static constexpr int COMMAND_ACK_TIMEOUT_MS = 3000;
-static CommandBlockReason last_printed_reason = CommandBlockReason::NONE;
-
-// -------------------------------------------------
-bool CommandManager::isCommandAllowed(
-    VehicleCommand cmd,
-    SystemState state,
-    const TelemetryData& telemetry,
-    CommandBlockReason& out_reason) const {
-
-    out_reason = CommandBlockReason::NONE;
+static constexpr chrono::milliseconds COMMAND_ACK_TIMEOUT{3000};
 
-    if (state == SystemState::FAILSAFE) {
-        out_reason = CommandBlockReason::FAILSAFE_ACTIVE;
-        return false;
+CommandManager::CommandManager() {
+    for (size_t i = 0; i < COMMAND_PENDING_MAX; i++) {
+        timers_[i].fn = onAckTimeout;
+        timers_[i].owner = this;
+        timers_[i].tag = static_cast<uint32_t>(i);
     }
+}
 
-    switch (cmd) {
+// ---------------- Pending table ----------------
+int CommandManager::findPending(uint32_t key) const {
+    for (size_t s = homeSlot(key);; s = (s + 1) & (INDEX_SIZE - 1)) {
+        uint8_t e = index_[s];
+        if (e == 0)
+            return -1;
+        if (entry_keys_[e - 1] == key)
+            return e - 1;
+    }
+}
 
-    case VehicleCommand::ARM:
-        if (!telemetry.ekf_ok) {
-            out_reason = CommandBlockReason::EKF_NOT_READY;
-            return false;
-        }
-        if (!telemetry.battery_ok) {
-            out_reason = CommandBlockReason::BATTERY_LOW;
-            return false;
-        }
-        if (!telemetry.isLanded()) {
-            out_reason = CommandBlockReason::VEHICLE_NOT_LANDED;
-            return false;
-        }
-        if (telemetry.arm_state != ArmState::DISARMED) {
-            out_reason = CommandBlockReason::VEHICLE_NOT_ARMED;
-            return false;
+int CommandManager::insertPending(uint32_t key, const TrackedCommand& tc) {
+    int entry = -1;
+    for (size_t i = 0; i < COMMAND_PENDING_MAX; i++) {
+        if (!entry_used_[i]) {
+            entry = static_cast<int>(i);
+            break;
         }
-        return true;
+    }
+    if (entry < 0)
+        return -1;
 
-    case VehicleCommand::SET_MODE_AUTO:
-        return telemetry.arm_state == ArmState::ARMED;
+    entries_[entry] = tc;
+    entry_keys_[entry] = key;
+    entry_used_[entry] = true;
 
-    case VehicleCommand::TAKEOFF:
-        return telemetry.arm_state == ArmState::ARMED &&
-               telemetry.isLanded();
+    size_t s = homeSlot(key);
+    while (index_[s] != 0)
+        s = (s + 1) & (INDEX_SIZE - 1);
+    index_[s] = static_cast<uint8_t>(entry + 1);
 
-    case VehicleCommand::LAND:
-        return telemetry.isAirborne();
+    pending_count_++;
+    if (tc.concurrency == CommandConcurrency::SERIAL)
+        serial_pending_++;
 
-    default:
-        return false;
+    return entry;
+}
+
+void CommandManager::erasePending(int entry) {
+    size_t s = homeSlot(entry_keys_[entry]);
+    while (index_[s] != entry + 1)
+        s = (s + 1) & (INDEX_SIZE - 1);
+    index_[s] = 0;
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    for (size_t j = (s + 1) & (INDEX_SIZE - 1); index_[j] != 0;
+         j = (j + 1) & (INDEX_SIZE - 1)) {
+
+        size_t home = homeSlot(entry_keys_[index_[j] - 1]);
+        bool reachable = (s <= j) ? (s < home && home <= j)
+                                  : (s < home || home <= j);
+        if (!reachable) {
+            index_[s] = index_[j];
+            index_[j] = 0;
+            s = j;
+        }
     }
+
+    if (wheel_)
+        wheel_->cancel(timers_[entry]);
+
+    if (entries_[entry].concurrency == CommandConcurrency::SERIAL)
+        serial_pending_--;
+    pending_count_--;
+    entry_used_[entry] = false;
 }
 
 // -------------------------------------------------
 bool CommandManager::requestCommand(
     VehicleCommand cmd,
-    SystemState state,
+    bool link_up,
     const TelemetryData& telemetry) {
 
-    if (active_command_ || !sender_)
+    if (!sender_ || !wheel_)
+        return false;
+
+    const CommandDefinition& def = commandDefinition(cmd);
+
+    const uint32_t key = keyOf(
+        sender_->targetSystem(), def.target_comp, def.mavlink_id);
+
+    // ---------- Concurrency policy ----------
+    if (findPending(key) >= 0)
         return false;
 
-    const CommandDefinition* def = findCommand(cmd);
-    if (!def)
+    if (def.concurrency == CommandConcurrency::SERIAL && serial_pending_ != 0)
         return false;
 
-    if (!def->allowed(telemetry)) {
-        cout << "[CMD BLOCKED] Rule denied\n";
+    if (pending_count_ >= COMMAND_PENDING_MAX) {
+        LOG_WARN("CMD", "Pending table full, {} refused", def.mavlink_id);
         return false;
     }
 
+    const CommandBlockReason reason =
+        checkRule(def.rule, commandStatus(telemetry, link_up));
+
+    if (reason != CommandBlockReason::NONE) {
+        // Retried every command tick; log only when the reason changes
+        if (reason != last_block_) {
+            LOG_INFO("CMD BLOCKED", "{}: {}",
+                     commandName(cmd), blockReasonName(reason));
+        }
+        last_block_ = reason;
+        return false;
+    }
+    last_block_ = CommandBlockReason::NONE;
+
     TrackedCommand tc;
     tc.logical_cmd = cmd;
-    tc.mavlink_cmd_id = def->mavlink_id;
+    tc.mavlink_cmd_id = def.mavlink_id;
+    tc.param1 = def.param1;
+    tc.target_comp = def.target_comp;
+    tc.concurrency = def.concurrency;
     tc.retry_count = 0;
-    tc.max_retries = 3;
-    tc.last_sent_time = chrono::steady_clock::now();
+    tc.max_retries = COMMAND_MAX_RETRIES;
+    tc.first_sent = GcsClock::now();
+
+    int entry = insertPending(key, tc);
+    wheel_->schedule(timers_[entry], COMMAND_ACK_TIMEOUT);
 
-    sender_->sendRawCommand(tc.mavlink_cmd_id);
-    cout << "[CMD] " << tc.mavlink_cmd_id << " SENT\n";
+    sender_->sendRawCommand(tc.mavlink_cmd_id, tc.target_comp, tc.param1);
+    Metrics::local().add(Counter::COMMANDS_SENT);
+    LOG_INFO("CMD", "{} SENT ({} pending)", tc.mavlink_cmd_id, pending_count_);
 
-    active_command_ = tc;
     return true;
 }
 
 
 // -------------------------------------------------
 void CommandManager::update(
-    const TelemetryData& telemetry,
+    CommandAckQueue& acks,
     SystemState& state) {
 
-    if (!active_command_)
-        return;
-
-    handleAck(telemetry, state);
-    handleRetry(telemetry);  
+    // Always drain, so a late ACK can never match a newer command
+    CommandAckData ack;
+    while (acks.pop(ack))
+        handleAck(ack, state);
 }
 
 
 // -------------------------------------------------
-void CommandManager::handleRetry(const TelemetryData& telemetry) {
-
-    if (!sender_ || !active_command_)
-        return;
-
-    auto& cmd = active_command_.value();
+void CommandManager::onAckTimeout(void* self, uint32_t entry) {
+    static_cast<CommandManager*>(self)->handleTimeout(static_cast<int>(entry));
+}
 
-    auto elapsed =
-        chrono::duration_cast<chrono::milliseconds>(
-            chrono::steady_clock::now() - cmd.last_sent_time).count();
+void CommandManager::handleTimeout(int entry) {
 
-    if (elapsed < COMMAND_ACK_TIMEOUT_MS)
-        return;
+    TrackedCommand& cmd = entries_[entry];
 
-    if (cmd.retry_count >= cmd.max_retries) {
-        cout << "[CMD] TIMEOUT — giving up\n";
-        active_command_.reset();
+    if (cmd.retry_count >= cmd.max_retries || !sender_) {
+        LOG_WARN("CMD", "{} TIMEOUT — giving up", cmd.mavlink_cmd_id);
+        recordTimeout(cmd);
+        Metrics::local().add(Counter::COMMAND_TIMEOUTS);
+        erasePending(entry);
         return;
     }
 
     cmd.retry_count++;
-    cmd.last_sent_time = chrono::steady_clock::now();
-    sender_->sendRawCommand(cmd.mavlink_cmd_id);
+    wheel_->schedule(timers_[entry], COMMAND_ACK_TIMEOUT);
+    sender_->sendRawCommand(cmd.mavlink_cmd_id, cmd.target_comp, cmd.param1);
+    Metrics::local().add(Counter::COMMAND_RETRIES);
 
-    cout << "[CMD] RETRY " << cmd.retry_count << endl;
+    LOG_INFO("CMD", "{} RETRY {}", cmd.mavlink_cmd_id, cmd.retry_count);
 }
+
 void CommandManager::handleAck(
-    const TelemetryData& telemetry,
+    const CommandAckData& ack,
     SystemState& state) {
 
-    if (!telemetry.last_command_ack.valid)
+    const int entry = findPending(
+        keyOf(ack.source_sysid, ack.source_compid, ack.command_id));
+
+    if (entry < 0) {
+        Metrics::local().add(Counter::ACKS_STRAY);
+        LOG_DEBUG("CMD", "Stray ACK CMD={} from {}/{}",
+                  ack.command_id, ack.source_sysid, ack.source_compid);
         return;
+    }
 
-    auto& cmd = active_command_.value();
+    TrackedCommand& cmd = entries_[entry];
+    Metrics::local().add(Counter::ACKS_MATCHED);
 
-    if (telemetry.last_command_ack.command_id != cmd.mavlink_cmd_id)
+    // Long-running command: still alive, restart its ACK timeout
+    if (ack.result == MAV_RESULT_IN_PROGRESS) {
+        wheel_->schedule(timers_[entry], COMMAND_ACK_TIMEOUT);
         return;
+    }
 
-    // consume ACK
-    const_cast<CommandAckData&>(telemetry.last_command_ack).valid = false;
-
-    if (telemetry.last_command_ack.result == MAV_RESULT_ACCEPTED) {
+    if (ack.result == MAV_RESULT_ACCEPTED) {
 
-        cout << "[CMD] ACK ACCEPTED" << endl;
+        LOG_INFO("CMD", "ACK ACCEPTED");
 
         switch (cmd.logical_cmd) {
         case VehicleCommand::ARM:
@@ -165,33 +225,32 @@ void CommandManager::handleAck(
         }
 
     } else {
-        cout << "[CMD] ACK REJECTED ("
-             << int(telemetry.last_command_ack.result)
-             << ")" << endl;
+        LOG_WARN("CMD", "ACK REJECTED ({})", ack.result);
     }
 
-    active_command_.reset();
+    recordAck(cmd, ack.result);
+    erasePending(entry);
 }
 
-// -------------------------------------------------
-uint16_t CommandManager::mapToMavlinkCommand(
-    VehicleCommand cmd) const {
-
-    switch (cmd) {
-    case VehicleCommand::ARM:
-    case VehicleCommand::DISARM:
-        return MAV_CMD_COMPONENT_ARM_DISARM;
-    case VehicleCommand::SET_MODE_AUTO:
-        return MAV_CMD_DO_SET_MODE;
-    case VehicleCommand::TAKEOFF:
-        return MAV_CMD_NAV_TAKEOFF;
-    case VehicleCommand::LAND:
-        return MAV_CMD_NAV_LAND;
-    default:
-        return 0;
-    }
+// ---------------- Latency / outcome stats ----------------
+// Single writer: a load + store per counter is enough
+static void bump(std::atomic<uint32_t>& counter) {
+    counter.store(counter.load(memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+void CommandManager::recordAck(const TrackedCommand& cmd, uint8_t result) {
+    CommandStats& s = stats_[static_cast<int>(cmd.logical_cmd)];
+
+    const auto elapsed = GcsClock::now() - cmd.first_sent;
+    s.latency.record(chrono::duration_cast<chrono::microseconds>(elapsed).count());
+
+    bump(s.by_result[result < CommandStats::RESULT_SLOTS - 1
+                         ? result : CommandStats::RESULT_SLOTS - 1]);
+    bump(s.by_retries[cmd.retry_count]);
 }
 
-bool CommandManager::hasActiveCommand() const {
-    return active_command_.has_value();
+void CommandManager::recordTimeout(const TrackedCommand& cmd) {
+    CommandStats& s = stats_[static_cast<int>(cmd.logical_cmd)];
+    bump(s.timed_out);
+    bump(s.by_retries[COMMAND_MAX_RETRIES + 1]);
 }
@@ -1,58 +1,138 @@
 #pragma once
 
+#include <atomic>
 #include <optional>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 
 using namespace std;
 
 #include "VehicleCommand.h"
+#include "CommandDefinition.h"
+#include "core/GcsClock.h"
+#include "core/LatencyHistogram.h"
 #include "core/SystemState.h"
+#include "core/TimerWheel.h"
 #include "telemetry/TelemetryData.h"
 
 class MavlinkCommandSender;
 
+// Commands in flight per vehicle, across all components
+static constexpr size_t COMMAND_PENDING_MAX = 8;
+static constexpr int COMMAND_MAX_RETRIES = 3;
+
+// How every finished command of one kind went. Written by the
+// control thread only; readable from anywhere without locking.
+struct CommandStats {
+    LatencyHistogram latency;     // first send -> final ACK, in us
+
+    // Final ACK result (MAV_RESULT_*, anything past CANCELLED in the last slot)
+    static constexpr size_t RESULT_SLOTS = MAV_RESULT_CANCELLED + 2;
+    std::atomic<uint32_t> by_result[RESULT_SLOTS] = {};
+
+    // Resends before the command finished (last slot: gave up)
+    std::atomic<uint32_t> by_retries[COMMAND_MAX_RETRIES + 2] = {};
+
+    std::atomic<uint32_t> timed_out{0};
+};
+
 class CommandManager {
 public:
-    bool isCommandAllowed(
-        VehicleCommand cmd,
-        SystemState state,
-        const TelemetryData& telemetry,
-        CommandBlockReason& out_reason) const;
+    CommandManager();
+
+    // Timers point back at this instance
+    CommandManager(const CommandManager&) = delete;
+    CommandManager& operator=(const CommandManager&) = delete;
 
+    // Refused when the rule denies it, the same key is already in
+    // flight, a SERIAL command is pending (for SERIAL commands), or
+    // the pending table is full. `link_up`: vehicle traffic is fresh.
     bool requestCommand(
         VehicleCommand cmd,
-        SystemState state,
+        bool link_up,
         const TelemetryData& telemetry);
 
+    // Drains the vehicle's ACK queue; retries are driven by the timer wheel
     void update(
-        const TelemetryData& telemetry,
+        CommandAckQueue& acks,
         SystemState& state);
 
-    bool hasActiveCommand() const;
+    // Latency and outcome counters for one command kind
+    const CommandStats& stats(VehicleCommand cmd) const {
+        return stats_[static_cast<int>(cmd)];
+    }
+
+    // Why the last refused request failed its rule (NONE after a send)
+    CommandBlockReason lastBlockReason() const { return last_block_; }
+
+    bool hasActiveCommand() const { return pending_count_ != 0; }
+    bool hasSerialCommand() const { return serial_pending_ != 0; }
+    size_t pendingCount() const { return pending_count_; }
 
     void setCommandSender(MavlinkCommandSender* sender) {
         sender_ = sender;
     }
 
+    // ACK timeouts; must be the wheel of the thread calling update()
+    void setTimerWheel(TimerWheel* wheel) {
+        wheel_ = wheel;
+    }
+
 private:
     struct TrackedCommand {
         VehicleCommand logical_cmd;
         uint16_t mavlink_cmd_id;
+        float param1;
+        uint8_t target_comp;
+        CommandConcurrency concurrency;
         int retry_count = 0;
-        int max_retries = 3;
-        chrono::steady_clock::time_point last_sent_time;
+        int max_retries = COMMAND_MAX_RETRIES;
+        GcsClock::time_point first_sent;
     };
 
-    uint16_t mapToMavlinkCommand(VehicleCommand cmd) const;
+    // (target sys, target comp, command id); sys is fixed per manager
+    // but kept so the key matches the ACK's source fields exactly
+    static uint32_t keyOf(uint8_t sys, uint8_t comp, uint16_t cmd) {
+        return (uint32_t(sys) << 24) | (uint32_t(comp) << 16) | cmd;
+    }
+
+    // ---------- Pending table ----------
+    // Entries are a fixed array; a small open-addressed index maps
+    // key -> entry so an ACK is matched without scanning.
+    static constexpr size_t INDEX_SIZE = COMMAND_PENDING_MAX * 2;
+    static_assert(INDEX_SIZE == 16, "homeSlot() yields 4 bits");
+
+    int findPending(uint32_t key) const;
+    int insertPending(uint32_t key, const TrackedCommand& tc);
+    void erasePending(int entry);
+    static size_t homeSlot(uint32_t key) {
+        return (key * 0x9E3779B1u) >> 28;   // top 4 bits -> [0, 16)
+    }
 
     void handleAck(
-        const TelemetryData& telemetry,
+        const CommandAckData& ack,
         SystemState& state);
 
-    void handleRetry(const TelemetryData& telemetry);
+    static void onAckTimeout(void* self, uint32_t entry);
+    void handleTimeout(int entry);
+
+    void recordAck(const TrackedCommand& cmd, uint8_t result);
+    void recordTimeout(const TrackedCommand& cmd);
+
+    TrackedCommand entries_[COMMAND_PENDING_MAX];
+    TimerNode timers_[COMMAND_PENDING_MAX];
+    uint32_t entry_keys_[COMMAND_PENDING_MAX] = {};
+    bool entry_used_[COMMAND_PENDING_MAX] = {};
+    uint8_t index_[INDEX_SIZE] = {};     // 0 = empty, else entry + 1
+
+    CommandStats stats_[VEHICLE_COMMAND_COUNT];
+
+    size_t pending_count_ = 0;
+    size_t serial_pending_ = 0;
 
-    optional<TrackedCommand> active_command_;
     MavlinkCommandSender* sender_ = nullptr;
-    CommandBlockReason last_logged_block_ = CommandBlockReason::NONE;
+    TimerWheel* wheel_ = nullptr;
+    CommandBlockReason last_block_ = CommandBlockReason::NONE;
 };
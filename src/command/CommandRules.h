@@ -1,32 +1,82 @@
 #pragma once
-#include "CommandDefinition.h"
-
-inline bool canArm(const TelemetryData& t) {
-    return t.heartbeat_received &&
-           t.ekf_ok &&
-           t.battery_ok &&
-           t.isLanded() &&
-           t.arm_state == ArmState::DISARMED &&
-           !t.in_failsafe;
-}
 
-inline bool canDisarm(const TelemetryData& t) {
-    return t.arm_state == ArmState::ARMED &&
-           t.isLanded();
-}
+#include <cstdint>
+
+#include "telemetry/TelemetryData.h"
+
+// -------------------------------------------------
+// A command's preconditions compiled into two masks
+// over VehicleStatus. A check is two ANDs and a
+// compare; the lowest failing bit names the reason.
+// -------------------------------------------------
+struct CommandRule {
+    uint32_t required;
+    uint32_t forbidden;
+
+    bool allows(uint32_t status) const {
+        return ((required & ~status) | (forbidden & status)) == 0;
+    }
+};
+
+// Why a bit fails a rule: indexed by bit position
+inline constexpr CommandBlockReason REASON_IF_MISSING[VehicleStatus::BITS] = {
+    CommandBlockReason::UNKNOWN,               // LINK_LOST
+    CommandBlockReason::UNKNOWN,               // FAILSAFE
+    CommandBlockReason::NO_HEARTBEAT,
+    CommandBlockReason::EKF_NOT_READY,
+    CommandBlockReason::BATTERY_LOW,
+    CommandBlockReason::VEHICLE_NOT_LANDED,
+    CommandBlockReason::VEHICLE_NOT_AIRBORNE,
+    CommandBlockReason::VEHICLE_NOT_ARMED,
+    CommandBlockReason::EKF_NOT_READY,         // EKF_RECEIVED
+    CommandBlockReason::BATTERY_LOW,           // BATTERY_RECEIVED
+    CommandBlockReason::UNKNOWN,               // EXT_STATE_RECEIVED
+};
+
+inline constexpr CommandBlockReason REASON_IF_PRESENT[VehicleStatus::BITS] = {
+    CommandBlockReason::FAILSAFE_ACTIVE,       // LINK_LOST
+    CommandBlockReason::FAILSAFE_ACTIVE,       // FAILSAFE
+    CommandBlockReason::UNKNOWN,
+    CommandBlockReason::UNKNOWN,
+    CommandBlockReason::UNKNOWN,
+    CommandBlockReason::UNKNOWN,
+    CommandBlockReason::UNKNOWN,
+    CommandBlockReason::VEHICLE_ARMED,
+    CommandBlockReason::UNKNOWN,
+    CommandBlockReason::UNKNOWN,
+    CommandBlockReason::UNKNOWN,
+};
+
+inline CommandBlockReason checkRule(const CommandRule& rule, uint32_t status) {
+    const uint32_t missing = rule.required & ~status;
+    const uint32_t failing = missing | (rule.forbidden & status);
+
+    if (failing == 0)
+        return CommandBlockReason::NONE;
 
-inline bool canSetAuto(const TelemetryData& t) {
-    return t.arm_state == ArmState::ARMED &&
-           !t.in_failsafe;
+    const int bit = __builtin_ctz(failing);
+    return ((missing >> bit) & 1u) ? REASON_IF_MISSING[bit]
+                                   : REASON_IF_PRESENT[bit];
 }
 
-inline bool canTakeoff(const TelemetryData& t) {
-    return t.arm_state == ArmState::ARMED &&
-           t.isLanded() &&
-           t.ekf_ok &&
-           !t.in_failsafe;
+// Status as the control side sees it: telemetry plus link loss,
+// judged on live traffic so a dropout blocks only while it lasts
+inline uint32_t commandStatus(const TelemetryData& telemetry, bool link_up) {
+    return telemetry.status | (link_up ? 0u : VehicleStatus::LINK_LOST);
 }
 
-inline bool canLand(const TelemetryData& t) {
-    return t.isAirborne();
+inline const char* blockReasonName(CommandBlockReason reason) {
+    switch (reason) {
+    case CommandBlockReason::NONE:                 return "none";
+    case CommandBlockReason::EKF_NOT_READY:        return "EKF not ready";
+    case CommandBlockReason::BATTERY_LOW:          return "battery low";
+    case CommandBlockReason::FAILSAFE_ACTIVE:      return "failsafe active";
+    case CommandBlockReason::VEHICLE_NOT_ARMED:    return "vehicle not armed";
+    case CommandBlockReason::VEHICLE_NOT_LANDED:   return "vehicle not landed";
+    case CommandBlockReason::NO_HEARTBEAT:         return "no heartbeat";
+    case CommandBlockReason::VEHICLE_ARMED:        return "vehicle armed";
+    case CommandBlockReason::VEHICLE_NOT_AIRBORNE: return "vehicle not airborne";
+    case CommandBlockReason::UNKNOWN:              break;
+    }
+    return "unknown";
 }
@@ -1,17 +1,60 @@
-#include "CommandDefinition.h"
-#include "CommandRules.h"
-
-static const CommandDefinition COMMAND_TABLE[] = {
-    { VehicleCommand::ARM,        MAV_CMD_COMPONENT_ARM_DISARM, canArm },
-    { VehicleCommand::DISARM,     MAV_CMD_COMPONENT_ARM_DISARM, canDisarm },
-    { VehicleCommand::SET_MODE_AUTO, MAV_CMD_DO_SET_MODE,       canSetAuto },
-    { VehicleCommand::TAKEOFF,    MAV_CMD_NAV_TAKEOFF,          canTakeoff },
-    { VehicleCommand::LAND,       MAV_CMD_NAV_LAND,             canLand }
+#include "CommandTable.h"
+
+using S = VehicleStatus;
+
+// Link loss blocks everything: nothing would reach the vehicle
+static constexpr uint32_t ALWAYS_FORBIDDEN = S::LINK_LOST;
+
+// In VehicleCommand order
+static constexpr CommandDefinition COMMAND_TABLE[VEHICLE_COMMAND_COUNT] = {
+    { VehicleCommand::ARM,           MAV_CMD_COMPONENT_ARM_DISARM, 1.0f,
+      { S::HEARTBEAT | S::EKF_OK | S::BATTERY_OK | S::LANDED,
+        ALWAYS_FORBIDDEN | S::FAILSAFE | S::ARMED } },
+
+    { VehicleCommand::DISARM,        MAV_CMD_COMPONENT_ARM_DISARM, 0.0f,
+      { S::ARMED | S::LANDED,
+        ALWAYS_FORBIDDEN } },
+
+    { VehicleCommand::SET_MODE_AUTO, MAV_CMD_DO_SET_MODE,          MAV_MODE_AUTO_ARMED,
+      { S::ARMED,
+        ALWAYS_FORBIDDEN | S::FAILSAFE } },
+
+    { VehicleCommand::TAKEOFF,       MAV_CMD_NAV_TAKEOFF,          0.0f,
+      { S::ARMED | S::LANDED | S::EKF_OK,
+        ALWAYS_FORBIDDEN | S::FAILSAFE } },
+
+    // Allowed in a vehicle failsafe and without fresh traffic:
+    // landing is usually the way out, and a send costs nothing
+    { VehicleCommand::LAND,          MAV_CMD_NAV_LAND,             0.0f,
+      { S::AIRBORNE,
+        0 },
+      CommandConcurrency::CONCURRENT },
+
+    // A read: fine in any flight state
+    { VehicleCommand::REQUEST_VERSION, MAV_CMD_REQUEST_MESSAGE,   MAVLINK_MSG_ID_AUTOPILOT_VERSION,
+      { S::HEARTBEAT,
+        ALWAYS_FORBIDDEN },
+      CommandConcurrency::CONCURRENT },
 };
 
-inline const CommandDefinition* findCommand(VehicleCommand cmd) {
-    for (const auto& c : COMMAND_TABLE)
-        if (c.logical == cmd)
-            return &c;
-    return nullptr;
+static constexpr bool inCommandOrder() {
+    for (int i = 0; i < VEHICLE_COMMAND_COUNT; i++) {
+        if (static_cast<int>(COMMAND_TABLE[i].logical) != i)
+            return false;
+    }
+    return true;
+}
+static_assert(inCommandOrder(), "COMMAND_TABLE must follow VehicleCommand order");
+
+const CommandDefinition& commandDefinition(VehicleCommand cmd) {
+    return COMMAND_TABLE[static_cast<int>(cmd)];
+}
+
+uint32_t allowedCommands(uint32_t status) {
+    uint32_t allowed = 0;
+    for (int i = 0; i < VEHICLE_COMMAND_COUNT; i++) {
+        if (COMMAND_TABLE[i].rule.allows(status))
+            allowed |= 1u << i;
+    }
+    return allowed;
 }
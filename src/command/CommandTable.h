@@ -0,0 +1,11 @@
+#pragma once
+#include <cstdint>
+
+#include "CommandDefinition.h"
+
+// O(1): the table is indexed by VehicleCommand
+const CommandDefinition& commandDefinition(VehicleCommand cmd);
+
+// Bit i set when VehicleCommand(i) passes its rule in this status.
+// Cheap enough to run for every vehicle on every telemetry update.
+uint32_t allowedCommands(uint32_t status);
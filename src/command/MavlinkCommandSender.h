@@ -7,11 +7,18 @@ extern "C" {
 #include "mavlink/common/mavlink.h"
 }
 
+class TxQueue;
+
 class MavlinkCommandSender {
 public:
     // ✔ PX4-correct constructor
     // target component is ALWAYS AUTOPILOT1 internally
-    MavlinkCommandSender(int socket_fd, uint8_t target_sys);
+    // Frames are queued on tx and go out on the next flush.
+    // vehicle_addr is the endpoint the vehicle's traffic came from.
+    MavlinkCommandSender(
+        TxQueue& tx,
+        uint8_t target_sys,
+        const sockaddr_in& vehicle_addr);
 
     // ---------- High-level helpers ----------
     void sendArm();
@@ -25,16 +32,22 @@ public:
         sendCommand(command);
     }
 
+    // Explicit target component (pending-table entries carry their own)
+    void sendRawCommand(uint16_t command, uint8_t target_comp, float param1 = 0);
+
+    uint8_t targetSystem() const { return target_sysid; }
+
 private:
     // ---------- Single source of truth ----------
     void sendCommand(
         uint16_t command,
         float p1 = 0, float p2 = 0, float p3 = 0,
         float p4 = 0, float p5 = 0, float p6 = 0,
-        float p7 = 0
+        float p7 = 0,
+        uint8_t target_comp = MAV_COMP_ID_AUTOPILOT1
     );
 
-    int sockfd;
+    TxQueue& txQueue;
     uint8_t target_sysid;          // PX4 SYSID
     sockaddr_in px4_addr;
 };
@@ -1,7 +1,24 @@
+#pragma once
+
 enum class VehicleCommand {
     ARM,
     DISARM,
     SET_MODE_AUTO,   
     TAKEOFF,
-    LAND
+    LAND,
+    REQUEST_VERSION     // AUTOPILOT_VERSION, for the parameter cache key
 };
+
+static constexpr int VEHICLE_COMMAND_COUNT = 6;
+
+inline const char* commandName(VehicleCommand cmd) {
+    switch (cmd) {
+    case VehicleCommand::ARM:           return "ARM";
+    case VehicleCommand::DISARM:        return "DISARM";
+    case VehicleCommand::SET_MODE_AUTO: return "SET_MODE_AUTO";
+    case VehicleCommand::TAKEOFF:       return "TAKEOFF";
+    case VehicleCommand::LAND:          return "LAND";
+    case VehicleCommand::REQUEST_VERSION: return "REQUEST_VERSION";
+    }
+    return "UNKNOWN";
+}
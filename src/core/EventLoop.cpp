@@ -0,0 +1,157 @@
+#include "core/EventLoop.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+static constexpr int MAX_EVENTS = 16;
+
+EventLoop::~EventLoop() {
+    for (auto& h : handlers) {
+        if (h->is_timer)
+            close(h->fd);
+    }
+    if (epfd >= 0)
+        close(epfd);
+}
+
+bool EventLoop::start() {
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        perror("epoll_create1");
+        return false;
+    }
+    return true;
+}
+
+bool EventLoop::watch(Handler* handler) {
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = handler;
+
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, handler->fd, &ev) < 0) {
+        perror("epoll_ctl");
+        return false;
+    }
+    return true;
+}
+
+bool EventLoop::addReader(int fd, Callback cb) {
+    auto handler = std::make_unique<Handler>(Handler{fd, false, std::move(cb)});
+    if (!watch(handler.get()))
+        return false;
+
+    handlers.push_back(std::move(handler));
+    return true;
+}
+
+bool EventLoop::modify(int fd, uint32_t events) {
+    for (auto& h : handlers) {
+        if (h->fd != fd || h->is_timer)
+            continue;
+
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.ptr = h.get();
+
+        if (epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+            perror("epoll_ctl");
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool EventLoop::disableReader(int fd) {
+    return modify(fd, 0);
+}
+
+bool EventLoop::enableReader(int fd) {
+    return modify(fd, EPOLLIN);
+}
+
+int EventLoop::addTimer(int interval_ms, Callback cb) {
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0) {
+        perror("timerfd_create");
+        return -1;
+    }
+
+    itimerspec spec{};
+    spec.it_interval.tv_sec = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (interval_ms % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+
+    if (timerfd_settime(tfd, 0, &spec, nullptr) < 0) {
+        perror("timerfd_settime");
+        close(tfd);
+        return -1;
+    }
+
+    auto handler = std::make_unique<Handler>(Handler{tfd, true, std::move(cb)});
+    if (!watch(handler.get())) {
+        close(tfd);
+        return -1;
+    }
+
+    handlers.push_back(std::move(handler));
+    return tfd;
+}
+
+bool EventLoop::armTimer(int tfd, std::chrono::steady_clock::time_point deadline) {
+    itimerspec spec{};
+
+    if (deadline != std::chrono::steady_clock::time_point::max()) {
+        // A zero it_value would disarm; anything already due fires at once
+        const int64_t ns = std::max<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline.time_since_epoch()).count(), 1);
+
+        spec.it_value.tv_sec = ns / 1000000000L;
+        spec.it_value.tv_nsec = ns % 1000000000L;
+    }
+
+    if (timerfd_settime(tfd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+        perror("timerfd_settime");
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::run() {
+    epoll_event events[MAX_EVENTS];
+    running = true;
+
+    while (running) {
+        int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait");
+            return;
+        }
+
+        for (int i = 0; i < n && running; i++) {
+            auto* h = static_cast<Handler*>(events[i].data.ptr);
+
+            if (h->is_timer) {
+                // Missed expirations collapse into one callback
+                uint64_t expirations;
+                if (read(h->fd, &expirations, sizeof(expirations)) < 0)
+                    continue;
+            }
+            h->cb();
+        }
+
+        if (post_dispatch)
+            post_dispatch();
+    }
+}
+
+void EventLoop::stop() {
+    running = false;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// -------------------------------------------------
+// Single-threaded reactor: epoll over socket fds
+// plus periodic timerfds, so deadlines fire on time
+// whether or not traffic arrives.
+// -------------------------------------------------
+class EventLoop {
+public:
+    using Callback = std::function<void()>;
+
+    EventLoop() = default;
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool start();
+
+    // Callback runs whenever fd becomes readable (level-triggered)
+    bool addReader(int fd, Callback cb);
+
+    // Stops watching a reader without removing it, so a consumer
+    // that can't drain the fd yet sleeps instead of spinning on it
+    bool disableReader(int fd);
+    bool enableReader(int fd);
+
+    // Periodic CLOCK_MONOTONIC timer; returns the timerfd or -1.
+    // An interval of 0 leaves it disarmed for armTimer().
+    int addTimer(int interval_ms, Callback cb);
+
+    // Fires the timer once at deadline (steady_clock is CLOCK_MONOTONIC);
+    // time_point::max() disarms it
+    bool armTimer(int tfd, std::chrono::steady_clock::time_point deadline);
+
+    // Runs once after every batch of ready events (e.g. TX flush)
+    void setPostDispatch(Callback cb) { post_dispatch = std::move(cb); }
+
+    // Blocks until stop() is called from a callback
+    void run();
+    void stop();
+
+private:
+    struct Handler {
+        int fd;
+        bool is_timer;
+        Callback cb;
+    };
+
+    bool watch(Handler* handler);
+    bool modify(int fd, uint32_t events);
+
+    int epfd = -1;
+    bool running = false;
+    std::vector<std::unique_ptr<Handler>> handlers;
+    Callback post_dispatch;
+};
@@ -0,0 +1,119 @@
+#include "core/Fleet.h"
+#include "comm/GcsIdentity.h"
+#include "comm/TxQueue.h"
+
+#include "core/Logger.h"
+
+#include <arpa/inet.h>
+
+static size_t nextPow2(size_t n) {
+    size_t p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+// Flight controllers only: other components, GCSs included,
+// announce themselves with MAV_AUTOPILOT_INVALID or MAV_TYPE_GCS
+static bool isAutopilotHeartbeat(const MavlinkFrameView& frame) {
+    if (frame.msgid != MAVLINK_MSG_ID_HEARTBEAT)
+        return false;
+
+    mavlink_heartbeat_t hb;
+    decodePayload(frame, hb);
+    return hb.autopilot != MAV_AUTOPILOT_INVALID && hb.type != MAV_TYPE_GCS;
+}
+
+Fleet::Fleet(TxQueue& tx, size_t capacity, const HistoryConfig& history)
+    : txQueue(tx),
+      historyConfig(history),
+      cap(capacity),
+      vehicles(new Vehicle[capacity]),
+      index(nextPow2(capacity * 2), 0),
+      index_mask(index.size() - 1) {}
+
+size_t Fleet::slotFor(uint64_t packed) const {
+    // splitmix64 finalizer: endpoints differ mostly in low bits
+    packed ^= packed >> 30;
+    packed *= 0xbf58476d1ce4e5b9ULL;
+    packed ^= packed >> 27;
+    packed *= 0x94d049bb133111ebULL;
+    packed ^= packed >> 31;
+    return static_cast<size_t>(packed) & index_mask;
+}
+
+Vehicle* Fleet::find(const VehicleKey& key) {
+    const uint64_t packed = key.packed();
+
+    for (size_t s = slotFor(packed);; s = (s + 1) & index_mask) {
+        uint32_t entry = index[s];
+        if (entry == 0)
+            return nullptr;
+
+        Vehicle& v = vehicles[entry - 1];
+        if (v.key.packed() == packed)
+            return &v;
+    }
+}
+
+Vehicle* Fleet::add(const VehicleKey& key, const sockaddr_in& endpoint) {
+    const size_t n = count.load(std::memory_order_relaxed);
+    if (n >= cap)
+        return nullptr;
+
+    Vehicle& v = vehicles[n];
+    v.key = key;
+    v.endpoint = endpoint;
+    v.sender.emplace(txQueue, key.sysid, endpoint);
+    v.commandManager.setCommandSender(&*v.sender);
+    v.mission.emplace(txQueue, key.sysid, endpoint);
+    v.params.emplace(txQueue, key.sysid, endpoint);
+    v.streams.emplace(txQueue, key.sysid, key.compid, endpoint, v.stream_rx);
+    v.history.configure(historyConfig);
+
+    size_t s = slotFor(key.packed());
+    while (index[s] != 0)
+        s = (s + 1) & index_mask;
+    index[s] = static_cast<uint32_t>(n + 1);
+
+    // Publish only after the vehicle is fully built
+    count.store(n + 1, std::memory_order_release);
+
+    char addr[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &endpoint.sin_addr, addr, sizeof(addr));
+    LOG_INFO("FLEET", "Vehicle {}/{} @ {}:{} registered ({}/{})",
+             key.sysid, key.compid, addr, ntohs(endpoint.sin_port), n + 1, cap);
+
+    return &v;
+}
+
+Vehicle* Fleet::route(
+    const sockaddr_in& src,
+    const MavlinkFrameView& frame,
+    bool* created) {
+
+    if (created)
+        *created = false;
+
+    if (isGcsSystemId(frame.sysid))
+        return nullptr;
+
+    VehicleKey key;
+    key.addr = src.sin_addr.s_addr;
+    key.port = src.sin_port;
+    key.sysid = frame.sysid;
+    key.compid = frame.compid;
+
+    if (Vehicle* v = find(key))
+        return v;
+
+    // Mission, parameter and stream control would each target the
+    // autopilot once per component otherwise
+    if (!isAutopilotHeartbeat(frame))
+        return nullptr;
+
+    Vehicle* v = add(key, src);
+    if (v && created)
+        *created = true;
+    return v;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <netinet/in.h>
+#include <optional>
+#include <vector>
+
+#include "command/CommandManager.h"
+#include "command/MavlinkCommandSender.h"
+#include "core/GcsClock.h"
+#include "core/SeqLock.h"
+#include "core/StateManager.h"
+#include "core/TimerWheel.h"
+#include "mission/MissionTransfer.h"
+#include "param/ParamTransfer.h"
+#include "stream/StreamRates.h"
+#include "telemetry/TelemetryData.h"
+#include "telemetry/TelemetryHistory.h"
+#include "telemetry/TelemetryParser.h"
+
+class TxQueue;
+
+static constexpr size_t FLEET_MAX_VEHICLES = 256;
+
+// (source endpoint, sysid, compid) packed into one word
+struct VehicleKey {
+    uint32_t addr = 0;      // network byte order
+    uint16_t port = 0;      // network byte order
+    uint8_t sysid = 0;
+    uint8_t compid = 0;
+
+    uint64_t packed() const {
+        return (uint64_t(addr) << 32) | (uint64_t(port) << 16) |
+               (uint64_t(sysid) << 8) | compid;
+    }
+};
+
+// Everything the GCS tracks for one autopilot
+struct Vehicle {
+    VehicleKey key;
+    sockaddr_in endpoint{};
+
+    // ---- Parse side: only the thread running the parser touches these ----
+    TelemetryData telemetry;
+    TelemetryHistory history;
+    TelemetryParser parser{{telemetry, stateManager, history, acks, missions, param_values, stream_acks}};
+    bool dirty = false;
+    uint8_t last_seq = 0;
+    bool seq_seen = false;
+
+    // ---- Hand-off: parse -> everyone else ----
+    // Published copy: the writer never blocks, readers never lock
+    SeqLock<TelemetryData> snapshot;
+    CommandAckQueue acks;
+    MissionEventQueue missions;
+    ParamEventQueue param_values;
+    StreamAckQueue stream_acks;
+    StateManager stateManager;      // atomic; written by control only
+
+    // Link counters: parse writes, the metrics scraper reads
+    std::atomic<uint64_t> frames_rx{0};
+    std::atomic<uint64_t> seq_lost{0};
+    StreamCounters stream_rx;
+
+    // ---- Control side ----
+    CommandManager commandManager;
+    std::optional<MavlinkCommandSender> sender;
+    std::optional<MissionTransfer> mission;
+    std::optional<ParamTransfer> params;
+    std::optional<StreamRates> streams;
+    bool version_requested = false;
+    GcsClock::time_point version_requested_at{};
+    size_t param_step = 0;          // ParamOptions::sets applied
+    int launch_step = 0;
+    TimerNode link_timer;           // link-loss deadline
+
+    void publish() {
+        snapshot.store(telemetry);
+        dirty = false;
+    }
+
+    // Parse side, once per frame. A gap in the 8-bit sequence counts
+    // as lost frames (a reordered frame looks like a long gap).
+    void countFrame(uint8_t seq) {
+        if (seq_seen) {
+            const uint8_t gap = static_cast<uint8_t>(seq - last_seq - 1);
+            if (gap)
+                seq_lost.store(seq_lost.load(std::memory_order_relaxed) + gap,
+                               std::memory_order_relaxed);
+        }
+        last_seq = seq;
+        seq_seen = true;
+        frames_rx.store(frames_rx.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+    }
+};
+
+// -------------------------------------------------
+// Fixed-capacity vehicle registry. Entries live in one
+// contiguous array and never move; an open-addressed
+// index gives O(1) lookup for every received frame.
+// -------------------------------------------------
+class Fleet {
+public:
+    explicit Fleet(
+        TxQueue& tx,
+        size_t capacity = FLEET_MAX_VEHICLES,
+        const HistoryConfig& history = HistoryConfig{});
+
+    // Resolves the vehicle a frame belongs to. A component becomes a
+    // vehicle on its first autopilot HEARTBEAT; until then, and for
+    // cameras, gimbals, companions or other GCSs, this returns nullptr
+    // (as for GCS echoes or a full fleet).
+    Vehicle* route(
+        const sockaddr_in& src,
+        const MavlinkFrameView& frame,
+        bool* created = nullptr);
+
+    Vehicle* find(const VehicleKey& key);
+
+    // Registration happens on the parse side; other threads may
+    // iterate concurrently and see every fully built vehicle.
+    size_t size() const { return count.load(std::memory_order_acquire); }
+    size_t capacity() const { return cap; }
+
+    Vehicle* begin() { return vehicles.get(); }
+    Vehicle* end() { return vehicles.get() + size(); }
+
+private:
+    Vehicle* add(const VehicleKey& key, const sockaddr_in& endpoint);
+    size_t slotFor(uint64_t packed) const;
+
+    TxQueue& txQueue;
+    HistoryConfig historyConfig;
+
+    size_t cap;
+    std::atomic<size_t> count{0};
+    std::unique_ptr<Vehicle[]> vehicles;
+
+    // 0 = empty, otherwise vehicle index + 1
+    std::vector<uint32_t> index;
+    size_t index_mask;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// -------------------------------------------------
+// Time source for every GCS deadline. Live runs read
+// steady_clock; replay switches to a virtual clock it
+// advances record by record, so retry and failsafe
+// timeouts behave the same at any replay speed.
+// -------------------------------------------------
+class GcsClock {
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+    using duration = std::chrono::steady_clock::duration;
+
+    static time_point now() {
+        return virtual_mode ? virtual_now : std::chrono::steady_clock::now();
+    }
+
+    // Replay only: call before any pipeline state is touched
+    static void useVirtualTime(time_point start) {
+        virtual_now = start;
+        virtual_mode = true;
+    }
+
+    static void advanceTo(time_point t) {
+        if (t > virtual_now)
+            virtual_now = t;
+    }
+
+    static bool isVirtual() { return virtual_mode; }
+
+    // Microsecond timestamps for compact storage (TelemetryHistory)
+    static int64_t micros(time_point t) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            t.time_since_epoch()).count();
+    }
+
+private:
+    static inline bool virtual_mode = false;
+    static inline time_point virtual_now{};
+};
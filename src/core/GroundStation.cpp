@@ -0,0 +1,565 @@
+#include "core/GroundStation.h"
+#include "comm/FramePool.h"
+#include "comm/MavlinkRouter.h"
+#include "core/Logger.h"
+#include "core/Metrics.h"
+#include "telemetry/TelemetryHandlers.h"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+// ---------------- Launch sequence ----------------
+// Runs once the mission and parameter transfers are out of the way
+static const VehicleCommand launch[] = {
+    VehicleCommand::ARM,
+    VehicleCommand::SET_MODE_AUTO,
+    VehicleCommand::TAKEOFF
+};
+
+static constexpr int LAUNCH_LEN =
+    sizeof(launch) / sizeof(launch[0]);
+
+static constexpr chrono::milliseconds HEARTBEAT_TIMEOUT{HEARTBEAT_TIMEOUT_MS};
+static constexpr chrono::milliseconds GCS_HEARTBEAT_PERIOD{GCS_HEARTBEAT_PERIOD_MS};
+static constexpr chrono::milliseconds COMMAND_TICK_PERIOD{COMMAND_TICK_PERIOD_MS};
+static constexpr chrono::milliseconds COMMAND_LATENCY_LOG_PERIOD{COMMAND_LATENCY_LOG_PERIOD_MS};
+static constexpr chrono::milliseconds PARAM_VERSION_WAIT{PARAM_VERSION_WAIT_MS};
+
+GroundStation::GroundStation(
+    TxQueue& tx,
+    const HistoryConfig& history,
+    const MissionPlan* mission,
+    const ParamOptions& params,
+    const StreamPlan& streams)
+    : fleet_(tx, FLEET_MAX_VEHICLES, history),
+      heartbeat(tx),
+      mission_plan(mission),
+      param_options(params),
+      param_cache(params.cache_dir),
+      stream_plan(streams),
+      wheel(GcsClock::now()) {
+
+    requestTelemetryStreams(stream_plan);
+    stream_plan.log();
+
+    heartbeat_timer.fn = onHeartbeatTimer;
+    heartbeat_timer.owner = this;
+    wheel.schedule(heartbeat_timer, GCS_HEARTBEAT_PERIOD);
+
+    command_timer.fn = onCommandTimer;
+    command_timer.owner = this;
+    wheel.schedule(command_timer, COMMAND_TICK_PERIOD);
+
+    latency_timer.fn = onLatencyTimer;
+    latency_timer.owner = this;
+    wheel.schedule(latency_timer, COMMAND_LATENCY_LOG_PERIOD);
+
+    metrics_collector = Metrics::instance().addCollector(
+        [this](std::string& out) { collectMetrics(out); });
+
+    LOG_INFO("GCS", "Heartbeat sender initialized");
+}
+
+GroundStation::~GroundStation() {
+    Metrics::instance().removeCollector(metrics_collector);
+}
+
+void GroundStation::ingest(FrameSlab& slab) {
+    ingest(slab.dgram.src, slab.dgram.data, slab.dgram.len, &slab);
+}
+
+void GroundStation::ingest(const sockaddr_in& src, const uint8_t* data, size_t len) {
+    ingest(src, data, len, nullptr);
+}
+
+void GroundStation::ingest(
+    const sockaddr_in& src,
+    const uint8_t* data,
+    size_t len,
+    FrameSlab* slab) {
+
+    MetricsShard& metrics = Metrics::local();
+    MavlinkRouter* router = slab ? router_ : nullptr;
+
+    if (router)
+        router->beginDatagram(src, *slab);
+
+    scanner.scan(data, len, [&](const MavlinkFrameView& frame) {
+        metrics.frame(frame.msgid);
+
+        if (router)
+            router->onFrame(frame);
+
+        Vehicle* v = fleet_.route(src, frame);
+        if (!v) {
+            metrics.add(Counter::FRAMES_UNROUTED);
+            return;
+        }
+
+        v->countFrame(frame.seq);
+        v->stream_rx.count(frame.msgid);
+        v->parser.handleFrame(frame);
+        v->dirty = true;
+
+        if (wakesControl(frame.msgid))
+            ack_seen = true;
+    });
+
+    if (router)
+        router->endDatagram();
+
+    publishScanMetrics();
+}
+
+// Replies the control side should act on before its next tick
+bool GroundStation::wakesControl(uint32_t msgid) {
+    switch (msgid) {
+    case MAVLINK_MSG_ID_COMMAND_ACK:
+    case MAVLINK_MSG_ID_MISSION_REQUEST:
+    case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+    case MAVLINK_MSG_ID_MISSION_COUNT:
+    case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+    case MAVLINK_MSG_ID_MISSION_ACK:
+    case MAVLINK_MSG_ID_PARAM_VALUE:
+    case MAVLINK_MSG_ID_AUTOPILOT_VERSION:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void GroundStation::publishScanMetrics() {
+    const MavlinkFrameScanner::Stats& s = scanner.stats();
+    MetricsShard& m = Metrics::local();
+
+    m.add(Counter::CRC_ERRORS, s.crc_errors - scan_published.crc_errors);
+    m.add(Counter::UNKNOWN_MSGID, s.unknown_msgid - scan_published.unknown_msgid);
+    m.add(Counter::TRUNCATED, s.truncated - scan_published.truncated);
+    m.add(Counter::FRAMES_MALFORMED, s.malformed - scan_published.malformed);
+    m.add(Counter::BYTES_SKIPPED, s.bytes_skipped - scan_published.bytes_skipped);
+
+    scan_published = s;
+}
+
+// ---------------- Control side ----------------
+void GroundStation::adoptNewVehicles() {
+
+    const size_t registered = fleet_.size();
+
+    for (; adopted < registered; adopted++) {
+        Vehicle& v = fleet_.begin()[adopted];
+
+        // Targets, timers and the wheel are only ever touched from here
+        heartbeat.addTarget(v.endpoint);
+        v.commandManager.setTimerWheel(&wheel);
+        v.mission->setTimerWheel(&wheel);
+        v.params->setTimerWheel(&wheel);
+        v.params->setCache(&param_cache);
+        v.streams->setTimerWheel(&wheel);
+        v.streams->setPlan(&stream_plan);
+
+        v.link_timer.fn = onLinkTimer;
+        v.link_timer.owner = this;
+        v.link_timer.tag = static_cast<uint32_t>(adopted);
+        wheel.schedule(v.link_timer, HEARTBEAT_TIMEOUT);
+    }
+}
+
+void GroundStation::tick(GcsClock::time_point now) {
+    adoptNewVehicles();
+    wheel.advance(now);
+    Metrics::local().set(Gauge::TIMERS_PENDING, static_cast<int64_t>(wheel.pending()));
+}
+
+void GroundStation::onHeartbeatTimer(void* self, uint32_t) {
+    auto* gs = static_cast<GroundStation*>(self);
+    gs->wheel.schedule(gs->heartbeat_timer, GCS_HEARTBEAT_PERIOD);
+    gs->sendHeartbeat();
+}
+
+void GroundStation::onCommandTimer(void* self, uint32_t) {
+    auto* gs = static_cast<GroundStation*>(self);
+    gs->wheel.schedule(gs->command_timer, COMMAND_TICK_PERIOD);
+    gs->runCommands();
+}
+
+void GroundStation::onLatencyTimer(void* self, uint32_t) {
+    auto* gs = static_cast<GroundStation*>(self);
+    gs->wheel.schedule(gs->latency_timer, COMMAND_LATENCY_LOG_PERIOD);
+    gs->logCommandLatency();
+}
+
+void GroundStation::onLinkTimer(void* self, uint32_t vehicle) {
+    auto* gs = static_cast<GroundStation*>(self);
+    gs->checkLink(gs->fleet_.begin()[vehicle]);
+}
+
+// ---------- FAILSAFE CHECK ----------
+// The timer is re-armed lazily: traffic never touches it, and
+// when it fires it either trips or moves to the real deadline.
+void GroundStation::checkLink(Vehicle& v) {
+
+    const TelemetryData telemetry = v.snapshot.load();
+
+    if (!telemetry.heartbeat_received) {
+        wheel.schedule(v.link_timer, HEARTBEAT_TIMEOUT);
+        return;
+    }
+
+    // Every frame refreshes last_mavlink_rx_time, heartbeats included
+    const auto deadline = telemetry.last_mavlink_rx_time + HEARTBEAT_TIMEOUT;
+    const auto now = wheel.now();
+
+    if (now > deadline) {
+        if (v.stateManager.getState() != SystemState::FAILSAFE) {
+            v.stateManager.setState(SystemState::FAILSAFE);
+            LOG_WARN("FAILSAFE", "SysID {} MAVLink timeout", v.key.sysid);
+        }
+        wheel.schedule(v.link_timer, HEARTBEAT_TIMEOUT);
+        return;
+    }
+
+    wheel.schedule(v.link_timer, deadline - now + chrono::milliseconds(1));
+}
+
+// Traffic within the heartbeat timeout, whatever the failsafe timer last saw
+bool GroundStation::linkUp(const TelemetryData& telemetry) const {
+    return telemetry.heartbeat_received &&
+           wheel.now() - telemetry.last_mavlink_rx_time <= HEARTBEAT_TIMEOUT;
+}
+
+// ---------------- Command lifecycle + mission ----------------
+void GroundStation::runCommands(Vehicle& v) {
+
+    const TelemetryData telemetry = v.snapshot.load();
+
+    const bool link_up = linkUp(telemetry);
+
+    // Connected on the first heartbeat, and again once traffic
+    // resumes after a link-loss failsafe
+    const SystemState current = v.stateManager.getState();
+    if (telemetry.heartbeat_received && current == SystemState::DISCONNECTED) {
+        v.stateManager.setState(SystemState::CONNECTED);
+    } else if (link_up && current == SystemState::FAILSAFE) {
+        v.stateManager.setState(telemetry.arm_state == ArmState::ARMED
+                                    ? SystemState::ARMED : SystemState::CONNECTED);
+        LOG_INFO("FAILSAFE", "SysID {} MAVLink back", v.key.sysid);
+    }
+
+    SystemState state = v.stateManager.getState();
+    v.commandManager.update(v.acks, state);
+    v.stateManager.setState(state);
+
+    // ---------- Stream rates ----------
+    // Set on connect and again whenever traffic resumes after a loss
+    v.streams->update(v.stream_acks, link_up);
+
+    // ---------- Mission transfer ----------
+    // Upload the plan when there is one, otherwise read back
+    // whatever the vehicle already holds; once per vehicle
+    MissionTransfer& mission = *v.mission;
+    mission.update(v.missions);
+
+    if (telemetry.heartbeat_received &&
+        mission.state() == MissionTransfer::State::IDLE) {
+        if (mission_plan)
+            mission.startUpload(*mission_plan);
+        else
+            mission.startDownload();
+    }
+
+    runParams(v, telemetry);
+
+    // ---------- Launch ----------
+    // A plan that did not upload, or settings that did not
+    // apply, keep the vehicle on the ground
+    if (mission.busy() ||
+        (mission_plan && mission.state() != MissionTransfer::State::DONE))
+        return;
+
+    if (!paramsSettled(v))
+        return;
+
+    if (!telemetry.isTelemetryReady() ||
+        v.commandManager.hasSerialCommand() ||
+        v.launch_step >= LAUNCH_LEN)
+        return;
+
+    if (v.commandManager.requestCommand(
+            launch[v.launch_step],
+            linkUp(telemetry),
+            telemetry)) {
+
+        LOG_INFO("LAUNCH", "SysID {} step {} issued",
+                 v.key.sysid, v.launch_step);
+
+        v.launch_step++;
+    }
+}
+
+void GroundStation::runCommands() {
+    adoptNewVehicles();
+
+    size_t transfers = 0;
+    size_t unsettled = 0;
+    for (Vehicle& v : fleet_) {
+        runCommands(v);
+        transfers += v.mission->busy();
+        unsettled += !paramsSettled(v);
+    }
+
+    if (missions_busy && transfers == 0)
+        logMissionThroughput();
+    missions_busy = transfers;
+
+    if (params_busy && unsettled == 0)
+        logParamReady();
+    params_busy = unsettled;
+}
+
+// ---------------- Parameters ----------------
+// AUTOPILOT_VERSION first: the firmware keys the cache. A vehicle
+// that never sends one is read anyway once PARAM_VERSION_WAIT passes.
+void GroundStation::runParams(Vehicle& v, const TelemetryData& telemetry) {
+
+    ParamTransfer& params = *v.params;
+    params.update(v.param_values);
+
+    if (!telemetry.heartbeat_received)
+        return;
+
+    if (params.state() == ParamTransfer::State::IDLE) {
+        if (!v.version_requested) {
+            v.version_requested = v.commandManager.requestCommand(
+                VehicleCommand::REQUEST_VERSION, linkUp(telemetry), telemetry);
+            v.version_requested_at = wheel.now();
+            return;
+        }
+
+        if (!telemetry.autopilot_version_received &&
+            wheel.now() - v.version_requested_at < PARAM_VERSION_WAIT)
+            return;
+
+        const mavlink_autopilot_version_t& version = telemetry.autopilot_version;
+        params.start(version.uid, version.flight_sw_version);
+    }
+
+    if (params.state() != ParamTransfer::State::READY)
+        return;
+
+    while (v.param_step < param_options.sets.size()) {
+        const ParamAssignment& a = param_options.sets[v.param_step];
+
+        if (!params.find(a.id)) {
+            LOG_WARN("PARAM", "SysID {} has no {}, not set", v.key.sysid, a.id);
+            v.param_step++;
+            continue;
+        }
+
+        if (!params.set(a.id, a.value))
+            break;      // window full, or the same id still in flight
+
+        v.param_step++;
+    }
+}
+
+// Downloaded (or given up on) with every configured set confirmed;
+// a failed download only holds the vehicle when there is something to set
+bool GroundStation::paramsSettled(const Vehicle& v) const {
+    const ParamTransfer& params = *v.params;
+
+    switch (params.state()) {
+    case ParamTransfer::State::READY:
+        return v.param_step >= param_options.sets.size() && !params.setsPending();
+    case ParamTransfer::State::FAILED:
+        return param_options.sets.empty();
+    default:
+        return false;
+    }
+}
+
+void GroundStation::logParamReady() {
+
+    size_t ready = 0, cached = 0, failed = 0;
+    int64_t slowest = 0;
+
+    for (Vehicle& v : fleet_) {
+        const ParamTransfer& p = *v.params;
+        if (p.state() == ParamTransfer::State::FAILED)
+            failed++;
+        if (p.state() != ParamTransfer::State::READY)
+            continue;
+
+        ready++;
+        cached += p.stats().from_cache;
+        if (p.readyMillis() > slowest)
+            slowest = p.readyMillis();
+    }
+
+    LOG_INFO("PARAM", "Fleet: {} vehicles ready ({} from cache), {} failed, slowest {} ms after connect",
+             ready, cached, failed, slowest);
+}
+
+// Fleet-wide rate over every finished transfer: items moved
+// between the first start and the last finish
+void GroundStation::logMissionThroughput() {
+
+    size_t done = 0, failed = 0;
+    uint64_t items = 0, resends = 0;
+    GcsClock::time_point first{}, last{};
+
+    for (Vehicle& v : fleet_) {
+        const MissionTransfer& m = *v.mission;
+        if (m.state() == MissionTransfer::State::FAILED)
+            failed++;
+        if (m.state() != MissionTransfer::State::DONE)
+            continue;
+
+        const MissionTransfer::Stats& s = m.stats();
+        if (done == 0 || s.started < first)
+            first = s.started;
+        if (done == 0 || s.finished > last)
+            last = s.finished;
+        items += s.items;
+        resends += s.resends;
+        done++;
+    }
+
+    const double seconds = chrono::duration<double>(last - first).count();
+
+    LOG_INFO("MISSION", "Fleet: {} vehicles done, {} failed, {} items in {} ms, {} items/s, {} resends",
+             done, failed, items,
+             static_cast<uint64_t>(seconds * 1000),
+             static_cast<uint64_t>(seconds > 0 ? items / seconds : 0), resends);
+}
+
+void GroundStation::sendHeartbeat() {
+    adoptNewVehicles();
+    heartbeat.send();
+}
+
+void GroundStation::publishSnapshots() {
+    for (Vehicle& v : fleet_) {
+        if (v.dirty)
+            v.publish();
+    }
+}
+
+// ---------------- Command latency ----------------
+void GroundStation::logCommandLatency() {
+
+    for (int k = 0; k < VEHICLE_COMMAND_COUNT; k++) {
+        const auto cmd = static_cast<VehicleCommand>(k);
+
+        LatencyHistogram::Snapshot fleet_latency;
+        uint32_t accepted = 0, rejected = 0, timed_out = 0, retried = 0;
+
+        for (Vehicle& v : fleet_) {
+            const CommandStats& s = v.commandManager.stats(cmd);
+            if (s.latency.count() == 0 && s.timed_out.load(memory_order_relaxed) == 0)
+                continue;
+
+            const LatencyHistogram::Snapshot snap = s.latency.snapshot();
+            fleet_latency.merge(snap);
+
+            LOG_DEBUG("CMD LATENCY", "SysID {} {}: n={} p50={}us p99={}us max={}us",
+                      v.key.sysid, commandName(cmd), snap.count,
+                      snap.percentile(0.50), snap.percentile(0.99), snap.max_us);
+
+            for (size_t r = 0; r < CommandStats::RESULT_SLOTS; r++) {
+                const uint32_t n = s.by_result[r].load(memory_order_relaxed);
+                if (r == MAV_RESULT_ACCEPTED)
+                    accepted += n;
+                else
+                    rejected += n;
+            }
+            for (int r = 1; r <= COMMAND_MAX_RETRIES; r++)
+                retried += s.by_retries[r].load(memory_order_relaxed);
+            timed_out += s.timed_out.load(memory_order_relaxed);
+        }
+
+        if (fleet_latency.count == 0 && timed_out == 0)
+            continue;
+
+        LOG_INFO("CMD LATENCY", "{}: n={} p50={}us p99={}us p99.9={}us max={}us",
+                 commandName(cmd), fleet_latency.count,
+                 fleet_latency.percentile(0.50), fleet_latency.percentile(0.99),
+                 fleet_latency.percentile(0.999), fleet_latency.max_us);
+        LOG_INFO("CMD LATENCY", "{}: {} accepted, {} rejected, {} retried, {} timed out",
+                 commandName(cmd), accepted, rejected, retried, timed_out);
+    }
+}
+
+// ---------------- Metrics ----------------
+void GroundStation::collectMetrics(std::string& out) {
+
+    // Fleet iteration is safe from any thread; every field read is atomic
+    Metrics::family(out, "gcs_vehicles", "gauge", "Registered vehicles");
+    Metrics::sample(out, "gcs_vehicles", nullptr, double(fleet_.size()));
+
+    auto perVehicle = [&](const char* name, const char* type, const char* help,
+                          auto value) {
+        Metrics::family(out, name, type, help);
+
+        for (Vehicle& v : fleet_) {
+            char labels[48];
+            snprintf(labels, sizeof(labels), "sysid=\"%u\",compid=\"%u\"",
+                     unsigned(v.key.sysid), unsigned(v.key.compid));
+            Metrics::sample(out, name, labels, double(value(v)));
+        }
+    };
+
+    perVehicle("gcs_vehicle_frames_total", "counter", "Frames routed to the vehicle",
+        [](Vehicle& v) { return v.frames_rx.load(memory_order_relaxed); });
+
+    perVehicle("gcs_vehicle_seq_lost_total", "counter",
+        "Frames missing from the MAVLink sequence",
+        [](Vehicle& v) { return v.seq_lost.load(memory_order_relaxed); });
+
+    perVehicle("gcs_vehicle_state", "gauge", "SystemState (0 disconnected .. 4 failsafe)",
+        [](Vehicle& v) { return static_cast<int>(v.stateManager.getState()); });
+
+    perVehicle("gcs_vehicle_params_ready_seconds", "gauge",
+        "Registration to a complete parameter set (-1 until then)",
+        [](Vehicle& v) {
+            const int64_t ms = v.params->readyMillis();
+            return ms < 0 ? -1.0 : ms / 1000.0;
+        });
+
+    perVehicle("gcs_vehicle_command_timeouts_total", "counter",
+        "Commands given up after the last retry",
+        [](Vehicle& v) {
+            uint64_t n = 0;
+            for (int k = 0; k < VEHICLE_COMMAND_COUNT; k++)
+                n += v.commandManager.stats(static_cast<VehicleCommand>(k))
+                         .timed_out.load(memory_order_relaxed);
+            return n;
+        });
+
+    // Managed streams, and any the vehicle sends unmanaged
+    auto perStream = [&](const char* name, const char* help, auto value) {
+        Metrics::family(out, name, "gauge", help);
+
+        for (Vehicle& v : fleet_) {
+            const StreamRates& streams = *v.streams;
+
+            for (uint32_t id = 0; id < STREAM_MSGID_SLOTS; id++) {
+                if (streams.targetHz(id) < 0 && streams.measuredHz(id) < 0)
+                    continue;
+
+                char labels[64];
+                snprintf(labels, sizeof(labels), "sysid=\"%u\",compid=\"%u\",msgid=\"%u\"",
+                         unsigned(v.key.sysid), unsigned(v.key.compid), unsigned(id));
+                Metrics::sample(out, name, labels, double(value(streams, id)));
+            }
+        }
+    };
+
+    perStream("gcs_stream_rate_hz", "Measured over the last check window (-1 before the first)",
+        [](const StreamRates& s, uint32_t id) { return s.measuredHz(id); });
+
+    perStream("gcs_stream_target_hz", "Rate asked of the vehicle (0 off, -1 left alone)",
+        [](const StreamRates& s, uint32_t id) { return s.targetHz(id); });
+}
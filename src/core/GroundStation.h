@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <netinet/in.h>
+#include <string>
+
+#include "comm/GcsHeartbeat.h"
+#include "core/Fleet.h"
+#include "core/GcsClock.h"
+#include "core/TimerWheel.h"
+#include "param/ParamCache.h"
+#include "param/ParamTransfer.h"
+#include "stream/StreamPlan.h"
+#include "telemetry/MavlinkFrameScanner.h"
+
+class MavlinkRouter;
+class MissionPlan;
+class TxQueue;
+struct FrameSlab;
+
+constexpr int HEARTBEAT_TIMEOUT_MS = 2000;
+
+constexpr int GCS_HEARTBEAT_PERIOD_MS = 1000;
+constexpr int COMMAND_TICK_PERIOD_MS = 100;
+constexpr int COMMAND_LATENCY_LOG_PERIOD_MS = 30000;
+
+// How long the parameter download waits on AUTOPILOT_VERSION; past
+// that it goes ahead and caches under firmware 0
+constexpr int PARAM_VERSION_WAIT_MS = 2000;
+
+// -------------------------------------------------
+// The GCS pipeline without any I/O:
+// scan -> route -> parse on ingest, plus the timed
+// command, mission, parameter, failsafe and heartbeat steps. Every deadline
+// lives in one TimerWheel that tick() advances from a
+// single clock read. my_gcs drives it from the event
+// loop, gcs_replay from a log file.
+//
+// Two sides: ingest/publishSnapshots (parse) and
+// tick/runCommands (control). Control reads only
+// published snapshots and the ACK queue, so each side
+// may run on its own thread.
+// -------------------------------------------------
+class GroundStation {
+public:
+    // Every vehicle gets `mission` uploaded on connect, or
+    // has its onboard mission downloaded when there is none.
+    // Parameters are read (or taken from the cache) on connect
+    // and `params.sets` applied before launch. Stream rates follow
+    // `streams` plus what the built-in handlers ask for.
+    explicit GroundStation(
+        TxQueue& tx,
+        const HistoryConfig& history = HistoryConfig{},
+        const MissionPlan* mission = nullptr,
+        const ParamOptions& params = ParamOptions{},
+        const StreamPlan& streams = StreamPlan{});
+    ~GroundStation();
+
+    GroundStation(const GroundStation&) = delete;
+    GroundStation& operator=(const GroundStation&) = delete;
+
+    // A received datagram; the router retains the slab for its fan-out
+    void ingest(FrameSlab& slab);
+
+    // Bytes with no slab behind them (replay); nothing is routed
+    void ingest(const sockaddr_in& src, const uint8_t* data, size_t len);
+
+    // Parse side: every frame scanned from a slab is also offered to the router
+    void setRouter(MavlinkRouter* router) { router_ = router; }
+
+    // Control side: fires every timer due up to now (heartbeat,
+    // command tick, ACK timeouts, per-vehicle link loss)
+    void tick(GcsClock::time_point now);
+
+    // Control side: when tick() next has a timer to fire
+    GcsClock::time_point nextDeadline() const { return wheel.nextDeadline(); }
+
+    // ACKs, mission and parameter transfers and launch steps for every vehicle
+    void runCommands();
+
+    void sendHeartbeat();
+
+    // Fleet-wide COMMAND_LONG -> COMMAND_ACK percentiles per command
+    // (per vehicle at DEBUG). Also runs every COMMAND_LATENCY_LOG_PERIOD_MS.
+    void logCommandLatency();
+
+    // Publishes a snapshot of every vehicle changed since the last call.
+    // Run once per loop iteration, after a batch rather than per frame.
+    void publishSnapshots();
+
+    // Parse side: true once per ingest run that carried a COMMAND_ACK,
+    // a mission protocol reply or a parameter
+    bool takeAckSeen() {
+        bool seen = ack_seen;
+        ack_seen = false;
+        return seen;
+    }
+
+    Fleet& fleet() { return fleet_; }
+    const MavlinkFrameScanner::Stats& scanStats() const { return scanner.stats(); }
+
+    const TimerWheel& timers() const { return wheel; }
+
+private:
+    void ingest(const sockaddr_in& src, const uint8_t* data, size_t len, FrameSlab* slab);
+
+    void runCommands(Vehicle& v);
+    bool linkUp(const TelemetryData& telemetry) const;
+
+    // Picks up vehicles registered by the parse side
+    void adoptNewVehicles();
+
+    static void onHeartbeatTimer(void* self, uint32_t);
+    static void onCommandTimer(void* self, uint32_t);
+    static void onLatencyTimer(void* self, uint32_t);
+    static void onLinkTimer(void* self, uint32_t vehicle);
+    void checkLink(Vehicle& v);
+
+    static bool wakesControl(uint32_t msgid);
+
+    // Version request, parameter download and configured sets
+    void runParams(Vehicle& v, const TelemetryData& telemetry);
+    bool paramsSettled(const Vehicle& v) const;
+
+    // Items/s over every finished transfer, once the last one ends
+    void logMissionThroughput();
+
+    // Connect-to-ready over the fleet, once the last vehicle settles
+    void logParamReady();
+
+    // Parse side: scanner stats folded into the metrics shard
+    void publishScanMetrics();
+
+    // Per-vehicle families; runs on the metrics scraper
+    void collectMetrics(std::string& out);
+
+    Fleet fleet_;
+    GcsHeartbeat heartbeat;
+    const MissionPlan* mission_plan;
+    ParamOptions param_options;
+    ParamCache param_cache;
+    StreamPlan stream_plan;
+    MavlinkFrameScanner scanner;
+    MavlinkFrameScanner::Stats scan_published;
+    MavlinkRouter* router_ = nullptr;
+
+    bool ack_seen = false;          // parse side
+    int metrics_collector = 0;
+
+    // ---- Control side ----
+    TimerWheel wheel;
+    TimerNode heartbeat_timer;
+    TimerNode command_timer;
+    TimerNode latency_timer;
+    size_t adopted = 0;
+    size_t missions_busy = 0;
+    size_t params_busy = 0;
+};
@@ -0,0 +1,81 @@
+#include "core/LatencyHistogram.h"
+
+#include <cmath>
+
+size_t LatencyHistogram::bucketOf(int64_t value_us) {
+    if (value_us < 0)
+        value_us = 0;
+
+    uint64_t v = static_cast<uint64_t>(value_us);
+    if (v >= (uint64_t(1) << MAX_BITS))
+        v = (uint64_t(1) << MAX_BITS) - 1;
+
+    if (v < SUB_BUCKETS)
+        return static_cast<size_t>(v);
+
+    // The top SUB_BITS + 1 bits pick the bucket; the rest is rounding
+    const int msb = 63 - __builtin_clzll(v);
+    const int shift = msb - SUB_BITS;
+    const size_t sub = static_cast<size_t>(v >> shift) - SUB_BUCKETS;
+
+    return (static_cast<size_t>(shift) + 1) * SUB_BUCKETS + sub;
+}
+
+int64_t LatencyHistogram::bucketHigh(size_t bucket) {
+    if (bucket < SUB_BUCKETS)
+        return static_cast<int64_t>(bucket);
+
+    const int shift = static_cast<int>(bucket / SUB_BUCKETS) - 1;
+    const uint64_t low = (SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+    return static_cast<int64_t>(low + (uint64_t(1) << shift) - 1);
+}
+
+// The only writer: plain load + store instead of a locked RMW
+void LatencyHistogram::record(int64_t value_us) {
+    std::atomic<uint32_t>& c = counts_[bucketOf(value_us)];
+    c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (value_us > max_.load(std::memory_order_relaxed))
+        max_.store(value_us, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot s;
+    for (size_t i = 0; i < BUCKETS; i++) {
+        s.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        s.count += s.counts[i];
+    }
+    s.max_us = max_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    for (size_t i = 0; i < BUCKETS; i++)
+        counts[i] += other.counts[i];
+    count += other.count;
+    if (other.max_us > max_us)
+        max_us = other.max_us;
+}
+
+int64_t LatencyHistogram::Snapshot::percentile(double q) const {
+    if (count == 0)
+        return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * double(count)));
+    if (rank < 1)
+        rank = 1;
+    if (rank > count)
+        rank = count;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            const int64_t high = bucketHigh(i);
+            return high < max_us ? high : max_us;
+        }
+    }
+    return max_us;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// -------------------------------------------------
+// HDR-style log-linear histogram of microsecond
+// latencies. Every power of two is split into
+// 2^SUB_BITS linear buckets, so any recorded value
+// is reported within ~3% up to ~71 minutes.
+//
+// One thread records; any thread may snapshot().
+// Counters are relaxed atomics, so a snapshot taken
+// during record() may miss that one sample.
+// -------------------------------------------------
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr int MAX_BITS = 32;                       // values < 2^32 us
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BITS;
+    static constexpr size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS;
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> counts{};
+        uint64_t count = 0;
+        int64_t max_us = 0;
+
+        void merge(const Snapshot& other);
+
+        // Smallest recorded-bucket bound covering q of the samples
+        // (q in [0, 1]); 0 when empty
+        int64_t percentile(double q) const;
+    };
+
+    // Single writer
+    void record(int64_t value_us);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    Snapshot snapshot() const;
+
+    static size_t bucketOf(int64_t value_us);
+    static int64_t bucketHigh(size_t bucket);   // largest value in bucket
+
+private:
+    std::array<std::atomic<uint32_t>, BUCKETS> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<int64_t> max_{0};
+};
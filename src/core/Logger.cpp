@@ -0,0 +1,181 @@
+#include "core/Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+static constexpr auto LOG_IDLE_SLEEP = std::chrono::milliseconds(2);
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() {
+    worker = std::thread([this]() { run(); });
+}
+
+Logger::~Logger() {
+    running.store(false, std::memory_order_release);
+    if (worker.joinable())
+        worker.join();
+    flush();
+}
+
+Logger::ThreadRing* Logger::localRing() {
+    static thread_local ThreadRing* tls_ring = nullptr;
+
+    if (tls_ring)
+        return tls_ring;
+
+    std::lock_guard<std::mutex> lock(register_mutex);
+
+    const size_t n = ring_count.load(std::memory_order_relaxed);
+    if (n >= LOG_MAX_THREADS)
+        return nullptr;
+
+    // Rings outlive their threads; the worker keeps draining them
+    rings[n] = new ThreadRing();
+    ring_count.store(n + 1, std::memory_order_release);
+
+    tls_ring = rings[n];
+    return tls_ring;
+}
+
+// Copies at most max_len bytes of s (less if the record is full)
+void Logger::captureText(LogRecord& rec, LogArg& arg, const char* s, size_t max_len) {
+    const size_t room = LOG_TEXT_BYTES - rec.text_used;
+    const size_t n = strnlen(s, std::min(room ? room - 1 : 0, max_len));
+
+    arg.type = LogArg::Type::TEXT;
+    arg.text_offset = rec.text_used;
+    if (room) {
+        std::memcpy(rec.text + rec.text_used, s, n);
+        rec.text[rec.text_used + n] = '\0';
+        rec.text_used = static_cast<uint8_t>(rec.text_used + n + 1);
+    } else {
+        arg.text_offset = LOG_TEXT_BYTES - 1;   // points at the final NUL
+    }
+}
+
+void Logger::push(const LogRecord& rec) {
+    ThreadRing* r = localRing();
+    if (!r) {
+        rings[0]->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (!r->ring.push(rec))
+        r->dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t Logger::droppedRecords() const {
+    uint64_t total = 0;
+    const size_t n = ring_count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; i++)
+        total += rings[i]->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+void Logger::run() {
+    while (running.load(std::memory_order_acquire)) {
+        if (drain() == 0)
+            std::this_thread::sleep_for(LOG_IDLE_SLEEP);
+    }
+}
+
+void Logger::flush() {
+    drain();
+}
+
+size_t Logger::drain() {
+    std::lock_guard<std::mutex> lock(drain_mutex);
+
+    size_t drained = 0;
+    const size_t n = ring_count.load(std::memory_order_acquire);
+
+    LogRecord rec;
+    for (size_t i = 0; i < n; i++) {
+        while (rings[i]->ring.pop(rec)) {
+            emit(rec);
+            drained++;
+        }
+    }
+
+    const uint64_t dropped = droppedRecords();
+    if (dropped != reported_drops) {
+        out_len += std::snprintf(out_buf + out_len, sizeof(out_buf) - out_len,
+                                 "[LOG] %" PRIu64 " records dropped (ring full)\n",
+                                 dropped - reported_drops);
+        reported_drops = dropped;
+    }
+
+    writeOut();
+    return drained;
+}
+
+void Logger::emit(const LogRecord& rec) {
+    // One record formats to well under 1 KiB
+    if (sizeof(out_buf) - out_len < 1024)
+        writeOut();
+
+    char* p = out_buf + out_len;
+    char* const end = out_buf + sizeof(out_buf) - 2;
+
+    const time_t secs = static_cast<time_t>(rec.timestamp_ns / 1000000000ULL);
+    const unsigned ms = static_cast<unsigned>((rec.timestamp_ns / 1000000ULL) % 1000);
+    tm local;
+    localtime_r(&secs, &local);
+
+    static const char LEVEL_CHAR[] = {'D', 'I', 'W', 'E'};
+
+    p += std::snprintf(p, end - p, "%02d:%02d:%02d.%03u %c [%s] ",
+                       local.tm_hour, local.tm_min, local.tm_sec, ms,
+                       LEVEL_CHAR[static_cast<int>(rec.level) & 3], rec.tag);
+
+    uint8_t arg = 0;
+    for (const char* f = rec.fmt; *f && p < end; f++) {
+        if (f[0] != '{' || f[1] != '}' || arg >= rec.argc) {
+            *p++ = *f;
+            continue;
+        }
+
+        const LogArg& a = rec.args[arg++];
+        const size_t room = end - p;
+
+        switch (a.type) {
+        case LogArg::Type::INT:
+            p += std::snprintf(p, room, "%" PRId64, a.i);
+            break;
+        case LogArg::Type::UINT:
+            p += std::snprintf(p, room, "%" PRIu64, a.u);
+            break;
+        case LogArg::Type::DOUBLE:
+            p += std::snprintf(p, room, "%g", a.d);
+            break;
+        case LogArg::Type::TEXT:
+            p += std::snprintf(p, room, "%s", rec.text + a.text_offset);
+            break;
+        }
+        if (p > end)
+            p = end;
+        f++;
+    }
+
+    *p++ = '\n';
+    out_len = p - out_buf;
+}
+
+void Logger::writeOut() {
+    size_t off = 0;
+    while (off < out_len) {
+        ssize_t n = ::write(STDOUT_FILENO, out_buf + off, out_len - off);
+        if (n <= 0)
+            break;
+        off += n;
+    }
+    out_len = 0;
+}
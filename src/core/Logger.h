@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "core/SpscRing.h"
+
+enum class LogLevel : uint8_t {
+    DEBUG = 0,
+    INFO  = 1,
+    WARN  = 2,
+    ERROR = 3
+};
+
+// Records below this level compile to nothing (set from CMake)
+#ifndef GCS_LOG_MIN_LEVEL
+#define GCS_LOG_MIN_LEVEL 1
+#endif
+
+static constexpr size_t LOG_MAX_ARGS = 6;
+static constexpr size_t LOG_TEXT_BYTES = 64;
+static constexpr size_t LOG_RING_RECORDS = 4096;
+static constexpr size_t LOG_MAX_THREADS = 32;
+
+struct LogArg {
+    enum class Type : uint8_t { INT, UINT, DOUBLE, TEXT };
+
+    Type type;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        uint16_t text_offset;    // into LogRecord::text
+    };
+};
+
+// Binary log record. tag and fmt must be string literals; string
+// arguments are copied into text so the caller's buffer can change.
+struct LogRecord {
+    uint64_t timestamp_ns;       // CLOCK_REALTIME
+    const char* tag;
+    const char* fmt;             // "{}" placeholders
+    LogLevel level;
+    uint8_t argc;
+    uint8_t text_used;
+    LogArg args[LOG_MAX_ARGS];
+    char text[LOG_TEXT_BYTES];
+};
+
+// -------------------------------------------------
+// Asynchronous logger. The calling thread only fills
+// a binary record into its own SPSC ring; a background
+// thread formats and writes to stdout. A full ring
+// drops the record and bumps a counter, never blocks.
+// -------------------------------------------------
+class Logger {
+public:
+    static Logger& instance();
+
+    ~Logger();
+
+    template <typename... Args>
+    void write(LogLevel level, const char* tag, const char* fmt, const Args&... args);
+
+    // Records lost to full rings since startup
+    uint64_t droppedRecords() const;
+
+    // Formats everything queued so far on the calling thread
+    void flush();
+
+    // Runtime threshold on top of GCS_LOG_MIN_LEVEL (benchmarks, tools)
+    static void setMinLevel(LogLevel level) {
+        min_level.store(level, std::memory_order_relaxed);
+    }
+
+    static bool enabled(LogLevel level) {
+        return level >= min_level.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct ThreadRing {
+        SpscRing<LogRecord, LOG_RING_RECORDS> ring;
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    Logger();
+
+    template <typename T>
+    static void capture(LogRecord& rec, const T& value);
+
+    // Out of line: inlined into a call site, GCC reads the bound
+    // against whatever literal it can see and warns of an overread
+    static void captureText(LogRecord& rec, LogArg& arg, const char* s, size_t max_len);
+
+    void push(const LogRecord& rec);
+    ThreadRing* localRing();
+
+    void run();
+    size_t drain();
+    void emit(const LogRecord& rec);
+    void writeOut();
+
+    std::mutex register_mutex;
+    ThreadRing* rings[LOG_MAX_THREADS] = {};
+    std::atomic<size_t> ring_count{0};
+
+    std::mutex drain_mutex;
+    char out_buf[64 * 1024];
+    size_t out_len = 0;
+    uint64_t reported_drops = 0;
+
+    std::atomic<bool> running{true};
+    std::thread worker;
+
+    static inline std::atomic<LogLevel> min_level{LogLevel::DEBUG};
+};
+
+template <typename T>
+void Logger::capture(LogRecord& rec, const T& value) {
+    if (rec.argc >= LOG_MAX_ARGS)
+        return;
+
+    LogArg& a = rec.args[rec.argc++];
+
+    if constexpr (std::is_enum<T>::value) {
+        a.type = LogArg::Type::INT;
+        a.i = static_cast<int64_t>(value);
+    } else if constexpr (std::is_floating_point<T>::value) {
+        a.type = LogArg::Type::DOUBLE;
+        a.d = value;
+    } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+        a.type = LogArg::Type::INT;
+        a.i = value;
+    } else if constexpr (std::is_integral<T>::value) {
+        a.type = LogArg::Type::UINT;
+        a.u = value;
+    } else {
+        static_assert(std::is_convertible<const T&, const char*>::value,
+                      "log arguments are numbers, enums or C strings");
+
+        // Fixed char arrays (e.g. MAVLink text fields) may lack a NUL
+        if constexpr (std::is_array<T>::value)
+            captureText(rec, a, value, std::extent<T>::value);
+        else
+            captureText(rec, a, value, LOG_TEXT_BYTES);
+    }
+}
+
+template <typename... Args>
+void Logger::write(LogLevel level, const char* tag, const char* fmt, const Args&... args) {
+    LogRecord rec;
+
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    rec.timestamp_ns = uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec);
+    rec.tag = tag;
+    rec.fmt = fmt;
+    rec.level = level;
+    rec.argc = 0;
+    rec.text_used = 0;
+    rec.text[LOG_TEXT_BYTES - 1] = '\0';
+
+    (capture(rec, args), ...);
+
+    push(rec);
+}
+
+template <LogLevel Level, typename... Args>
+inline void logWrite(const char* tag, const char* fmt, const Args&... args) {
+    if constexpr (static_cast<int>(Level) >= GCS_LOG_MIN_LEVEL) {
+        if (Logger::enabled(Level))
+            Logger::instance().write(Level, tag, fmt, args...);
+    }
+}
+
+#define LOG_DEBUG(tag, ...) logWrite<LogLevel::DEBUG>(tag, __VA_ARGS__)
+#define LOG_INFO(tag, ...)  logWrite<LogLevel::INFO>(tag, __VA_ARGS__)
+#define LOG_WARN(tag, ...)  logWrite<LogLevel::WARN>(tag, __VA_ARGS__)
+#define LOG_ERROR(tag, ...) logWrite<LogLevel::ERROR>(tag, __VA_ARGS__)
@@ -0,0 +1,172 @@
+#include "core/Metrics.h"
+#include "core/Logger.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+struct MetricInfo {
+    const char* name;
+    const char* help;
+};
+
+static const MetricInfo COUNTER_INFO[] = {
+    { "gcs_datagrams_in_total",      "UDP datagrams received" },
+    { "gcs_bytes_in_total",          "UDP payload bytes received" },
+    { "gcs_datagrams_out_total",     "UDP datagrams sent" },
+    { "gcs_bytes_out_total",         "UDP payload bytes sent" },
+    { "gcs_tx_eagain_total",         "sendmmsg calls that hit a full socket buffer" },
+    { "gcs_tx_errors_total",         "Outbound datagrams dropped after a send error" },
+    { "gcs_tx_dropped_total",        "Outbound frames dropped on a full TX queue" },
+    { "gcs_crc_errors_total",        "MAVLink frames failing CRC" },
+    { "gcs_bytes_skipped_total",     "Bytes skipped while resynchronising on STX" },
+    { "gcs_frames_truncated_total",  "Frames cut off at the end of a datagram" },
+    { "gcs_unknown_msgid_total",     "Frames with a msgid missing from the dialect" },
+    { "gcs_frames_malformed_total",  "Frames with unknown incompat flags or a payload length the msgid can't have" },
+    { "gcs_frames_unrouted_total",   "Valid frames matched to no vehicle" },
+    { "gcs_commands_sent_total",     "COMMAND_LONG first sends" },
+    { "gcs_command_retries_total",   "COMMAND_LONG resends after an ACK timeout" },
+    { "gcs_command_timeouts_total",  "Commands given up after the last retry" },
+    { "gcs_acks_matched_total",      "COMMAND_ACKs matched to a pending command" },
+    { "gcs_acks_stray_total",        "COMMAND_ACKs matching nothing in flight" },
+    { "gcs_ack_queue_drops_total",   "COMMAND_ACKs lost to a full per-vehicle queue" },
+    { "gcs_mission_items_sent_total", "MISSION_ITEM_INTs served to uploading vehicles" },
+    { "gcs_mission_items_rx_total",  "MISSION_ITEM_INTs stored by downloads" },
+    { "gcs_mission_resends_total",   "Mission frames resent after a timeout" },
+    { "gcs_mission_drops_total",     "Mission replies lost to a full per-vehicle queue" },
+    { "gcs_params_rx_total",         "Distinct PARAM_VALUEs stored by downloads" },
+    { "gcs_param_gap_reads_total",   "PARAM_REQUEST_READs for indices the stream missed" },
+    { "gcs_param_cache_hits_total",  "Vehicles whose parameters came from the cache" },
+    { "gcs_param_drops_total",       "PARAM_VALUEs lost to a full per-vehicle queue" },
+    { "gcs_stream_intervals_sent_total", "SET_MESSAGE_INTERVALs sent, resends included" },
+    { "gcs_stream_reapplied_total",  "Streams set again after missing their target rate" },
+    { "gcs_udp_ring_starved_total",  "io_uring receives stopped with every slot still held" },
+};
+static_assert(sizeof(COUNTER_INFO) / sizeof(COUNTER_INFO[0]) == size_t(Counter::COUNT),
+              "one entry per Counter");
+
+static const MetricInfo GAUGE_INFO[] = {
+    { "gcs_tx_queue_depth",          "Datagrams left queued after the last flush" },
+    { "gcs_timers_pending",          "Armed timers on the control wheel" },
+};
+static_assert(sizeof(GAUGE_INFO) / sizeof(GAUGE_INFO[0]) == size_t(Gauge::COUNT),
+              "one entry per Gauge");
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+MetricsShard* Metrics::registerThread() {
+    std::lock_guard<std::mutex> lock(register_mutex);
+
+    const size_t n = shard_count.load(std::memory_order_relaxed);
+    if (n >= METRICS_MAX_THREADS)
+        return &overflow;
+
+    // Shards outlive their threads so totals never go backwards
+    shards[n] = new MetricsShard();
+    shard_count.store(n + 1, std::memory_order_release);
+    return shards[n];
+}
+
+int Metrics::addCollector(Collector collector) {
+    std::lock_guard<std::mutex> lock(collector_mutex);
+    const int id = next_collector++;
+    collectors.emplace_back(id, std::move(collector));
+    return id;
+}
+
+void Metrics::removeCollector(int id) {
+    std::lock_guard<std::mutex> lock(collector_mutex);
+    for (auto it = collectors.begin(); it != collectors.end(); ++it) {
+        if (it->first == id) {
+            collectors.erase(it);
+            return;
+        }
+    }
+}
+
+void Metrics::family(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void Metrics::sample(std::string& out, const char* name, const char* labels, double value) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.17g", value);
+
+    out += name;
+    if (labels && *labels) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += buf;
+    out += '\n';
+}
+
+std::string Metrics::render() {
+    const size_t n = shard_count.load(std::memory_order_acquire);
+
+    auto sumCounter = [&](size_t i) {
+        uint64_t total = overflow.counters[i].load(std::memory_order_relaxed);
+        for (size_t s = 0; s < n; s++)
+            total += shards[s]->counters[i].load(std::memory_order_relaxed);
+        return total;
+    };
+
+    auto sumGauge = [&](size_t i) {
+        int64_t total = overflow.gauges[i].load(std::memory_order_relaxed);
+        for (size_t s = 0; s < n; s++)
+            total += shards[s]->gauges[i].load(std::memory_order_relaxed);
+        return total;
+    };
+
+    std::string out;
+    out.reserve(16 * 1024);
+
+    for (size_t i = 0; i < size_t(Counter::COUNT); i++) {
+        family(out, COUNTER_INFO[i].name, "counter", COUNTER_INFO[i].help);
+        sample(out, COUNTER_INFO[i].name, nullptr, double(sumCounter(i)));
+    }
+
+    for (size_t i = 0; i < size_t(Gauge::COUNT); i++) {
+        family(out, GAUGE_INFO[i].name, "gauge", GAUGE_INFO[i].help);
+        sample(out, GAUGE_INFO[i].name, nullptr, double(sumGauge(i)));
+    }
+
+    // Only msgids seen so far, to keep the scrape small
+    family(out, "gcs_frames_total", "counter", "Valid MAVLink frames by msgid");
+    for (size_t id = 0; id < METRICS_MSGID_SLOTS; id++) {
+        uint64_t total = overflow.frames_by_msgid[id].load(std::memory_order_relaxed);
+        for (size_t s = 0; s < n; s++)
+            total += shards[s]->frames_by_msgid[id].load(std::memory_order_relaxed);
+        if (total == 0)
+            continue;
+
+        char labels[32];
+        if (id < METRICS_MSGID_SLOTS - 1)
+            std::snprintf(labels, sizeof(labels), "msgid=\"%zu\"", id);
+        else
+            std::snprintf(labels, sizeof(labels), "msgid=\"other\"");
+        sample(out, "gcs_frames_total", labels, double(total));
+    }
+
+    family(out, "gcs_log_dropped_total", "counter", "Log records lost to full rings");
+    sample(out, "gcs_log_dropped_total", nullptr,
+           double(Logger::instance().droppedRecords()));
+
+    std::lock_guard<std::mutex> lock(collector_mutex);
+    for (auto& c : collectors)
+        c.second(out);
+
+    return out;
+}
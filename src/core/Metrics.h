@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+static constexpr size_t METRICS_MAX_THREADS = 32;
+
+// Frames per msgid; ids past the dispatch table share the last slot
+static constexpr size_t METRICS_MSGID_SLOTS = 512 + 1;
+
+enum class Counter : uint8_t {
+    DATAGRAMS_IN,
+    BYTES_IN,
+    DATAGRAMS_OUT,
+    BYTES_OUT,
+    TX_EAGAIN,
+    TX_ERRORS,
+    TX_DROPPED,         // TX arena or queue full
+    CRC_ERRORS,
+    BYTES_SKIPPED,      // scanner resync
+    TRUNCATED,
+    UNKNOWN_MSGID,
+    FRAMES_MALFORMED,   // unknown incompat flags, impossible payload length
+    FRAMES_UNROUTED,    // GCS echoes, non-autopilot components, full fleet
+    COMMANDS_SENT,
+    COMMAND_RETRIES,
+    COMMAND_TIMEOUTS,
+    ACKS_MATCHED,
+    ACKS_STRAY,
+    ACK_QUEUE_DROPS,
+    MISSION_ITEMS_SENT,
+    MISSION_ITEMS_RECEIVED,
+    MISSION_RESENDS,
+    MISSION_EVENT_DROPS,
+    PARAMS_RECEIVED,
+    PARAM_GAP_READS,
+    PARAM_CACHE_HITS,
+    PARAM_EVENT_DROPS,
+    STREAM_INTERVALS_SENT,
+    STREAMS_REAPPLIED,
+    UDP_RING_STARVED,   // io_uring receive disarmed, every slot held
+    COUNT
+};
+
+enum class Gauge : uint8_t {
+    TX_QUEUE_DEPTH,
+    TIMERS_PENDING,
+    COUNT
+};
+
+// -------------------------------------------------
+// One thread's counters. Only the owning thread
+// writes, so an update is a relaxed load + store
+// rather than a locked RMW; the alignment keeps two
+// threads' shards off each other's cache lines.
+// -------------------------------------------------
+struct alignas(64) MetricsShard {
+    std::atomic<uint64_t> counters[size_t(Counter::COUNT)] = {};
+    std::atomic<int64_t> gauges[size_t(Gauge::COUNT)] = {};
+    std::atomic<uint64_t> frames_by_msgid[METRICS_MSGID_SLOTS] = {};
+
+    void add(Counter c, uint64_t n = 1) {
+        std::atomic<uint64_t>& v = counters[size_t(c)];
+        v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // A gauge belongs to the one thread that sets it
+    void set(Gauge g, int64_t value) {
+        gauges[size_t(g)].store(value, std::memory_order_relaxed);
+    }
+
+    void frame(uint32_t msgid) {
+        std::atomic<uint64_t>& v = frames_by_msgid[
+            msgid < METRICS_MSGID_SLOTS - 1 ? msgid : METRICS_MSGID_SLOTS - 1];
+        v.store(v.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+// -------------------------------------------------
+// Process-wide registry. Hot paths only ever touch
+// their own shard; render() sums the shards and runs
+// the registered collectors on the scraping thread.
+// -------------------------------------------------
+class Metrics {
+public:
+    // Appends Prometheus text for state that lives elsewhere (per
+    // vehicle, pipeline depths). Runs on the scraper: read atomics only.
+    using Collector = std::function<void(std::string& out)>;
+
+    static Metrics& instance();
+
+    // The calling thread's shard, registered on first use
+    static MetricsShard& local() {
+        static thread_local MetricsShard* tls_shard = nullptr;
+        if (!tls_shard)
+            tls_shard = instance().registerThread();
+        return *tls_shard;
+    }
+
+    int addCollector(Collector collector);
+    void removeCollector(int id);
+
+    // Prometheus text exposition format, version 0.0.4
+    std::string render();
+
+    // Helpers for collectors
+    static void family(std::string& out, const char* name, const char* type, const char* help);
+    static void sample(std::string& out, const char* name, const char* labels, double value);
+
+private:
+    Metrics() = default;
+
+    MetricsShard* registerThread();
+
+    std::mutex register_mutex;
+    MetricsShard* shards[METRICS_MAX_THREADS] = {};
+    std::atomic<size_t> shard_count{0};
+
+    // Threads past METRICS_MAX_THREADS share this one; their
+    // concurrent updates may lose counts
+    MetricsShard overflow;
+
+    std::mutex collector_mutex;
+    std::vector<std::pair<int, Collector>> collectors;
+    int next_collector = 1;
+};
@@ -0,0 +1,166 @@
+#include "core/MetricsServer.h"
+#include "core/Logger.h"
+#include "core/Metrics.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// How long a client gets to send its request line
+static constexpr int METRICS_REQUEST_WAIT_MS = 100;
+
+// How long a client gets to read the whole reply before it is dropped
+static constexpr int METRICS_REPLY_WAIT_MS = 1000;
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(const std::string& path) {
+
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("METRICS", "Socket path too long");
+        return false;
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        perror("socket(AF_UNIX)");
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    unlink(path.c_str());
+
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listen_fd, 8) < 0) {
+        perror("bind/listen (metrics)");
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stop_fd < 0) {
+        perror("eventfd");
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    socket_path = path;
+    worker = std::thread([this]() { run(); });
+
+    LOG_INFO("METRICS", "Serving on {}", path.c_str());
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (worker.joinable()) {
+        uint64_t one = 1;
+        if (write(stop_fd, &one, sizeof(one)) < 0)
+            perror("eventfd write");
+        worker.join();
+    }
+
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        unlink(socket_path.c_str());
+        listen_fd = -1;
+    }
+    if (stop_fd >= 0) {
+        close(stop_fd);
+        stop_fd = -1;
+    }
+}
+
+void MetricsServer::run() {
+    pollfd fds[2] = {
+        { listen_fd, POLLIN, 0 },
+        { stop_fd, POLLIN, 0 },
+    };
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll (metrics)");
+            return;
+        }
+
+        if (fds[1].revents)
+            return;
+
+        if (fds[0].revents & POLLIN) {
+            int client = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0) {
+                serve(client);
+                close(client);
+            }
+        }
+    }
+}
+
+void MetricsServer::serve(int client) {
+    char request[1024];
+    ssize_t got = 0;
+
+    pollfd pfd{ client, POLLIN, 0 };
+    if (poll(&pfd, 1, METRICS_REQUEST_WAIT_MS) > 0)
+        got = recv(client, request, sizeof(request) - 1, MSG_DONTWAIT);
+
+    const bool http = got >= 4 && std::memcmp(request, "GET ", 4) == 0;
+
+    const std::string body = Metrics::instance().render();
+
+    std::string reply;
+    if (http) {
+        char header[160];
+        std::snprintf(header, sizeof(header),
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: %zu\r\n"
+            "Connection: close\r\n\r\n",
+            body.size());
+        reply = header;
+    }
+    reply += body;
+
+    // A client that stops reading must not wedge the metrics thread:
+    // never block in send, and give up once the deadline passes
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(METRICS_REPLY_WAIT_MS);
+
+    size_t sent = 0;
+    while (sent < reply.size()) {
+        ssize_t n = send(client, reply.data() + sent, reply.size() - sent,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n >= 0) {
+            sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            return;
+
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+
+        pollfd out{ client, POLLOUT, 0 };
+        if (left <= 0 || poll(&out, 1, static_cast<int>(left)) <= 0) {
+            LOG_WARN("METRICS", "Client stopped reading, dropped after {} of {} bytes",
+                     sent, reply.size());
+            return;
+        }
+    }
+}
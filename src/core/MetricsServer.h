@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <thread>
+
+// -------------------------------------------------
+// Serves Metrics::render() on a Unix-domain stream
+// socket from its own thread. An HTTP GET gets an
+// HTTP response (curl --unix-socket, Prometheus via
+// a socket proxy); anything else, or no request at
+// all within a moment, gets the bare text.
+// -------------------------------------------------
+class MetricsServer {
+public:
+    MetricsServer() = default;
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // Replaces a stale socket file left by an earlier run
+    bool start(const std::string& path);
+    void stop();
+
+private:
+    void run();
+    void serve(int client);
+
+    std::string socket_path;
+    int listen_fd = -1;
+    int stop_fd = -1;
+    std::thread worker;
+};
@@ -0,0 +1,381 @@
+#include "core/Pipeline.h"
+#include "comm/MavlinkRouter.h"
+#include "comm/UdpTransport.h"
+#include "core/EventLoop.h"
+#include "core/GcsClock.h"
+#include "core/Logger.h"
+#include "core/Metrics.h"
+#include "record/TlogRecorder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+static_assert(FRAME_POOL_SLABS <= PIPELINE_SLOTS,
+              "the parse queue must hold every slab");
+
+static void configureThread(std::thread& t, const char* name, int cpu) {
+    pthread_setname_np(t.native_handle(), name);
+
+    if (cpu < 0)
+        return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    int err = pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+    if (err != 0)
+        LOG_WARN("PIPE", "Pinning {} to CPU {} failed: {}", name, cpu, std::strerror(err));
+    else
+        LOG_INFO("PIPE", "{} pinned to CPU {}", name, cpu);
+}
+
+Pipeline::Pipeline(
+    UdpTransport& udp_,
+    TlogRecorder& recorder_,
+    const HistoryConfig& history,
+    const MissionPlan* mission,
+    const ParamOptions& params,
+    const StreamPlan& streams)
+    : udp(udp_),
+      recorder(recorder_),
+      gcs(control_tx, history, mission, params, streams) {
+
+    metrics_collector = Metrics::instance().addCollector([this](std::string& out) {
+        const Stats s = stats();
+
+        Metrics::family(out, "gcs_pipeline_rx_depth", "gauge", "Datagrams waiting for the parse thread");
+        Metrics::sample(out, "gcs_pipeline_rx_depth", nullptr, double(s.rx_depth));
+        Metrics::family(out, "gcs_pipeline_rx_depth_max", "gauge", "Deepest the parse queue has been");
+        Metrics::sample(out, "gcs_pipeline_rx_depth_max", nullptr, double(s.rx_depth_max));
+        Metrics::family(out, "gcs_pipeline_slot_stalls_total", "counter", "Receives deferred for lack of a free frame slab");
+        Metrics::sample(out, "gcs_pipeline_slot_stalls_total", nullptr, double(s.slot_stalls));
+        Metrics::family(out, "gcs_pipeline_control_wakeups_total", "counter", "Control wakeups on a received ACK");
+        Metrics::sample(out, "gcs_pipeline_control_wakeups_total", nullptr, double(s.control_wakeups));
+    });
+}
+
+Pipeline::~Pipeline() {
+    Metrics::instance().removeCollector(metrics_collector);
+    stop();
+
+    for (int fd : {stop_fd, parse_wake_fd, control_wake_fd, io_wake_fd}) {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+void Pipeline::setRouter(MavlinkRouter* router_) {
+    router = router_;
+    gcs.setRouter(router_);
+}
+
+bool Pipeline::start(const PipelineConfig& config) {
+
+    stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    parse_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    control_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    io_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (stop_fd < 0 || parse_wake_fd < 0 || control_wake_fd < 0 || io_wake_fd < 0) {
+        perror("eventfd");
+        return false;
+    }
+
+    control_tx.bind(udp.getSocketFd());
+    if (udp.backend() == UdpBackend::URING && !control_tx.useUring())
+        LOG_WARN("PIPE", "io_uring send unavailable for control, using sendmmsg");
+
+    // Downstream first, so nothing is produced before it can be consumed
+    control = std::thread(&Pipeline::controlThread, this);
+    parse = std::thread(&Pipeline::parseThread, this);
+    io = std::thread(&Pipeline::ioThread, this);
+
+    configureThread(io, "gcs-io", config.io_cpu);
+    configureThread(parse, "gcs-parse", config.parse_cpu);
+    configureThread(control, "gcs-control", config.control_cpu);
+
+    LOG_INFO("PIPE", "Pipeline started ({} slots)", PIPELINE_SLOTS);
+    return true;
+}
+
+void Pipeline::stop() {
+    if (stop_fd >= 0)
+        wake(stop_fd);
+
+    const bool was_running = control.joinable();
+
+    for (std::thread* t : {&io, &parse, &control}) {
+        if (t->joinable())
+            t->join();
+    }
+
+    // Control has stopped; its counters are final
+    if (was_running)
+        gcs.logCommandLatency();
+}
+
+void Pipeline::wake(int fd) {
+    uint64_t one = 1;
+    if (write(fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        perror("eventfd write");
+}
+
+Pipeline::Stats Pipeline::stats() const {
+    Stats s;
+    s.datagrams = datagrams_.load(std::memory_order_relaxed);
+    s.slot_stalls = slot_stalls_.load(std::memory_order_relaxed);
+    s.control_wakeups = control_wakeups_.load(std::memory_order_relaxed);
+    s.rx_depth = rx_ready.size();
+    s.rx_depth_max = rx_depth_max_.load(std::memory_order_relaxed);
+    s.tx_pending = tx_pending_.load(std::memory_order_relaxed);
+    return s;
+}
+
+// ================= I/O STAGE =================
+void Pipeline::ioThread() {
+    EventLoop loop;
+    if (!loop.start())
+        return;
+
+    // This thread owns the receive ring from here on
+    if (udp.backend() == UdpBackend::URING && !udp.startRing()) {
+        LOG_ERROR("PIPE", "io_uring receive failed to start");
+        return;
+    }
+
+    loop.addReader(udp.getReceiveFd(), [&]() { ioReceive(loop); });
+    loop.addReader(io_wake_fd, [&]() {
+        uint64_t count;
+        if (read(io_wake_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+            return;
+
+        // Parse released slabs: watch the socket again
+        if (rx_parked) {
+            loop.enableReader(udp.getReceiveFd());
+            rx_parked = false;
+        }
+        ioReceive(loop);
+
+        if (router_parked) {
+            loop.enableReader(router->getSocketFd());
+            router_parked = false;
+            routerReceive(loop);
+        }
+    });
+
+    if (router)
+        loop.addReader(router->getSocketFd(), [&]() { routerReceive(loop); });
+
+    if (recorder.isOpen()) {
+        loop.addTimer(TLOG_FLUSH_PERIOD_MS, [&]() {
+            recorder.flush();
+        });
+    }
+
+    loop.addReader(stop_fd, [&]() { loop.stop(); });
+    loop.run();
+}
+
+void Pipeline::ioReceive(EventLoop& loop) {
+    FrameSlab* batch[RX_BATCH_SIZE];
+    bool stalled = false;
+
+    for (;;) {
+        int n = udp.receive(batch, RX_BATCH_SIZE);
+
+        if (n > 0) {
+            for (int i = 0; i < n; i++) {
+                if (recorder.isOpen())
+                    recorder.record(batch[i]->dgram);
+
+                // Never fails: the ring holds every slab
+                rx_ready.push(batch[i]);
+            }
+
+            datagrams_.store(datagrams_.load(std::memory_order_relaxed) + n,
+                             std::memory_order_relaxed);
+
+            size_t depth = rx_ready.size();
+            if (depth > rx_depth_max_.load(std::memory_order_relaxed))
+                rx_depth_max_.store(depth, std::memory_order_relaxed);
+
+            wake(parse_wake_fd);
+        }
+
+        // A short batch means the socket (or ring) is drained
+        if (n == RX_BATCH_SIZE)
+            continue;
+        if (n < 0 || !udp.starved())
+            return;
+
+        // Still none after asking: the datagrams keep the socket
+        // readable, so stop watching it until parse's wakeup
+        if (stalled) {
+            loop.disableReader(udp.getReceiveFd());
+            rx_parked = true;
+            return;
+        }
+
+        awaitSlabs();
+        stalled = true;
+    }
+}
+
+// Client traffic shares the pool, so it parks the same way as
+// the vehicle socket when the router finds no free slab
+void Pipeline::routerReceive(EventLoop& loop) {
+    router->receiveUpstream();
+    if (!router->starved())
+        return;
+
+    awaitSlabs();
+    router->receiveUpstream();
+    if (router->starved()) {
+        loop.disableReader(router->getSocketFd());
+        router_parked = true;
+    }
+}
+
+// Parse and the router hold every slab. Ask parse for a wakeup when
+// it releases some (it clears the flag); the caller then looks once
+// more in case they came back meanwhile. Pairs with wakeStarvedIo().
+void Pipeline::awaitSlabs() {
+    slot_stalls_.store(slot_stalls_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+    rx_starved_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+// ================= PARSE STAGE =================
+void Pipeline::parseThread() {
+    EventLoop loop;
+    if (!loop.start())
+        return;
+
+    loop.addReader(parse_wake_fd, [&]() {
+        uint64_t count;
+        if (read(parse_wake_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+            return;
+        parseDrain();
+    });
+
+    // Client sockets that refused fan-out get another go a tick later
+    // even when no vehicle traffic arrives to carry it; the timer is
+    // armed only while something is queued
+    bool retry_armed = false;
+    if (router) {
+        const int retry_fd = loop.addTimer(0, [&]() {
+            retry_armed = false;
+            if (router->backlogged()) {
+                router->flush();
+                wakeStarvedIo();
+            }
+        });
+
+        loop.setPostDispatch([&, retry_fd]() {
+            if (router->backlogged() && !retry_armed) {
+                retry_armed = loop.armTimer(
+                    retry_fd, GcsClock::now() + std::chrono::milliseconds(TIMER_WHEEL_TICK_MS));
+            }
+        });
+    }
+
+    loop.addReader(stop_fd, [&]() { loop.stop(); });
+    loop.run();
+}
+
+void Pipeline::parseDrain() {
+    FrameSlab* done[RX_BATCH_SIZE];
+    size_t n;
+
+    do {
+        n = 0;
+        while (n < RX_BATCH_SIZE && rx_ready.pop(done[n]))
+            gcs.ingest(*done[n++]);
+
+        // The router took its own references to what it queued
+        if (router)
+            router->flush();
+
+        for (size_t i = 0; i < n; i++)
+            done[i]->release();
+    } while (n == RX_BATCH_SIZE);
+
+    wakeStarvedIo();
+
+    gcs.publishSnapshots();
+
+    // ACKs are the only parse output that can't wait for a tick
+    if (gcs.takeAckSeen())
+        wake(control_wake_fd);
+}
+
+// A starved receive resumes only when io hears slabs came back
+void Pipeline::wakeStarvedIo() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (rx_starved_.load(std::memory_order_relaxed)) {
+        rx_starved_.store(false, std::memory_order_relaxed);
+        wake(io_wake_fd);
+    }
+}
+
+// ================= CONTROL STAGE =================
+void Pipeline::controlThread() {
+    EventLoop loop;
+    if (!loop.start())
+        return;
+
+    loop.addReader(control_wake_fd, [&]() {
+        uint64_t count;
+        if (read(control_wake_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+            return;
+        control_wakeups_.store(control_wakeups_.load(std::memory_order_relaxed) + 1,
+                               std::memory_order_relaxed);
+        gcs.runCommands();
+    });
+
+    // Heartbeat, command retries, mission and failsafe all run off the
+    // wheel; the one-shot timer sleeps until its next deadline
+    GcsClock::time_point tick_deadline = GcsClock::time_point::max();
+    const int tick_fd = loop.addTimer(0, [&]() {
+        tick_deadline = GcsClock::time_point::max();
+        gcs.tick(GcsClock::now());
+    });
+
+    // Ticks and ACK wakeups both (re)schedule timers. Sends the
+    // socket refused get another go a tick later.
+    auto armTick = [&]() {
+        GcsClock::time_point next = gcs.nextDeadline();
+        if (control_tx.pending() != 0)
+            next = std::min(next, GcsClock::now() + std::chrono::milliseconds(TIMER_WHEEL_TICK_MS));
+
+        if (next != tick_deadline && loop.armTimer(tick_fd, next))
+            tick_deadline = next;
+    };
+
+    loop.addTimer(PIPELINE_STATS_PERIOD_MS, [&]() {
+        Stats s = stats();
+        LOG_DEBUG("PIPE", "rx {} depth {}/{} stalls {} acks {} tx {}",
+                  s.datagrams, s.rx_depth, s.rx_depth_max,
+                  s.slot_stalls, s.control_wakeups, s.tx_pending);
+    });
+
+    loop.addReader(stop_fd, [&]() { loop.stop(); });
+
+    loop.setPostDispatch([&]() {
+        control_tx.flush();
+        tx_pending_.store(control_tx.pending(), std::memory_order_relaxed);
+        armTick();
+    });
+
+    gcs.sendHeartbeat();
+    armTick();
+    loop.run();
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "comm/FramePool.h"
+#include "comm/TxQueue.h"
+#include "core/GroundStation.h"
+#include "core/SpscRing.h"
+
+class EventLoop;
+class MavlinkRouter;
+class UdpTransport;
+class TlogRecorder;
+
+// io -> parse queue; holds every slab the pool has
+static constexpr size_t PIPELINE_SLOTS = 1024;
+
+static constexpr int PIPELINE_STATS_PERIOD_MS = 10000;
+
+struct PipelineConfig {
+    // CPU per stage, -1 = leave to the scheduler
+    int io_cpu = -1;
+    int parse_cpu = -1;
+    int control_cpu = -1;
+};
+
+// -------------------------------------------------
+// Staged pipeline mode: three threads, each with its
+// own EventLoop.
+//
+//   io      receive into frame slabs, record, hand off;
+//           router clients -> vehicles
+//   parse   scan/route/parse, fan out to router clients,
+//           publish snapshots
+//   control commands, ACKs, mission, parameters, failsafe, heartbeat
+//
+// io -> parse passes slab pointers over an SPSC ring,
+// so datagrams are never copied. Parse drops its
+// reference once a batch is routed and the slab goes
+// back to the pool (and, under io_uring, the kernel)
+// when the router has sent it too. parse -> control
+// goes through the per-vehicle snapshots and ACK
+// queues; control sends on its own TxQueue.
+// -------------------------------------------------
+class Pipeline {
+public:
+    struct Stats {
+        uint64_t datagrams;          // io -> parse
+        uint64_t slot_stalls;        // receive deferred: every slab in flight
+        uint64_t control_wakeups;    // ACK/mission-driven control passes
+        size_t rx_depth;             // io -> parse queue now
+        size_t rx_depth_max;         // io -> parse high-water mark
+        size_t tx_pending;           // control TX queue now
+    };
+
+    Pipeline(
+        UdpTransport& udp,
+        TlogRecorder& recorder,
+        const HistoryConfig& history,
+        const MissionPlan* mission = nullptr,
+        const ParamOptions& params = ParamOptions{},
+        const StreamPlan& streams = StreamPlan{});
+    ~Pipeline();
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    // Before start(); the router's client socket is served by io
+    // and its fan-out by parse
+    void setRouter(MavlinkRouter* router);
+
+    bool start(const PipelineConfig& config);
+
+    // Any thread except the stages; returns once all have exited
+    void stop();
+
+    Stats stats() const;
+
+private:
+    void ioThread();
+    void parseThread();
+    void controlThread();
+
+    void ioReceive(EventLoop& loop);
+    void routerReceive(EventLoop& loop);
+    void awaitSlabs();
+    void parseDrain();
+    void wakeStarvedIo();
+
+    static void wake(int fd);
+
+    UdpTransport& udp;
+    TlogRecorder& recorder;
+    MavlinkRouter* router = nullptr;
+
+    TxQueue control_tx;
+    GroundStation gcs;
+
+    SpscRing<FrameSlab*, PIPELINE_SLOTS> rx_ready;   // io -> parse, one reference each
+
+    int stop_fd = -1;          // readable once stop() runs; never drained
+    int parse_wake_fd = -1;
+    int control_wake_fd = -1;
+    int io_wake_fd = -1;       // slabs back for a starved receive
+
+    std::thread io, parse, control;
+
+    // Each counter has a single writer
+    std::atomic<uint64_t> datagrams_{0};
+    std::atomic<uint64_t> slot_stalls_{0};
+    std::atomic<uint64_t> control_wakeups_{0};
+    std::atomic<size_t> rx_depth_max_{0};
+    std::atomic<size_t> tx_pending_{0};
+    std::atomic<bool> rx_starved_{false};
+    bool rx_parked = false;     // io only: receive fd unwatched while starved
+    bool router_parked = false; // io only: router fd unwatched while starved
+
+    int metrics_collector = 0;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "core/SpscRing.h"
+
+// -------------------------------------------------
+// Single-writer sequence lock. The writer never waits;
+// readers copy the value and retry if a store overlapped.
+// The payload is kept as relaxed atomic words so a torn
+// read is detected by the sequence check, not undefined.
+// -------------------------------------------------
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock holds trivially copyable values");
+
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+public:
+    SeqLock() { store(T{}); }
+
+    // Writer side only (one thread)
+    void store(const T& value) {
+        uint64_t buf[WORDS] = {};
+        std::memcpy(buf, &value, sizeof(T));
+
+        const uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < WORDS; i++)
+            words_[i].store(buf[i], std::memory_order_relaxed);
+
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Any thread; spins only while a store is in flight
+    T load() const {
+        T out;
+        while (!tryLoad(out)) {
+        }
+        return out;
+    }
+
+    bool tryLoad(T& out) const {
+        uint64_t buf[WORDS];
+
+        const uint32_t before = seq_.load(std::memory_order_acquire);
+        if (before & 1)
+            return false;
+
+        for (size_t i = 0; i < WORDS; i++)
+            buf[i] = words_[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) != before)
+            return false;
+
+        std::memcpy(&out, buf, sizeof(T));
+        return true;
+    }
+
+    // Bumps by two per store; lets readers skip unchanged snapshots
+    uint32_t version() const { return seq_.load(std::memory_order_acquire); }
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> seq_{0};
+    std::atomic<uint64_t> words_[WORDS];
+};
@@ -1,19 +1,18 @@
 #include "StateManager.h"
-#include <iostream>
+#include "core/Logger.h"
 
 void StateManager::setState(SystemState newState) {
-    if (currentState != newState) {
-        currentState = newState;
-        std::cout << "[STATE] Changed to "
-                  << static_cast<int>(newState) << std::endl;
+    if (currentState.load(std::memory_order_relaxed) != newState) {
+        currentState.store(newState, std::memory_order_release);
+        LOG_INFO("STATE", "Changed to {}", newState);
     }
 }
 
 SystemState StateManager::getState() const {
-    return currentState;
+    return currentState.load(std::memory_order_acquire);
 }
 
 // ✅ NEW: FAILSAFE query helper
 bool StateManager::isInFailsafe() const {
-    return currentState == SystemState::FAILSAFE;
+    return getState() == SystemState::FAILSAFE;
 }
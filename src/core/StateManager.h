@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
+
 #include "SystemState.h"
 
+// Written by the control path only; readable from any thread
 class StateManager {
 public:
     void setState(SystemState newState);
@@ -10,11 +13,6 @@ public:
     // ✅ NEW: explicit recovery helper
     bool isInFailsafe() const;
 
-    // Phase 4.2: allow controlled mutable access for CommandManager
-    SystemState& getMutableState() {
-        return currentState;
-    }
-
 private:
-    SystemState currentState = SystemState::DISCONNECTED;
+    std::atomic<SystemState> currentState{SystemState::DISCONNECTED};
 };
@@ -0,0 +1,118 @@
+#include "core/TimerWheel.h"
+
+#include <algorithm>
+#include <chrono>
+
+static_assert((TIMER_WHEEL_SLOTS & (TIMER_WHEEL_SLOTS - 1)) == 0,
+              "TIMER_WHEEL_SLOTS must be a power of two");
+
+TimerWheel::TimerWheel(GcsClock::time_point start)
+    : start_(start),
+      now_(start) {}
+
+void TimerWheel::link(TimerNode*& head, TimerNode& node) {
+    node.next = head;
+    if (head)
+        head->pprev = &node.next;
+    head = &node;
+    node.pprev = &head;
+}
+
+void TimerWheel::unlink(TimerNode& node) {
+    *node.pprev = node.next;
+    if (node.next)
+        node.next->pprev = node.pprev;
+    node.next = nullptr;
+    node.pprev = nullptr;
+}
+
+void TimerWheel::schedule(TimerNode& node, GcsClock::duration delay) {
+    if (node.armed())
+        cancel(node);
+
+    // First tick at or after the absolute deadline; never the current one
+    const GcsClock::duration due =
+        (now_ - start_) + std::max(delay, GcsClock::duration::zero());
+
+    uint64_t expires = static_cast<uint64_t>((due + TICK - GcsClock::duration(1)) / TICK);
+    if (expires <= tick_)
+        expires = tick_ + 1;
+
+    node.expires = expires;
+    link(slots_[node.expires & (TIMER_WHEEL_SLOTS - 1)], node);
+    pending_++;
+    next_ = std::min(next_, expires);
+}
+
+void TimerWheel::cancel(TimerNode& node) {
+    if (!node.armed())
+        return;
+    unlink(node);
+    pending_--;
+}
+
+void TimerWheel::advance(GcsClock::time_point now) {
+    if (now <= now_)
+        return;
+
+    const uint64_t target = static_cast<uint64_t>((now - start_) / TICK);
+
+    while (tick_ < target) {
+        // Nothing armed: jump straight to the target tick
+        if (pending_ == 0) {
+            tick_ = target;
+            break;
+        }
+
+        tick_++;
+        now_ = start_ + TICK * tick_;
+        runTick();
+    }
+
+    now_ = now;
+    next_ = earliest();
+}
+
+// Walks one revolution from the next tick; the first node due in
+// its own slot's turn is the earliest. Only deadlines a revolution
+// or more out need the full search.
+uint64_t TimerWheel::earliest() const {
+    if (pending_ == 0)
+        return NO_DEADLINE;
+
+    for (uint64_t t = tick_ + 1; t <= tick_ + TIMER_WHEEL_SLOTS; t++) {
+        for (const TimerNode* n = slots_[t & (TIMER_WHEEL_SLOTS - 1)]; n; n = n->next) {
+            if (n->expires == t)
+                return t;
+        }
+    }
+
+    uint64_t first = NO_DEADLINE;
+    for (const TimerNode* head : slots_) {
+        for (const TimerNode* n = head; n; n = n->next)
+            first = std::min(first, n->expires);
+    }
+    return first;
+}
+
+void TimerWheel::runTick() {
+    TimerNode*& slot = slots_[tick_ & (TIMER_WHEEL_SLOTS - 1)];
+
+    // Move everything due onto the firing list first; callbacks may
+    // then schedule or cancel freely, including nodes not yet fired.
+    for (TimerNode* n = slot; n;) {
+        TimerNode* next = n->next;
+        if (n->expires <= tick_) {
+            unlink(*n);
+            link(firing_, *n);
+        }
+        n = next;
+    }
+
+    while (firing_) {
+        TimerNode& n = *firing_;
+        unlink(n);
+        pending_--;
+        n.fn(n.owner, n.tag);
+    }
+}
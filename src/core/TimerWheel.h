@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/GcsClock.h"
+
+static constexpr int TIMER_WHEEL_TICK_MS = 10;
+static constexpr size_t TIMER_WHEEL_SLOTS = 256;   // 2.56 s per revolution
+
+// Intrusive timer; embed it in whatever owns the deadline.
+// The owner/tag pair comes back to the callback, so one
+// function can serve a whole table of timers.
+struct TimerNode {
+    using Fn = void (*)(void* owner, uint32_t tag);
+
+    Fn fn = nullptr;
+    void* owner = nullptr;
+    uint32_t tag = 0;
+
+    bool armed() const { return pprev != nullptr; }
+
+private:
+    friend class TimerWheel;
+
+    TimerNode* next = nullptr;
+    TimerNode** pprev = nullptr;     // slot head or previous node's next
+    uint64_t expires = 0;            // absolute tick
+};
+
+// -------------------------------------------------
+// Hashed timer wheel. schedule() and cancel() are O(1)
+// list splices; advance() reads no clock itself, the
+// caller passes one time per loop tick. Deadlines more
+// than a revolution out stay in their slot and are
+// skipped until their tick comes round.
+// -------------------------------------------------
+class TimerWheel {
+public:
+    explicit TimerWheel(GcsClock::time_point start);
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // (Re)arms node to fire after delay, rounded up to a whole tick;
+    // never early, at most one tick late
+    void schedule(TimerNode& node, GcsClock::duration delay);
+    void cancel(TimerNode& node);
+
+    // Fires everything due up to now, in tick order
+    void advance(GcsClock::time_point now);
+
+    // Time of the tick being processed (inside callbacks) or last processed
+    GcsClock::time_point now() const { return now_; }
+
+    // Earliest time advance() has something to fire; time_point::max()
+    // when nothing is armed. May be early after a cancel(), never late.
+    GcsClock::time_point nextDeadline() const {
+        if (next_ == NO_DEADLINE)
+            return GcsClock::time_point::max();
+        return start_ + TICK * next_;
+    }
+
+    size_t pending() const { return pending_; }
+
+private:
+    static constexpr GcsClock::duration TICK =
+        std::chrono::milliseconds(TIMER_WHEEL_TICK_MS);
+    static constexpr uint64_t NO_DEADLINE = UINT64_MAX;
+
+    static void link(TimerNode*& head, TimerNode& node);
+    static void unlink(TimerNode& node);
+
+    void runTick();
+    uint64_t earliest() const;
+
+    GcsClock::time_point start_;
+    GcsClock::time_point now_;
+    uint64_t tick_ = 0;
+    size_t pending_ = 0;
+    uint64_t next_ = NO_DEADLINE;    // earliest armed tick, or before it
+
+    TimerNode* slots_[TIMER_WHEEL_SLOTS] = {};
+    TimerNode* firing_ = nullptr;
+};
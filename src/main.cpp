@@ -1,130 +1,408 @@
+#include <algorithm>
 #include <iostream>
-#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <csignal>
+#include <cerrno>
+#include <arpa/inet.h>
+#include <sched.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
+#include "comm/MavlinkRouter.h"
 #include "comm/UdpTransport.h"
-#include "telemetry/TelemetryParser.h"
-#include "telemetry/TelemetryData.h"
-#include "core/StateManager.h"
-#include "command/CommandManager.h"
-#include "command/MavlinkCommandSender.h"
-#include "comm/GcsHeartbeat.h"
+#include "core/EventLoop.h"
+#include "core/GcsClock.h"
+#include "core/GroundStation.h"
+#include "core/Logger.h"
+#include "core/MetricsServer.h"
+#include "core/Pipeline.h"
+#include "mission/MissionPlan.h"
+#include "param/ParamTransfer.h"
+#include "record/TlogRecorder.h"
+#include "stream/StreamPlan.h"
 
-constexpr int HEARTBEAT_TIMEOUT_MS = 2000;
+static void usage(const char* argv0) {
+    cerr << "usage: " << argv0 << " [--record DIR] [--history-samples N]"
+            " [--pipeline [--pin IO,PARSE,CONTROL]] [--metrics SOCKET] [--mission FILE]"
+            " [--param-cache DIR] [--param NAME=VALUE]..."
+            " [--route HOST:PORT[/sysid=A,B][/msgid=X,Y]]... [--route-port PORT]"
+            " [--stream MSGID=HZ]... [--io-uring]\n"
+         << "  --history-samples N   per-field telemetry history depth (0 disables)\n"
+         << "  --pipeline            run receive, parse and control on separate threads\n"
+         << "  --pin A,B,C           pin the pipeline threads to these CPUs (-1 = unpinned)\n"
+         << "  --metrics SOCKET      serve Prometheus text on this Unix socket\n"
+         << "  --mission FILE        upload this QGC WPL 110 plan to every vehicle\n"
+         << "                        (default: download each vehicle's mission)\n"
+         << "  --param-cache DIR     keep each vehicle's parameters here; a reconnect\n"
+         << "                        with unchanged firmware and hash skips the download\n"
+         << "  --param NAME=VALUE    set on every vehicle before launch (repeatable)\n"
+         << "  --route SPEC          forward vehicle traffic to this GCS client, optionally\n"
+         << "                        only these sysids/msgids; its commands go back to the\n"
+         << "                        vehicles (repeatable)\n"
+         << "  --route-port PORT     local port for routed clients (default "
+         << ROUTER_DEFAULT_PORT << ")\n"
+         << "  --stream MSGID=HZ     ask every vehicle for this stream (0 turns it off);\n"
+         << "                        streams nobody asks for are turned off unless\n"
+         << "                        recording or routing (repeatable)\n"
+         << "  --io-uring            vehicle socket on io_uring: the kernel receives into\n"
+         << "                        pooled frame slabs (falls back to epoll)\n";
+}
 
-int main() {
+static bool parseParamAssignment(const char* arg, ParamAssignment& out) {
+    const char* eq = strchr(arg, '=');
+    if (!eq || eq == arg || eq - arg > static_cast<ptrdiff_t>(PARAM_ID_LEN))
+        return false;
 
-    UdpTransport udp;
-    TelemetryData telemetry;
-    StateManager stateManager;
-    CommandManager commandManager;
-    TelemetryParser parser(telemetry, stateManager);
+    char* end = nullptr;
+    out.value = strtod(eq + 1, &end);
+    if (end == eq + 1 || *end != '\0')
+        return false;
 
-    if (!udp.start(14550)) {
-        cerr << "Failed to start UDP transport\n";
-        return -1;
+    memcpy(out.id, arg, eq - arg);
+    out.id[eq - arg] = '\0';
+    return true;
+}
+
+static bool parseStreamRequest(const char* arg, StreamPlan& plan) {
+    char* end = nullptr;
+    unsigned long msgid = strtoul(arg, &end, 10);
+    if (end == arg || *end != '=')
+        return false;
+
+    const char* rate = end + 1;
+    float hz = strtof(rate, &end);
+    if (end == rate || *end != '\0')
+        return false;
+
+    return plan.request(StreamConsumer::USER, static_cast<uint32_t>(msgid), hz);
+}
+
+// Comma-separated ids after `key=`, each below `limit`
+static bool parseIdList(const char* list, unsigned long limit, vector<uint32_t>& out) {
+    for (;;) {
+        char* end = nullptr;
+        unsigned long id = strtoul(list, &end, 10);
+        if (end == list || id >= limit)
+            return false;
+        out.push_back(static_cast<uint32_t>(id));
+        if (*end == '\0' || *end == '/')
+            return true;
+        if (*end != ',')
+            return false;
+        list = end + 1;
     }
+}
 
-    // ---------------- GCS Heartbeat ----------------
-    GcsHeartbeat gcsHeartbeat(udp.getSocketFd());
-    auto last_hb = chrono::steady_clock::now();
-    auto last_failsafe_check = chrono::steady_clock::now();
+// HOST:PORT[/sysid=A,B][/msgid=X,Y]
+static bool parseRoute(const char* arg, RouteConfig& out) {
+    const char* colon = strchr(arg, ':');
+    if (!colon || colon == arg || colon - arg >= INET_ADDRSTRLEN)
+        return false;
 
-    cout << "[GCS] Heartbeat sender initialized\n";
+    char host[INET_ADDRSTRLEN] = {};
+    memcpy(host, arg, colon - arg);
 
-    // ---------------- Command sender ----------------
-    MavlinkCommandSender* cmdSender = nullptr;
-    bool sender_initialized = false;
+    char* end = nullptr;
+    unsigned long port = strtoul(colon + 1, &end, 10);
+    if (end == colon + 1 || port == 0 || port > 65535)
+        return false;
 
-    uint8_t buffer[2048];
+    out.dest.sin_family = AF_INET;
+    out.dest.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host, &out.dest.sin_addr) != 1)
+        return false;
 
-    // ---------------- Mission definition ----------------
-    static VehicleCommand mission[] = {
-        VehicleCommand::ARM,
-        VehicleCommand::SET_MODE_AUTO,
-        VehicleCommand::TAKEOFF
-    };
+    while (*end == '/') {
+        const char* filter = end + 1;
+        vector<uint32_t> ids;
 
-    static constexpr int MISSION_LEN =
-        sizeof(mission) / sizeof(mission[0]);
+        if (strncmp(filter, "sysid=", 6) == 0) {
+            if (!parseIdList(filter + 6, 256, ids))
+                return false;
+            for (uint32_t id : ids)
+                out.sysids.set(id);
+        } else if (strncmp(filter, "msgid=", 6) == 0) {
+            if (!parseIdList(filter + 6, 1u << 24, ids))
+                return false;
+            out.msgids.insert(out.msgids.end(), ids.begin(), ids.end());
+        } else {
+            return false;
+        }
 
-    static int mission_step = 0;
+        end = const_cast<char*>(strchr(filter, '/'));
+        if (!end)
+            return true;
+    }
 
-    // ================= MAIN LOOP =================
-    while (true) {
+    return *end == '\0';
+}
 
-        auto now = chrono::steady_clock::now();
+int main(int argc, char** argv) {
 
-        // ---------- Send GCS heartbeat ----------
-        if (chrono::duration_cast<chrono::seconds>(now - last_hb).count() >= 1) {
-            gcsHeartbeat.send();
-            last_hb = now;
+    string record_dir;
+    string metrics_path;
+    string mission_path;
+    HistoryConfig history;
+    ParamOptions params;
+    vector<RouteConfig> routes;
+    StreamPlan streams;
+    int route_port = ROUTER_DEFAULT_PORT;
+    bool pipelined = false;
+    PipelineConfig pipeline_config;
+    UdpBackend udp_backend = UdpBackend::EPOLL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_dir = argv[++i];
+        } else if (strcmp(argv[i], "--history-samples") == 0 && i + 1 < argc) {
+            history.capacity = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metrics_path = argv[++i];
+        } else if (strcmp(argv[i], "--mission") == 0 && i + 1 < argc) {
+            mission_path = argv[++i];
+        } else if (strcmp(argv[i], "--param-cache") == 0 && i + 1 < argc) {
+            params.cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--param") == 0 && i + 1 < argc) {
+            ParamAssignment a;
+            if (!parseParamAssignment(argv[++i], a)) {
+                usage(argv[0]);
+                return -1;
+            }
+            params.sets.push_back(a);
+        } else if (strcmp(argv[i], "--route") == 0 && i + 1 < argc) {
+            RouteConfig route;
+            if (!parseRoute(argv[++i], route)) {
+                usage(argv[0]);
+                return -1;
+            }
+            routes.push_back(route);
+        } else if (strcmp(argv[i], "--route-port") == 0 && i + 1 < argc) {
+            route_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            if (!parseStreamRequest(argv[++i], streams)) {
+                usage(argv[0]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--io-uring") == 0) {
+            udp_backend = UdpBackend::URING;
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            pipelined = true;
+        } else if (strcmp(argv[i], "--pin") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d,%d,%d",
+                       &pipeline_config.io_cpu,
+                       &pipeline_config.parse_cpu,
+                       &pipeline_config.control_cpu) != 3) {
+                usage(argv[0]);
+                return -1;
+            }
+        } else {
+            usage(argv[0]);
+            return -1;
         }
+    }
+
+    // SIGINT/SIGTERM arrive on a signalfd so shutdown runs in the loop
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &stop_signals, nullptr);
+    int sigfd = signalfd(-1, &stop_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    // Outlives everything that holds its slabs
+    FramePool frames;
+    UdpTransport udp;
+    EventLoop loop;
+    TlogRecorder recorder;
+    MetricsServer metrics;
+
+    if (!record_dir.empty() && !recorder.open(record_dir)) {
+        cerr << "Failed to open recorder in " << record_dir << "\n";
+        return -1;
+    }
+
+    // A tlog or a downstream GCS wants the vehicle's own streams too
+    if (recorder.isOpen())
+        streams.keepUnrequested(StreamConsumer::RECORDER);
+    if (!routes.empty())
+        streams.keepUnrequested(StreamConsumer::ROUTER);
+
+    MissionPlan plan;
+    if (!mission_path.empty() && !plan.load(mission_path)) {
+        cerr << "Failed to load mission " << mission_path << "\n";
+        return -1;
+    }
+    const MissionPlan* mission = mission_path.empty() ? nullptr : &plan;
 
-        // ---------- Receive MAVLink ----------
-        int len = udp.receive(buffer, sizeof(buffer));
-        if (len > 0) {
-            for (int i = 0; i < len; i++)
-                parser.parse(buffer[i]);
+    if (!params.cache_dir.empty() &&
+        mkdir(params.cache_dir.c_str(), 0755) < 0 && errno != EEXIST) {
+        perror("mkdir");
+        cerr << "Failed to create parameter cache " << params.cache_dir << "\n";
+        return -1;
+    }
+
+    if (!metrics_path.empty() && !metrics.start(metrics_path)) {
+        cerr << "Failed to serve metrics on " << metrics_path << "\n";
+        return -1;
+    }
+
+    // Near the thread that receives into it
+    const bool io_pinned = pipelined && pipeline_config.io_cpu >= 0;
+    const int rx_cpu = io_pinned ? pipeline_config.io_cpu : sched_getcpu();
+    if (!frames.init(FRAME_POOL_SLABS, rx_cpu >= 0 ? numaNodeOfCpu(rx_cpu) : -1)) {
+        cerr << "Failed to map frame pool\n";
+        return -1;
+    }
+
+    if (!udp.start(14550, frames, udp_backend)) {
+        cerr << "Failed to start UDP transport\n";
+        return -1;
+    }
+
+    MavlinkRouter router;
+    if (!routes.empty() && !router.start(route_port, udp.getSocketFd(), routes, frames)) {
+        cerr << "Failed to start router\n";
+        return -1;
+    }
+    MavlinkRouter* routing = routes.empty() ? nullptr : &router;
+
+    if (!loop.start()) {
+        cerr << "Failed to start event loop\n";
+        return -1;
+    }
+
+    auto onSignal = [&]() {
+        signalfd_siginfo info;
+        if (read(sigfd, &info, sizeof(info)) > 0) {
+            LOG_INFO("GCS", "Signal {}, shutting down", info.ssi_signo);
+            loop.stop();
         }
+    };
 
-        // ---------- Command lifecycle ----------
-        commandManager.update(telemetry, stateManager.getMutableState());
-
-        // ---------- Init command sender ----------
-        if (!sender_initialized && telemetry.heartbeat_received) {
-            cmdSender = new MavlinkCommandSender(
-                udp.getSocketFd(),
-                telemetry.system_id
-            );
-            commandManager.setCommandSender(cmdSender);
-            sender_initialized = true;
+    // ================= PIPELINE MODE =================
+    // Stages run on their own threads; this one only waits for a signal
+    if (pipelined) {
+        Pipeline pipeline(udp, recorder, history, mission, params, streams);
+        pipeline.setRouter(routing);
+        if (!pipeline.start(pipeline_config)) {
+            cerr << "Failed to start pipeline\n";
+            return -1;
         }
 
-        // ---------- FAILSAFE CHECK ----------
-        if (telemetry.heartbeat_received &&
-            chrono::duration_cast<chrono::milliseconds>(
-                now - last_failsafe_check).count() >= 200) {
+        loop.addReader(sigfd, onSignal);
+        loop.run();
 
-            last_failsafe_check = now;
+        pipeline.stop();
 
-            auto hb_elapsed =
-                chrono::duration_cast<chrono::milliseconds>(
-                    now - telemetry.last_heartbeat_time).count();
+        Pipeline::Stats s = pipeline.stats();
+        LOG_INFO("PIPE", "rx {} datagrams, max depth {}, stalls {}, ack wakeups {}",
+                 s.datagrams, s.rx_depth_max, s.slot_stalls, s.control_wakeups);
 
-            auto link_elapsed =
-                chrono::duration_cast<chrono::milliseconds>(
-                    now - telemetry.last_mavlink_rx_time).count();
+        recorder.close();
+        close(sigfd);
+        return 0;
+    }
 
-            if (hb_elapsed > HEARTBEAT_TIMEOUT_MS &&
-                link_elapsed > HEARTBEAT_TIMEOUT_MS &&
-                stateManager.getState() != SystemState::FAILSAFE) {
+    GroundStation gcs(udp.txQueue(), history, mission, params, streams);
+    gcs.setRouter(routing);
 
-                stateManager.setState(SystemState::FAILSAFE);
-                cout << "[FAILSAFE] MAVLink timeout\n";
+    const bool uring = udp.backend() == UdpBackend::URING;
+    if (uring && !udp.startRing()) {
+        cerr << "Failed to start io_uring receive\n";
+        return -1;
+    }
+
+    // ---------- Receive MAVLink ----------
+    loop.addReader(udp.getReceiveFd(), [&]() {
+        FrameSlab* slabs[RX_BATCH_SIZE];
+        int n;
+        while ((n = udp.receive(slabs, RX_BATCH_SIZE)) > 0) {
+            for (int i = 0; i < n; i++) {
+                if (recorder.isOpen())
+                    recorder.record(slabs[i]->dgram);
+
+                gcs.ingest(*slabs[i]);
             }
+
+            if (routing)
+                routing->flush();
+
+            // What the router still queues it holds a reference to
+            for (int i = 0; i < n; i++)
+                slabs[i]->release();
+
+            // A short batch means the socket is drained, unless the
+            // ring ran dry and wants the slabs just released
+            if (n < RX_BATCH_SIZE && !udp.starved())
+                break;
         }
 
-        // ---------- Mission execution ----------
-        if (!cmdSender ||
-            !telemetry.isTelemetryReady() ||
-            commandManager.hasActiveCommand() ||
-            mission_step >= MISSION_LEN)
-            continue;
+        // React to ACKs without waiting for the next tick
+        gcs.publishSnapshots();
+        gcs.runCommands();
+    });
 
-        if (commandManager.requestCommand(
-                mission[mission_step],
-                stateManager.getState(),
-                telemetry)) {
+    // ---------- Router clients -> vehicles ----------
+    if (routing)
+        loop.addReader(router.getSocketFd(), [&]() { router.receiveUpstream(); });
 
-            cout << "[MISSION] Step "
-                 << mission_step
-                 << " issued\n";
+    // ---------- Heartbeat, command retries, mission, failsafe ----------
+    // One clock read per tick; the wheel fires whatever is due. The
+    // timer is one-shot at the wheel's next deadline, so an idle GCS
+    // sleeps until something is actually due.
+    GcsClock::time_point tick_deadline = GcsClock::time_point::max();
+    const int tick_fd = loop.addTimer(0, [&]() {
+        tick_deadline = GcsClock::time_point::max();
+        gcs.tick(GcsClock::now());
+    });
 
-            mission_step++;
-        }
+    // Ticks and commands both (re)schedule timers. Sends a socket
+    // refused get another go a tick later even if nothing else is due.
+    auto armTick = [&]() {
+        GcsClock::time_point next = gcs.nextDeadline();
+        if (udp.txQueue().pending() != 0 || (routing && routing->backlogged()))
+            next = min(next, GcsClock::now() + chrono::milliseconds(TIMER_WHEEL_TICK_MS));
+
+        if (next != tick_deadline && loop.armTimer(tick_fd, next))
+            tick_deadline = next;
+    };
+
+    // ---------- Recorder writeback ----------
+    if (recorder.isOpen()) {
+        loop.addTimer(TLOG_FLUSH_PERIOD_MS, [&]() {
+            recorder.flush();
+        });
     }
 
+    // ---------- Clean shutdown (trims the open log segment) ----------
+    loop.addReader(sigfd, onSignal);
+
+    // ---------- Flush queued TX, publish snapshots ----------
+    loop.setPostDispatch([&]() {
+        udp.txQueue().flush();
+        if (routing && routing->backlogged())
+            routing->flush();
+        gcs.publishSnapshots();
+        armTick();
+    });
+
+    gcs.sendHeartbeat();
+    armTick();
+
+    // ================= MAIN LOOP =================
+    loop.run();
+
+    gcs.logCommandLatency();
+
+    recorder.close();
+    close(sigfd);
+
     return 0;
 }
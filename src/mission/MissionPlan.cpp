@@ -0,0 +1,121 @@
+#include "mission/MissionPlan.h"
+#include "core/Logger.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// x/y carry degrees * 1e7 in global frames and plain values elsewhere
+static bool isGlobalFrame(int frame) {
+    switch (frame) {
+    case MAV_FRAME_GLOBAL:
+    case MAV_FRAME_GLOBAL_RELATIVE_ALT:
+    case MAV_FRAME_GLOBAL_INT:
+    case MAV_FRAME_GLOBAL_RELATIVE_ALT_INT:
+    case MAV_FRAME_GLOBAL_TERRAIN_ALT:
+    case MAV_FRAME_GLOBAL_TERRAIN_ALT_INT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool MissionPlan::load(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "r");
+    if (!f) {
+        LOG_ERROR("MISSION", "open {}: {}", path.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    std::vector<mavlink_mission_item_int_t> items;
+    char line[512];
+    int line_no = 0;
+    bool ok = true;
+
+    while (std::fgets(line, sizeof(line), f)) {
+        line_no++;
+
+        if (line_no == 1) {
+            if (std::strncmp(line, "QGC WPL 110", 11) != 0) {
+                LOG_ERROR("MISSION", "{}: not a QGC WPL 110 file", path.c_str());
+                ok = false;
+                break;
+            }
+            continue;
+        }
+
+        int seq, current, frame, command, autocontinue;
+        double p1, p2, p3, p4, x, y, z;
+        const int n = std::sscanf(line, "%d %d %d %d %lf %lf %lf %lf %lf %lf %lf %d",
+                                  &seq, &current, &frame, &command,
+                                  &p1, &p2, &p3, &p4, &x, &y, &z, &autocontinue);
+        if (n <= 0)
+            continue;       // blank line
+
+        if (n != 12 || seq != static_cast<int>(items.size())) {
+            LOG_ERROR("MISSION", "{}:{}: malformed or out-of-order item",
+                      path.c_str(), line_no);
+            ok = false;
+            break;
+        }
+
+        mavlink_mission_item_int_t item{};
+        item.seq = static_cast<uint16_t>(seq);
+        item.current = static_cast<uint8_t>(current);
+        item.frame = static_cast<uint8_t>(frame);
+        item.command = static_cast<uint16_t>(command);
+        item.param1 = static_cast<float>(p1);
+        item.param2 = static_cast<float>(p2);
+        item.param3 = static_cast<float>(p3);
+        item.param4 = static_cast<float>(p4);
+        item.z = static_cast<float>(z);
+        item.autocontinue = static_cast<uint8_t>(autocontinue);
+
+        const double scale = isGlobalFrame(frame) ? 1e7 : 1.0;
+        item.x = static_cast<int32_t>(std::lround(x * scale));
+        item.y = static_cast<int32_t>(std::lround(y * scale));
+
+        items.push_back(item);
+    }
+
+    std::fclose(f);
+
+    if (!ok)
+        return false;
+
+    items_ = std::move(items);
+    LOG_INFO("MISSION", "Loaded {} items from {}", items_.size(), path.c_str());
+    return true;
+}
+
+void MissionPlan::add(const mavlink_mission_item_int_t& item) {
+    items_.push_back(item);
+    items_.back().seq = static_cast<uint16_t>(items_.size() - 1);
+}
+
+MissionPlan MissionPlan::survey(size_t waypoints, int32_t lat, int32_t lon, float alt_m) {
+    constexpr size_t PER_ROW = 20;
+    constexpr int32_t SPACING = 1800;       // ~20 m in 1e7 degrees
+
+    MissionPlan plan;
+    plan.items_.reserve(waypoints);
+
+    for (size_t i = 0; i < waypoints; i++) {
+        const size_t row = i / PER_ROW;
+        size_t col = i % PER_ROW;
+        if (row & 1)
+            col = PER_ROW - 1 - col;       // boustrophedon
+
+        mavlink_mission_item_int_t item{};
+        item.frame = MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+        item.command = MAV_CMD_NAV_WAYPOINT;
+        item.autocontinue = 1;
+        item.x = lat + static_cast<int32_t>(row) * SPACING;
+        item.y = lon + static_cast<int32_t>(col) * SPACING;
+        item.z = alt_m;
+        plan.add(item);
+    }
+
+    return plan;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+// -------------------------------------------------
+// A mission as a list of MISSION_ITEM_INT payloads in
+// sequence order. Target ids are left zero; every
+// upload fills in its own vehicle when it encodes.
+// -------------------------------------------------
+class MissionPlan {
+public:
+    // QGC WPL 110 text, one item per line:
+    //   seq current frame command p1 p2 p3 p4 x y z autocontinue
+    // Line 0 (home) is uploaded like any other item.
+    bool load(const std::string& path);
+
+    // Appends item with the next sequence number
+    void add(const mavlink_mission_item_int_t& item);
+
+    // Lawnmower pattern of `waypoints` items around lat/lon (1e7 deg),
+    // for load tests and the simulator's onboard mission
+    static MissionPlan survey(size_t waypoints, int32_t lat, int32_t lon, float alt_m);
+
+    size_t size() const { return items_.size(); }
+    bool empty() const { return items_.empty(); }
+    const mavlink_mission_item_int_t& operator[](size_t seq) const { return items_[seq]; }
+
+private:
+    std::vector<mavlink_mission_item_int_t> items_;
+};
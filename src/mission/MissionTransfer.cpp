@@ -0,0 +1,416 @@
+#include "mission/MissionTransfer.h"
+#include "mission/MissionPlan.h"
+#include "comm/GcsIdentity.h"
+#include "comm/TxQueue.h"
+#include "core/Logger.h"
+#include "core/Metrics.h"
+
+#include <chrono>
+
+using namespace std;
+
+static constexpr chrono::milliseconds MISSION_ITEM_TIMEOUT{MISSION_ITEM_TIMEOUT_MS};
+
+// TX arena full: try again on the next wheel tick
+static constexpr chrono::milliseconds TX_FULL_RETRY{TIMER_WHEEL_TICK_MS};
+
+double MissionTransfer::Stats::seconds() const {
+    return chrono::duration<double>(finished - started).count();
+}
+
+double MissionTransfer::Stats::itemsPerSecond() const {
+    const double s = seconds();
+    return s > 0 ? items / s : 0;
+}
+
+const char* missionStateName(MissionTransfer::State state) {
+    switch (state) {
+    case MissionTransfer::State::IDLE:        return "IDLE";
+    case MissionTransfer::State::UPLOADING:   return "UPLOADING";
+    case MissionTransfer::State::DOWNLOADING: return "DOWNLOADING";
+    case MissionTransfer::State::DONE:        return "DONE";
+    case MissionTransfer::State::FAILED:      return "FAILED";
+    }
+    return "UNKNOWN";
+}
+
+MissionTransfer::MissionTransfer(
+    TxQueue& tx,
+    uint8_t target_sys,
+    const sockaddr_in& vehicle_addr)
+    : txQueue(tx),
+      target_sysid(target_sys),
+      px4_addr(vehicle_addr) {
+
+    handshake_timer_.fn = onHandshakeTimer;
+    handshake_timer_.owner = this;
+
+    for (size_t i = 0; i < MISSION_DOWNLOAD_WINDOW; i++) {
+        slot_timers_[i].fn = onSlotTimer;
+        slot_timers_[i].owner = this;
+        slot_timers_[i].tag = static_cast<uint32_t>(i);
+    }
+}
+
+void MissionTransfer::arm(TimerNode& timer, GcsClock::duration delay) {
+    if (wheel_)
+        wheel_->schedule(timer, delay);
+}
+
+// ---------------- Wire ----------------
+bool MissionTransfer::sendFrame(const mavlink_message_t& msg) {
+    return txQueue.enqueue(txQueue.pushFrame(msg), px4_addr);
+}
+
+bool MissionTransfer::sendCount() {
+    mavlink_mission_count_t count{};
+    count.count = static_cast<uint16_t>(offsets_.size() - 1);
+    count.target_system = target_sysid;
+    count.target_component = MAV_COMP_ID_AUTOPILOT1;
+    count.mission_type = MAV_MISSION_TYPE_MISSION;
+
+    mavlink_message_t msg;
+    mavlink_msg_mission_count_encode(GCS_COMMAND_SYS_ID, GCS_COMP_ID, &msg, &count);
+    return sendFrame(msg);
+}
+
+bool MissionTransfer::sendRequestList() {
+    mavlink_mission_request_list_t req{};
+    req.target_system = target_sysid;
+    req.target_component = MAV_COMP_ID_AUTOPILOT1;
+    req.mission_type = MAV_MISSION_TYPE_MISSION;
+
+    mavlink_message_t msg;
+    mavlink_msg_mission_request_list_encode(GCS_COMMAND_SYS_ID, GCS_COMP_ID, &msg, &req);
+    return sendFrame(msg);
+}
+
+bool MissionTransfer::sendRequest(uint16_t seq) {
+    mavlink_mission_request_int_t req{};
+    req.seq = seq;
+    req.target_system = target_sysid;
+    req.target_component = MAV_COMP_ID_AUTOPILOT1;
+    req.mission_type = MAV_MISSION_TYPE_MISSION;
+
+    mavlink_message_t msg;
+    mavlink_msg_mission_request_int_encode(GCS_COMMAND_SYS_ID, GCS_COMP_ID, &msg, &req);
+    return sendFrame(msg);
+}
+
+bool MissionTransfer::sendAck(uint8_t result) {
+    mavlink_mission_ack_t ack{};
+    ack.target_system = target_sysid;
+    ack.target_component = MAV_COMP_ID_AUTOPILOT1;
+    ack.type = result;
+    ack.mission_type = MAV_MISSION_TYPE_MISSION;
+
+    mavlink_message_t msg;
+    mavlink_msg_mission_ack_encode(GCS_COMMAND_SYS_ID, GCS_COMP_ID, &msg, &ack);
+    return sendFrame(msg);
+}
+
+// ---------------- Upload ----------------
+void MissionTransfer::encodeItems(const MissionPlan& plan) {
+    const size_t n = plan.size();
+
+    cache_.clear();
+    cache_.reserve(n * (sizeof(mavlink_mission_item_int_t) + MAVLINK_NUM_NON_PAYLOAD_BYTES));
+    offsets_.assign(1, 0);
+    offsets_.reserve(n + 1);
+
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+
+    for (size_t seq = 0; seq < n; seq++) {
+        mavlink_mission_item_int_t item = plan[seq];
+        item.seq = static_cast<uint16_t>(seq);
+        item.target_system = target_sysid;
+        item.target_component = MAV_COMP_ID_AUTOPILOT1;
+        item.mission_type = MAV_MISSION_TYPE_MISSION;
+
+        mavlink_message_t msg;
+        mavlink_msg_mission_item_int_encode(GCS_COMMAND_SYS_ID, GCS_COMP_ID, &msg, &item);
+
+        const uint16_t len = mavlink_msg_to_send_buffer(buf, &msg);
+        cache_.insert(cache_.end(), buf, buf + len);
+        offsets_.push_back(static_cast<uint32_t>(cache_.size()));
+    }
+}
+
+bool MissionTransfer::startUpload(const MissionPlan& plan) {
+    if (busy() || plan.size() > UINT16_MAX)
+        return false;
+
+    encodeItems(plan);
+    served_.assign(plan.size(), 0);
+    last_requested_ = -1;
+    handshake_tries_ = 0;
+
+    stats_ = Stats{};
+    stats_.upload = true;
+    stats_.started = GcsClock::now();
+    state_ = State::UPLOADING;
+
+    sendCount();
+    arm(handshake_timer_, MISSION_ITEM_TIMEOUT);
+
+    LOG_INFO("MISSION", "SysID {} upload of {} items started", target_sysid, plan.size());
+    return true;
+}
+
+// Frames keep the MAVLink sequence number they were encoded with
+bool MissionTransfer::serveItem(uint16_t seq) {
+    const uint32_t begin = offsets_[seq];
+    const int frame = txQueue.pushEncoded(&cache_[begin], offsets_[seq + 1] - begin);
+    return txQueue.enqueue(frame, px4_addr);
+}
+
+void MissionTransfer::onRequest(uint16_t seq) {
+    if (seq >= offsets_.size() - 1) {
+        LOG_WARN("MISSION", "SysID {} requested item {} of {}",
+                 target_sysid, seq, offsets_.size() - 1);
+        return;
+    }
+
+    last_requested_ = seq;
+    handshake_tries_ = 0;
+
+    if (!serveItem(seq)) {
+        arm(handshake_timer_, TX_FULL_RETRY);
+        return;
+    }
+    arm(handshake_timer_, MISSION_ITEM_TIMEOUT);
+
+    MetricsShard& m = Metrics::local();
+    if (served_[seq]) {
+        stats_.resends++;
+        m.add(Counter::MISSION_RESENDS);
+    } else {
+        served_[seq] = 1;
+        stats_.items++;
+        m.add(Counter::MISSION_ITEMS_SENT);
+    }
+}
+
+// ---------------- Download ----------------
+bool MissionTransfer::startDownload() {
+    if (busy())
+        return false;
+
+    items_.clear();
+    received_.clear();
+    count_known_ = false;
+    count_ = 0;
+    next_request_ = 0;
+    received_count_ = 0;
+    handshake_tries_ = 0;
+    for (Slot& s : slots_)
+        s = Slot{};
+
+    stats_ = Stats{};
+    stats_.started = GcsClock::now();
+    state_ = State::DOWNLOADING;
+
+    sendRequestList();
+    arm(handshake_timer_, MISSION_ITEM_TIMEOUT);
+    return true;
+}
+
+void MissionTransfer::onCount(uint16_t count) {
+    if (count_known_)
+        return;     // answer to a resent REQUEST_LIST
+
+    if (wheel_)
+        wheel_->cancel(handshake_timer_);
+
+    count_known_ = true;
+    count_ = count;
+    items_.assign(count, mavlink_mission_item_int_t{});
+    received_.assign(count, 0);
+
+    if (count == 0) {
+        sendAck(MAV_MISSION_ACCEPTED);
+        finish(MAV_MISSION_ACCEPTED);
+        return;
+    }
+
+    refillWindow();
+}
+
+void MissionTransfer::onItem(const mavlink_mission_item_int_t& item) {
+    const uint16_t seq = item.seq;
+    if (!count_known_ || seq >= count_ || received_[seq])
+        return;     // late duplicate of a re-requested item
+
+    items_[seq] = item;
+    received_[seq] = 1;
+    received_count_++;
+    stats_.items++;
+    Metrics::local().add(Counter::MISSION_ITEMS_RECEIVED);
+
+    for (size_t i = 0; i < MISSION_DOWNLOAD_WINDOW; i++) {
+        if (slots_[i].used && slots_[i].seq == seq) {
+            slots_[i].used = false;
+            if (wheel_)
+                wheel_->cancel(slot_timers_[i]);
+            break;
+        }
+    }
+
+    if (received_count_ == count_) {
+        sendAck(MAV_MISSION_ACCEPTED);
+        finish(MAV_MISSION_ACCEPTED);
+        return;
+    }
+
+    refillWindow();
+}
+
+void MissionTransfer::refillWindow() {
+    bool any_in_flight = false;
+
+    for (size_t i = 0; i < MISSION_DOWNLOAD_WINDOW; i++) {
+        Slot& s = slots_[i];
+
+        while (!s.used && next_request_ < count_) {
+            const uint16_t seq = next_request_;
+            if (received_[seq]) {
+                next_request_++;
+                continue;
+            }
+            if (txQueue.framesFree() == 0 || !sendRequest(seq))
+                break;
+
+            next_request_++;
+            s.seq = seq;
+            s.tries = 0;
+            s.used = true;
+            arm(slot_timers_[i], MISSION_ITEM_TIMEOUT);
+        }
+
+        any_in_flight |= s.used;
+    }
+
+    // Nothing in flight and items left: the TX arena was full
+    if (!any_in_flight && next_request_ < count_)
+        arm(handshake_timer_, TX_FULL_RETRY);
+}
+
+void MissionTransfer::onSlotTimeout(size_t slot) {
+    Slot& s = slots_[slot];
+    if (!s.used || state_ != State::DOWNLOADING)
+        return;
+
+    if (s.tries >= MISSION_MAX_RETRIES) {
+        LOG_WARN("MISSION", "SysID {} item {} never arrived", target_sysid, s.seq);
+        sendAck(MAV_MISSION_OPERATION_CANCELLED);
+        finish(MAV_MISSION_OPERATION_CANCELLED);
+        return;
+    }
+
+    if (txQueue.framesFree() == 0 || !sendRequest(s.seq)) {
+        arm(slot_timers_[slot], TX_FULL_RETRY);
+        return;
+    }
+
+    s.tries++;
+    stats_.resends++;
+    Metrics::local().add(Counter::MISSION_RESENDS);
+    arm(slot_timers_[slot], MISSION_ITEM_TIMEOUT);
+}
+
+// ---------------- Timers ----------------
+void MissionTransfer::onHandshakeTimer(void* self, uint32_t) {
+    static_cast<MissionTransfer*>(self)->onHandshakeTimeout();
+}
+
+void MissionTransfer::onSlotTimer(void* self, uint32_t slot) {
+    static_cast<MissionTransfer*>(self)->onSlotTimeout(slot);
+}
+
+void MissionTransfer::onHandshakeTimeout() {
+    if (state_ == State::DOWNLOADING && count_known_) {
+        refillWindow();
+        return;
+    }
+
+    if (!busy())
+        return;
+
+    if (handshake_tries_ >= MISSION_MAX_RETRIES) {
+        LOG_WARN("MISSION", "SysID {} {} timed out", target_sysid,
+                 stats_.upload ? "upload" : "download");
+        finish(MAV_MISSION_OPERATION_CANCELLED);
+        return;
+    }
+
+    handshake_tries_++;
+    stats_.resends++;
+    Metrics::local().add(Counter::MISSION_RESENDS);
+
+    // Resend whatever the vehicle should have answered by now
+    if (state_ == State::DOWNLOADING)
+        sendRequestList();
+    else if (last_requested_ < 0)
+        sendCount();
+    else
+        serveItem(static_cast<uint16_t>(last_requested_));
+
+    arm(handshake_timer_, MISSION_ITEM_TIMEOUT);
+}
+
+// -------------------------------------------------
+void MissionTransfer::update(MissionEventQueue& events) {
+    MissionEvent ev;
+    while (events.pop(ev)) {
+        switch (ev.type) {
+        case MissionEventType::REQUEST:
+            if (state_ == State::UPLOADING)
+                onRequest(ev.value);
+            break;
+
+        case MissionEventType::COUNT:
+            if (state_ == State::DOWNLOADING)
+                onCount(ev.value);
+            break;
+
+        case MissionEventType::ITEM:
+            if (state_ == State::DOWNLOADING)
+                onItem(ev.item);
+            break;
+
+        case MissionEventType::ACK:
+            // A download ends with our ACK; the vehicle only sends
+            // one there to abort
+            if (busy())
+                finish(static_cast<uint8_t>(ev.value));
+            break;
+        }
+    }
+}
+
+void MissionTransfer::finish(uint8_t result) {
+    if (wheel_) {
+        wheel_->cancel(handshake_timer_);
+        for (TimerNode& t : slot_timers_)
+            wheel_->cancel(t);
+    }
+
+    stats_.result = result;
+    stats_.finished = GcsClock::now();
+    state_ = (result == MAV_MISSION_ACCEPTED) ? State::DONE : State::FAILED;
+
+    // Upload frames are only needed until the vehicle accepts them
+    cache_.clear();
+    cache_.shrink_to_fit();
+
+    const char* dir = stats_.upload ? "upload" : "download";
+    if (state_ == State::DONE) {
+        LOG_INFO("MISSION", "SysID {} {}: {} items in {} ms, {} items/s, {} resends",
+                 target_sysid, dir, stats_.items,
+                 static_cast<uint64_t>(stats_.seconds() * 1000),
+                 static_cast<uint64_t>(stats_.itemsPerSecond()), stats_.resends);
+    } else {
+        LOG_WARN("MISSION", "SysID {} {} failed (result {}) after {} items",
+                 target_sysid, dir, result, stats_.items);
+    }
+}
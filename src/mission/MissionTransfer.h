@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <netinet/in.h>
+#include <vector>
+
+#include "core/GcsClock.h"
+#include "core/TimerWheel.h"
+#include "telemetry/TelemetryData.h"
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+class MissionPlan;
+class TxQueue;
+
+static constexpr int MISSION_ITEM_TIMEOUT_MS = 250;
+static constexpr int MISSION_MAX_RETRIES = 5;
+
+// Item requests in flight per download
+static constexpr size_t MISSION_DOWNLOAD_WINDOW = 16;
+static_assert(MISSION_DOWNLOAD_WINDOW < MISSION_EVENT_QUEUE_DEPTH,
+              "a full window of items must fit the event queue");
+
+// -------------------------------------------------
+// Mission upload/download for one vehicle; control
+// side only.
+//
+// Upload: every item is encoded for this vehicle when
+// the transfer starts, so a MISSION_REQUEST is answered
+// by copying cached bytes. The vehicle paces an upload,
+// and a silent vehicle is sent the frame it last asked
+// for again.
+//
+// Download: up to MISSION_DOWNLOAD_WINDOW item requests
+// are in flight, each on its own timer, so a lost item
+// is re-requested alone while the rest keep flowing.
+// -------------------------------------------------
+class MissionTransfer {
+public:
+    enum class State : uint8_t {
+        IDLE,
+        UPLOADING,
+        DOWNLOADING,
+        DONE,
+        FAILED
+    };
+
+    struct Stats {
+        bool upload = false;
+        uint32_t items = 0;           // distinct items moved
+        uint32_t resends = 0;         // frames sent again, either side's doing
+        uint8_t result = MAV_MISSION_ACCEPTED;
+        GcsClock::time_point started{};
+        GcsClock::time_point finished{};
+
+        double seconds() const;
+        double itemsPerSecond() const;
+    };
+
+    MissionTransfer(TxQueue& tx, uint8_t target_sys, const sockaddr_in& vehicle_addr);
+
+    // Timers point back at this instance
+    MissionTransfer(const MissionTransfer&) = delete;
+    MissionTransfer& operator=(const MissionTransfer&) = delete;
+
+    // Must be the wheel of the thread calling update()
+    void setTimerWheel(TimerWheel* wheel) { wheel_ = wheel; }
+
+    // Refused while another transfer is running
+    bool startUpload(const MissionPlan& plan);
+    bool startDownload();
+
+    // Drains the vehicle's mission events; resends run off the wheel
+    void update(MissionEventQueue& events);
+
+    State state() const { return state_; }
+    bool busy() const { return state_ == State::UPLOADING || state_ == State::DOWNLOADING; }
+    const Stats& stats() const { return stats_; }
+
+    // Items of the last finished download, in sequence order
+    const std::vector<mavlink_mission_item_int_t>& downloaded() const { return items_; }
+
+private:
+    struct Slot {
+        uint16_t seq = 0;
+        uint8_t tries = 0;
+        bool used = false;
+    };
+
+    void arm(TimerNode& timer, GcsClock::duration delay);
+
+    // ---------- Upload ----------
+    void encodeItems(const MissionPlan& plan);
+    bool serveItem(uint16_t seq);
+    void onRequest(uint16_t seq);
+
+    // ---------- Download ----------
+    void onCount(uint16_t count);
+    void onItem(const mavlink_mission_item_int_t& item);
+    void refillWindow();
+    void onSlotTimeout(size_t slot);
+
+    // ---------- Wire ----------
+    bool sendFrame(const mavlink_message_t& msg);
+    bool sendCount();
+    bool sendRequestList();
+    bool sendRequest(uint16_t seq);
+    bool sendAck(uint8_t result);
+
+    static void onHandshakeTimer(void* self, uint32_t);
+    static void onSlotTimer(void* self, uint32_t slot);
+    void onHandshakeTimeout();
+
+    void finish(uint8_t result);
+
+    TxQueue& txQueue;
+    uint8_t target_sysid;
+    sockaddr_in px4_addr;
+    TimerWheel* wheel_ = nullptr;
+
+    State state_ = State::IDLE;
+    Stats stats_;
+
+    // COUNT / REQUEST_LIST / last served item, and the TX-full kick
+    TimerNode handshake_timer_;
+    int handshake_tries_ = 0;
+
+    // ---- Upload ----
+    std::vector<uint8_t> cache_;            // encoded MISSION_ITEM_INT frames
+    std::vector<uint32_t> offsets_;         // frame seq spans [seq, seq + 1)
+    std::vector<uint8_t> served_;
+    int last_requested_ = -1;
+
+    // ---- Download ----
+    std::vector<mavlink_mission_item_int_t> items_;
+    std::vector<uint8_t> received_;
+    bool count_known_ = false;
+    uint16_t count_ = 0;
+    uint16_t next_request_ = 0;
+    uint16_t received_count_ = 0;
+    Slot slots_[MISSION_DOWNLOAD_WINDOW];
+    TimerNode slot_timers_[MISSION_DOWNLOAD_WINDOW];
+};
+
+const char* missionStateName(MissionTransfer::State state);
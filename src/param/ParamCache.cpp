@@ -0,0 +1,149 @@
+#include "param/ParamCache.h"
+#include "core/Logger.h"
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// ---------------- Bytewise encoding ----------------
+// The integer sits in the low bytes of the float's storage,
+// upper bytes zero (MAV_PROTOCOL_CAPABILITY_PARAM_ENCODE_BYTEWISE)
+bool paramIsInteger(uint8_t type) {
+    return type >= MAV_PARAM_TYPE_UINT8 && type <= MAV_PARAM_TYPE_INT32;
+}
+
+float paramFromInt(int64_t v, uint8_t type) {
+    uint32_t bits = 0;
+    switch (type) {
+    case MAV_PARAM_TYPE_UINT8:
+    case MAV_PARAM_TYPE_INT8:   bits = static_cast<uint8_t>(v);  break;
+    case MAV_PARAM_TYPE_UINT16:
+    case MAV_PARAM_TYPE_INT16:  bits = static_cast<uint16_t>(v); break;
+    default:                    bits = static_cast<uint32_t>(v); break;
+    }
+
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+int64_t paramToInt(float value, uint8_t type) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    switch (type) {
+    case MAV_PARAM_TYPE_UINT8:  return static_cast<uint8_t>(bits);
+    case MAV_PARAM_TYPE_INT8:   return static_cast<int8_t>(bits);
+    case MAV_PARAM_TYPE_UINT16: return static_cast<uint16_t>(bits);
+    case MAV_PARAM_TYPE_INT16:  return static_cast<int16_t>(bits);
+    case MAV_PARAM_TYPE_UINT32: return bits;
+    default:                    return static_cast<int32_t>(bits);
+    }
+}
+
+// -------------------------------------------------
+ParamCache::ParamCache(std::string dir)
+    : dir_(std::move(dir)) {}
+
+std::string ParamCache::pathFor(uint8_t sysid, uint64_t uid) const {
+    char name[48];
+    if (uid)
+        std::snprintf(name, sizeof(name), "/uid_%016" PRIx64 ".params", uid);
+    else
+        std::snprintf(name, sizeof(name), "/sysid_%u.params", unsigned(sysid));
+    return dir_ + name;
+}
+
+bool ParamCache::load(
+    uint8_t sysid,
+    const ParamCacheKey& key,
+    std::vector<VehicleParam>& out) const {
+
+    if (!enabled())
+        return false;
+
+    const std::string path = pathFor(sysid, key.uid);
+    FILE* f = std::fopen(path.c_str(), "r");
+    if (!f)
+        return false;       // first contact
+
+    char line[128];
+    uint64_t uid = 0;
+    unsigned firmware = 0, hash = 0;
+
+    if (!std::fgets(line, sizeof(line), f) ||
+        std::sscanf(line, "# key %" SCNx64 " %x %x", &uid, &firmware, &hash) != 3 ||
+        uid != key.uid || firmware != key.firmware || hash != key.hash) {
+        std::fclose(f);
+        return false;
+    }
+
+    std::vector<VehicleParam> params;
+    bool ok = true;
+
+    while (std::fgets(line, sizeof(line), f)) {
+        VehicleParam p;
+        unsigned type;
+        char value[48];
+
+        if (std::sscanf(line, "%16s %u %47s", p.id, &type, value) != 3) {
+            ok = false;
+            break;
+        }
+
+        p.type = static_cast<uint8_t>(type);
+        p.value = paramIsInteger(p.type)
+            ? paramFromInt(std::strtoll(value, nullptr, 10), p.type)
+            : std::strtof(value, nullptr);
+        params.push_back(p);
+    }
+
+    std::fclose(f);
+
+    if (!ok || params.empty()) {
+        LOG_WARN("PARAM", "{}: unreadable, ignored", path.c_str());
+        return false;
+    }
+
+    out = std::move(params);
+    return true;
+}
+
+bool ParamCache::save(
+    uint8_t sysid,
+    const ParamCacheKey& key,
+    const std::vector<VehicleParam>& params) const {
+
+    if (!enabled())
+        return false;
+
+    const std::string path = pathFor(sysid, key.uid);
+    const std::string tmp = path + ".tmp";
+
+    FILE* f = std::fopen(tmp.c_str(), "w");
+    if (!f) {
+        LOG_ERROR("PARAM", "open {}: {}", tmp.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    std::fprintf(f, "# key %016" PRIx64 " %08x %08x\n",
+                 key.uid, unsigned(key.firmware), unsigned(key.hash));
+
+    for (const VehicleParam& p : params) {
+        if (paramIsInteger(p.type))
+            std::fprintf(f, "%s %u %" PRId64 "\n", p.id, unsigned(p.type),
+                         paramToInt(p.value, p.type));
+        else
+            std::fprintf(f, "%s %u %.9g\n", p.id, unsigned(p.type), double(p.value));
+    }
+
+    const bool ok = std::fclose(f) == 0;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("PARAM", "write {}: {}", path.c_str(), std::strerror(errno));
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
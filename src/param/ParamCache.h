@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+// Wire ids are 16 chars without a terminator when full
+static constexpr size_t PARAM_ID_LEN = 16;
+
+struct VehicleParam {
+    char id[PARAM_ID_LEN + 1] = {};
+    float value = 0;        // as on the wire: PX4 packs integers bytewise
+    uint8_t type = MAV_PARAM_TYPE_REAL32;
+};
+
+// What a cached parameter set is valid for. PX4 reports the hash
+// of its parameter values as the `_HASH_CHECK` parameter.
+struct ParamCacheKey {
+    uint64_t uid = 0;           // AUTOPILOT_VERSION, 0 when unknown
+    uint32_t firmware = 0;      // flight_sw_version, 0 when unknown
+    uint32_t hash = 0;
+};
+
+// Bytewise encoding of an integer parameter, and back
+float paramFromInt(int64_t v, uint8_t type);
+int64_t paramToInt(float value, uint8_t type);
+bool paramIsInteger(uint8_t type);
+
+// -------------------------------------------------
+// One text file per vehicle, named after its UID (its
+// sysid when it has none):
+//   # key <uid> <firmware> <hash>
+//   <id> <type> <value>
+// Values are decoded, so the files diff and edit like
+// any parameter dump. Shared by every vehicle; reads
+// and writes happen once per connect, off the hot path.
+// -------------------------------------------------
+class ParamCache {
+public:
+    // Empty dir: caching off, every vehicle downloads
+    explicit ParamCache(std::string dir = {});
+
+    bool enabled() const { return !dir_.empty(); }
+
+    // False on a missing file or a key mismatch
+    bool load(uint8_t sysid, const ParamCacheKey& key,
+              std::vector<VehicleParam>& out) const;
+
+    // Written to a temp file and renamed into place
+    bool save(uint8_t sysid, const ParamCacheKey& key,
+              const std::vector<VehicleParam>& params) const;
+
+private:
+    std::string pathFor(uint8_t sysid, uint64_t uid) const;
+
+    std::string dir_;
+};
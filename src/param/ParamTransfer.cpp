@@ -0,0 +1,574 @@
+#include "param/ParamTransfer.h"
+#include "comm/GcsIdentity.h"
+#include "comm/TxQueue.h"
+#include "core/Logger.h"
+#include "core/Metrics.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+static constexpr chrono::milliseconds PARAM_TIMEOUT{PARAM_TIMEOUT_MS};
+static constexpr chrono::milliseconds PARAM_STREAM_IDLE{PARAM_STREAM_IDLE_MS};
+
+// TX arena full: try again on the next wheel tick
+static constexpr chrono::milliseconds TX_FULL_RETRY{TIMER_WHEEL_TICK_MS};
+
+static constexpr char HASH_CHECK_ID[] = "_HASH_CHECK";
+
+static bool isHashCheck(const mavlink_param_value_t& pv) {
+    return std::strncmp(pv.param_id, HASH_CHECK_ID, PARAM_ID_LEN) == 0;
+}
+
+static bool sameId(const char* a, const char* wire_id) {
+    return std::strncmp(a, wire_id, PARAM_ID_LEN) == 0;
+}
+
+// Into a zeroed wire field: full-length ids go unterminated
+static void copyId(char (&wire_id)[PARAM_ID_LEN], const char* id) {
+    std::memcpy(wire_id, id, strnlen(id, PARAM_ID_LEN));
+}
+
+double ParamTransfer::Stats::seconds() const {
+    return chrono::duration<double>(finished - started).count();
+}
+
+const char* paramStateName(ParamTransfer::State state) {
+    switch (state) {
+    case ParamTransfer::State::IDLE:       return "IDLE";
+    case ParamTransfer::State::HASH_CHECK: return "HASH_CHECK";
+    case ParamTransfer::State::STREAMING:  return "STREAMING";
+    case ParamTransfer::State::GAP_FILL:   return "GAP_FILL";
+    case ParamTransfer::State::READY:      return "READY";
+    case ParamTransfer::State::FAILED:     return "FAILED";
+    }
+    return "UNKNOWN";
+}
+
+ParamTransfer::ParamTransfer(
+    TxQueue& tx,
+    uint8_t target_sys,
+    const sockaddr_in& vehicle_addr)
+    : txQueue(tx),
+      target_sysid(target_sys),
+      px4_addr(vehicle_addr),
+      registered_(GcsClock::now()) {
+
+    handshake_timer_.fn = onHandshakeTimer;
+    handshake_timer_.owner = this;
+
+    for (size_t i = 0; i < PARAM_READ_BATCH; i++) {
+        slot_timers_[i].fn = onSlotTimer;
+        slot_timers_[i].owner = this;
+        slot_timers_[i].tag = static_cast<uint32_t>(i);
+    }
+
+    for (size_t i = 0; i < PARAM_SET_WINDOW; i++) {
+        set_timers_[i].fn = onSetTimer;
+        set_timers_[i].owner = this;
+        set_timers_[i].tag = static_cast<uint32_t>(i);
+    }
+}
+
+void ParamTransfer::arm(TimerNode& timer, GcsClock::duration delay) {
+    if (wheel_)
+        wheel_->schedule(timer, delay);
+}
+
+const VehicleParam* ParamTransfer::find(const char* id) const {
+    for (const VehicleParam& p : params_) {
+        if (std::strncmp(p.id, id, PARAM_ID_LEN) == 0)
+            return &p;
+    }
+    return nullptr;
+}
+
+// ---------------- Wire ----------------
+bool ParamTransfer::sendFrame(const mavlink_message_t& msg) {
+    return txQueue.enqueue(txQueue.pushFrame(msg), px4_addr);
+}
+
+bool ParamTransfer::sendRequestList() {
+    mavlink_param_request_list_t req{};
+    req.target_system = target_sysid;
+    req.target_component = MAV_COMP_ID_AUTOPILOT1;
+
+    mavlink_message_t msg;
+    mavlink_msg_param_request_list_encode(GCS_COMMAND_SYS_ID, GCS_COMP_ID, &msg, &req);
+    return sendFrame(msg);
+}
+
+// index -1 reads by id
+bool ParamTransfer::sendRead(int16_t index, const char* id) {
+    mavlink_param_request_read_t req{};
+    req.param_index = index;
+    req.target_system = target_sysid;
+    req.target_component = MAV_COMP_ID_AUTOPILOT1;
+    if (id)
+        copyId(req.param_id, id);
+
+    mavlink_message_t msg;
+    mavlink_msg_param_request_read_encode(GCS_COMMAND_SYS_ID, GCS_COMP_ID, &msg, &req);
+    return sendFrame(msg);
+}
+
+bool ParamTransfer::sendSet(const PendingSet& s) {
+    mavlink_param_set_t set{};
+    set.param_value = s.value;
+    set.target_system = target_sysid;
+    set.target_component = MAV_COMP_ID_AUTOPILOT1;
+    copyId(set.param_id, s.id);
+    set.param_type = s.type;
+
+    mavlink_message_t msg;
+    mavlink_msg_param_set_encode(GCS_COMMAND_SYS_ID, GCS_COMP_ID, &msg, &set);
+    return sendFrame(msg);
+}
+
+// -------------------------------------------------
+bool ParamTransfer::start(uint64_t uid, uint32_t firmware) {
+    if (state_ != State::IDLE)
+        return false;
+
+    key_.uid = uid;
+    key_.firmware = firmware;
+    stats_ = Stats{};
+    stats_.started = GcsClock::now();
+
+    if (!cache_ || !cache_->enabled()) {
+        startStreaming();
+        return true;
+    }
+
+    state_ = State::HASH_CHECK;
+    handshake_tries_ = 0;
+    sendRead(-1, HASH_CHECK_ID);
+    arm(handshake_timer_, PARAM_TIMEOUT);
+    return true;
+}
+
+void ParamTransfer::onHash(uint32_t hash) {
+    key_.hash = hash;
+    hash_known_ = true;
+
+    if (state_ == State::HASH_CHECK) {
+        if (wheel_)
+            wheel_->cancel(handshake_timer_);
+
+        if (cache_->load(target_sysid, key_, params_) && params_.size() <= UINT16_MAX) {
+            count_ = static_cast<uint16_t>(params_.size());
+            ready(true);
+            return;
+        }
+
+        params_.clear();
+        startStreaming();
+        return;
+    }
+
+    if (state_ == State::READY && rehash_) {
+        rehash_ = false;
+        if (wheel_)
+            wheel_->cancel(handshake_timer_);
+        saveCache();
+    }
+}
+
+// ---------------- Download ----------------
+void ParamTransfer::startStreaming() {
+    params_.clear();
+    have_.clear();
+    count_known_ = false;
+    count_ = 0;
+    received_ = 0;
+    next_gap_ = 0;
+    for (Slot& s : slots_)
+        s = Slot{};
+
+    state_ = State::STREAMING;
+    handshake_tries_ = 0;
+    if (wheel_)
+        last_value_ = wheel_->now();
+
+    sendRequestList();
+    arm(handshake_timer_, PARAM_TIMEOUT);
+}
+
+void ParamTransfer::onIndexed(const mavlink_param_value_t& pv) {
+    if (!count_known_) {
+        if (pv.param_count == 0)
+            return;
+
+        count_known_ = true;
+        count_ = pv.param_count;
+        params_.assign(count_, VehicleParam{});
+        have_.assign((count_ + 63) / 64, 0);
+    }
+
+    const uint16_t index = pv.param_index;
+    if (index >= count_ || have(index))
+        return;     // late duplicate of a re-read
+
+    VehicleParam& p = params_[index];
+    std::memcpy(p.id, pv.param_id, PARAM_ID_LEN);
+    p.id[PARAM_ID_LEN] = '\0';
+    p.value = pv.param_value;
+    p.type = pv.param_type;
+
+    have_[index >> 6] |= 1ull << (index & 63);
+    received_++;
+    Metrics::local().add(Counter::PARAMS_RECEIVED);
+
+    bool was_read = false;
+    for (size_t i = 0; i < PARAM_READ_BATCH; i++) {
+        if (slots_[i].used && slots_[i].index == index) {
+            slots_[i].used = false;
+            if (wheel_)
+                wheel_->cancel(slot_timers_[i]);
+            was_read = true;
+            break;
+        }
+    }
+    if (!was_read)
+        stats_.streamed++;
+
+    if (received_ == count_) {
+        ready(false);
+        return;
+    }
+
+    if (state_ == State::GAP_FILL)
+        refillBatch();
+}
+
+int ParamTransfer::nextMissing(uint16_t from) const {
+    for (size_t w = from >> 6; w < have_.size(); w++) {
+        uint64_t missing = ~have_[w];
+        if (w == size_t(from >> 6))
+            missing &= ~0ull << (from & 63);
+        if (missing == 0)
+            continue;
+
+        const size_t index = w * 64 + __builtin_ctzll(missing);
+        return index < count_ ? static_cast<int>(index) : -1;
+    }
+    return -1;
+}
+
+void ParamTransfer::refillBatch() {
+    bool any_in_flight = false;
+    bool tx_full = false;
+
+    for (size_t i = 0; i < PARAM_READ_BATCH && !tx_full; i++) {
+        Slot& s = slots_[i];
+
+        if (!s.used) {
+            const int index = nextMissing(next_gap_);
+            if (index >= 0) {
+                if (txQueue.framesFree() == 0 ||
+                    !sendRead(static_cast<int16_t>(index), nullptr)) {
+                    tx_full = true;
+                } else {
+                    next_gap_ = static_cast<uint16_t>(index + 1);
+                    s.index = static_cast<uint16_t>(index);
+                    s.tries = 0;
+                    s.used = true;
+                    stats_.gap_reads++;
+                    Metrics::local().add(Counter::PARAM_GAP_READS);
+                    arm(slot_timers_[i], PARAM_TIMEOUT);
+                }
+            }
+        }
+
+        any_in_flight |= s.used;
+    }
+
+    // Nothing in flight and gaps left: the TX arena was full
+    if (!any_in_flight && nextMissing(next_gap_) >= 0)
+        arm(handshake_timer_, TX_FULL_RETRY);
+}
+
+void ParamTransfer::onSlotTimeout(size_t slot) {
+    Slot& s = slots_[slot];
+    if (!s.used || state_ != State::GAP_FILL)
+        return;
+
+    if (s.tries >= PARAM_MAX_RETRIES) {
+        LOG_WARN("PARAM", "SysID {} index {} never arrived", target_sysid, s.index);
+        fail("gap read timed out");
+        return;
+    }
+
+    if (txQueue.framesFree() == 0 || !sendRead(static_cast<int16_t>(s.index), nullptr)) {
+        arm(slot_timers_[slot], TX_FULL_RETRY);
+        return;
+    }
+
+    s.tries++;
+    stats_.gap_reads++;
+    Metrics::local().add(Counter::PARAM_GAP_READS);
+    arm(slot_timers_[slot], PARAM_TIMEOUT);
+}
+
+// ---------------- Sets ----------------
+bool ParamTransfer::set(const char* id, double value) {
+    if (state_ != State::READY)
+        return false;
+
+    const VehicleParam* p = find(id);
+    if (!p)
+        return false;
+
+    // One set per id at a time: the echoes could not be told apart
+    for (const PendingSet& s : sets_) {
+        if (s.used && sameId(s.id, p->id))
+            return false;
+    }
+
+    for (size_t i = 0; i < PARAM_SET_WINDOW; i++) {
+        PendingSet& s = sets_[i];
+        if (s.used)
+            continue;
+
+        std::memcpy(s.id, p->id, sizeof(s.id));
+        s.type = p->type;
+        s.value = paramIsInteger(p->type)
+            ? paramFromInt(std::llround(value), p->type)
+            : static_cast<float>(value);
+        s.tries = 0;
+        s.used = true;
+        sets_in_flight_++;
+
+        arm(set_timers_[i], sendSet(s) ? GcsClock::duration(PARAM_TIMEOUT)
+                                       : GcsClock::duration(TX_FULL_RETRY));
+        return true;
+    }
+    return false;
+}
+
+void ParamTransfer::onSetEcho(size_t slot, const mavlink_param_value_t& pv) {
+    PendingSet& s = sets_[slot];
+
+    if (std::memcmp(&s.value, &pv.param_value, sizeof(float)) == 0)
+        LOG_INFO("PARAM", "SysID {} {} set", target_sysid, s.id);
+    else
+        LOG_WARN("PARAM", "SysID {} {} not taken, vehicle kept {}",
+                 target_sysid, s.id, double(pv.param_value));
+
+    if (wheel_)
+        wheel_->cancel(set_timers_[slot]);
+    s.used = false;
+    sets_in_flight_--;
+
+    // The vehicle's hash moved with the value: read it back so the
+    // cache stays valid for the next connect
+    if (sets_in_flight_ == 0 && cache_ && cache_->enabled()) {
+        rehash_ = true;
+        handshake_tries_ = 0;
+        sendRead(-1, HASH_CHECK_ID);
+        arm(handshake_timer_, PARAM_TIMEOUT);
+    }
+}
+
+void ParamTransfer::onSetTimeout(size_t slot) {
+    PendingSet& s = sets_[slot];
+    if (!s.used)
+        return;
+
+    if (s.tries >= PARAM_MAX_RETRIES) {
+        LOG_WARN("PARAM", "SysID {} {} set never confirmed", target_sysid, s.id);
+        s.used = false;
+        sets_in_flight_--;
+        return;
+    }
+
+    if (!sendSet(s)) {
+        arm(set_timers_[slot], TX_FULL_RETRY);
+        return;
+    }
+
+    s.tries++;
+    stats_.resends++;
+    arm(set_timers_[slot], PARAM_TIMEOUT);
+}
+
+// ---------------- Timers ----------------
+void ParamTransfer::onHandshakeTimer(void* self, uint32_t) {
+    static_cast<ParamTransfer*>(self)->onHandshakeTimeout();
+}
+
+void ParamTransfer::onSlotTimer(void* self, uint32_t slot) {
+    static_cast<ParamTransfer*>(self)->onSlotTimeout(slot);
+}
+
+void ParamTransfer::onSetTimer(void* self, uint32_t slot) {
+    static_cast<ParamTransfer*>(self)->onSetTimeout(slot);
+}
+
+void ParamTransfer::onHandshakeTimeout() {
+    switch (state_) {
+    case State::STREAMING:
+        if (count_known_) {
+            // Re-armed lazily: values never touch the timer
+            const auto quiet = wheel_->now() - last_value_;
+            if (quiet < PARAM_STREAM_IDLE) {
+                arm(handshake_timer_, PARAM_STREAM_IDLE - quiet);
+                return;
+            }
+
+            LOG_DEBUG("PARAM", "SysID {} stream ended with {}/{}, reading gaps",
+                      target_sysid, received_, count_);
+            state_ = State::GAP_FILL;
+            refillBatch();
+            return;
+        }
+        break;
+
+    case State::GAP_FILL:
+        refillBatch();
+        return;
+
+    case State::HASH_CHECK:
+    case State::READY:
+        if (state_ == State::READY && !rehash_)
+            return;
+        break;
+
+    default:
+        return;
+    }
+
+    if (handshake_tries_ >= PARAM_MAX_RETRIES) {
+        if (state_ == State::HASH_CHECK) {
+            // No _HASH_CHECK on this autopilot: nothing to validate against
+            LOG_INFO("PARAM", "SysID {} has no parameter hash, downloading", target_sysid);
+            startStreaming();
+        } else if (state_ == State::READY) {
+            rehash_ = false;
+        } else {
+            fail("no reply to PARAM_REQUEST_LIST");
+        }
+        return;
+    }
+
+    handshake_tries_++;
+    stats_.resends++;
+
+    if (state_ == State::STREAMING)
+        sendRequestList();
+    else
+        sendRead(-1, HASH_CHECK_ID);
+
+    arm(handshake_timer_, PARAM_TIMEOUT);
+}
+
+// -------------------------------------------------
+void ParamTransfer::update(ParamEventQueue& events) {
+    mavlink_param_value_t pv;
+    bool any = false;
+
+    while (events.pop(pv)) {
+        onValue(pv);
+        any = true;
+    }
+
+    // Wheel time: the idle check runs off the same clock
+    if (any && wheel_)
+        last_value_ = wheel_->now();
+}
+
+void ParamTransfer::onValue(const mavlink_param_value_t& pv) {
+    if (isHashCheck(pv)) {
+        uint32_t hash;
+        std::memcpy(&hash, &pv.param_value, sizeof(hash));
+        onHash(hash);
+        return;
+    }
+
+    switch (state_) {
+    case State::STREAMING:
+    case State::GAP_FILL:
+        onIndexed(pv);
+        break;
+
+    case State::READY: {
+        for (size_t i = 0; i < PARAM_SET_WINDOW; i++) {
+            if (sets_[i].used && sameId(sets_[i].id, pv.param_id)) {
+                onSetEcho(i, pv);
+                break;
+            }
+        }
+
+        // Echoes, and changes made by anyone else
+        VehicleParam* p = pv.param_index < params_.size() &&
+                          sameId(params_[pv.param_index].id, pv.param_id)
+            ? &params_[pv.param_index]
+            : nullptr;
+        for (size_t i = 0; !p && i < params_.size(); i++) {
+            if (sameId(params_[i].id, pv.param_id))
+                p = &params_[i];
+        }
+        if (p)
+            p->value = pv.param_value;
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+void ParamTransfer::ready(bool from_cache) {
+    if (wheel_) {
+        wheel_->cancel(handshake_timer_);
+        for (TimerNode& t : slot_timers_)
+            wheel_->cancel(t);
+    }
+
+    have_.clear();
+    have_.shrink_to_fit();
+
+    stats_.from_cache = from_cache;
+    stats_.count = count_;
+    stats_.finished = GcsClock::now();
+    state_ = State::READY;
+
+    const int64_t ms = chrono::duration_cast<chrono::milliseconds>(
+        stats_.finished - registered_).count();
+    ready_ms_.store(ms, memory_order_relaxed);
+
+    if (from_cache) {
+        Metrics::local().add(Counter::PARAM_CACHE_HITS);
+        LOG_INFO("PARAM", "SysID {} ready: {} params from cache, {} ms after connect",
+                 target_sysid, count_, ms);
+        return;
+    }
+
+    LOG_INFO("PARAM", "SysID {} ready: {} params in {} ms ({} streamed, {} gap reads), {} ms after connect",
+             target_sysid, count_, static_cast<uint64_t>(stats_.seconds() * 1000),
+             stats_.streamed, stats_.gap_reads, ms);
+
+    if (hash_known_)
+        saveCache();
+}
+
+void ParamTransfer::fail(const char* why) {
+    if (wheel_) {
+        wheel_->cancel(handshake_timer_);
+        for (TimerNode& t : slot_timers_)
+            wheel_->cancel(t);
+    }
+
+    stats_.finished = GcsClock::now();
+    state_ = State::FAILED;
+
+    LOG_WARN("PARAM", "SysID {} download failed ({}) with {}/{}",
+             target_sysid, why, received_, count_);
+}
+
+void ParamTransfer::saveCache() {
+    if (cache_ && cache_->save(target_sysid, key_, params_))
+        LOG_DEBUG("PARAM", "SysID {} cached under hash {}", target_sysid, key_.hash);
+}
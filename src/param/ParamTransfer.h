@@ -0,0 +1,202 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <netinet/in.h>
+#include <string>
+#include <vector>
+
+#include "core/GcsClock.h"
+#include "core/TimerWheel.h"
+#include "param/ParamCache.h"
+#include "telemetry/TelemetryData.h"
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+class TxQueue;
+
+static constexpr int PARAM_TIMEOUT_MS = 500;
+static constexpr int PARAM_MAX_RETRIES = 5;
+
+// Silence that ends the streamed list; what is still missing then
+// gets read back by index
+static constexpr int PARAM_STREAM_IDLE_MS = 300;
+
+// Gap reads in flight per vehicle
+static constexpr size_t PARAM_READ_BATCH = 32;
+static_assert(PARAM_READ_BATCH < PARAM_EVENT_QUEUE_DEPTH,
+              "a full batch of replies must fit the event queue");
+
+// PARAM_SETs awaiting their echo per vehicle
+static constexpr size_t PARAM_SET_WINDOW = 8;
+
+struct ParamAssignment {
+    char id[PARAM_ID_LEN + 1] = {};
+    double value = 0;
+};
+
+struct ParamOptions {
+    std::string cache_dir;                  // empty: no cache
+    std::vector<ParamAssignment> sets;      // applied to every vehicle once ready
+};
+
+// -------------------------------------------------
+// The parameter set of one vehicle; control side only.
+//
+// With a cache, the vehicle's `_HASH_CHECK` is read
+// first: a match with the file saved for this
+// firmware skips the download altogether. Otherwise
+// PARAM_REQUEST_LIST streams everything; a bitmap
+// tracks which indices arrived, and once the stream
+// goes quiet the gaps are read back by index,
+// PARAM_READ_BATCH at a time, each on its own timer.
+//
+// Sets are windowed the same way and confirmed by the
+// PARAM_VALUE the vehicle echoes back.
+// -------------------------------------------------
+class ParamTransfer {
+public:
+    enum class State : uint8_t {
+        IDLE,
+        HASH_CHECK,
+        STREAMING,
+        GAP_FILL,
+        READY,
+        FAILED
+    };
+
+    struct Stats {
+        bool from_cache = false;
+        uint32_t count = 0;           // parameters on the vehicle
+        uint32_t streamed = 0;        // arrived off PARAM_REQUEST_LIST
+        uint32_t gap_reads = 0;       // PARAM_REQUEST_READs, resends included
+        uint32_t resends = 0;         // handshake frames sent again
+        GcsClock::time_point started{};
+        GcsClock::time_point finished{};
+
+        double seconds() const;
+    };
+
+    ParamTransfer(TxQueue& tx, uint8_t target_sys, const sockaddr_in& vehicle_addr);
+
+    // Timers point back at this instance
+    ParamTransfer(const ParamTransfer&) = delete;
+    ParamTransfer& operator=(const ParamTransfer&) = delete;
+
+    // Must be the wheel of the thread calling update()
+    void setTimerWheel(TimerWheel* wheel) { wheel_ = wheel; }
+    void setCache(const ParamCache* cache) { cache_ = cache; }
+
+    // Firmware identity from AUTOPILOT_VERSION, zeros when the
+    // vehicle gave none. Once per vehicle.
+    bool start(uint64_t uid, uint32_t firmware);
+
+    // Integer parameters are encoded bytewise from `value`.
+    // Refused before READY, for an unknown id, or with the window full.
+    bool set(const char* id, double value);
+    bool setsPending() const { return sets_in_flight_ != 0; }
+
+    // Drains the vehicle's PARAM_VALUEs; re-requests run off the wheel
+    void update(ParamEventQueue& events);
+
+    State state() const { return state_; }
+    bool busy() const {
+        return state_ == State::HASH_CHECK || state_ == State::STREAMING ||
+               state_ == State::GAP_FILL;
+    }
+    const Stats& stats() const { return stats_; }
+
+    // Index order, as the vehicle numbers them
+    const std::vector<VehicleParam>& params() const { return params_; }
+    const VehicleParam* find(const char* id) const;
+
+    // Registration -> READY in ms, -1 until then. Any thread.
+    int64_t readyMillis() const { return ready_ms_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        uint16_t index = 0;
+        uint8_t tries = 0;
+        bool used = false;
+    };
+
+    struct PendingSet {
+        char id[PARAM_ID_LEN + 1] = {};
+        float value = 0;
+        uint8_t type = 0;
+        uint8_t tries = 0;
+        bool used = false;
+    };
+
+    void arm(TimerNode& timer, GcsClock::duration delay);
+
+    void onValue(const mavlink_param_value_t& pv);
+    void onHash(uint32_t hash);
+
+    // ---------- Download ----------
+    void startStreaming();
+    void onIndexed(const mavlink_param_value_t& pv);
+    bool have(uint16_t index) const { return (have_[index >> 6] >> (index & 63)) & 1; }
+    int nextMissing(uint16_t from) const;
+    void refillBatch();
+    void onSlotTimeout(size_t slot);
+
+    // ---------- Sets ----------
+    void onSetEcho(size_t slot, const mavlink_param_value_t& pv);
+    void onSetTimeout(size_t slot);
+
+    // ---------- Wire ----------
+    bool sendFrame(const mavlink_message_t& msg);
+    bool sendRequestList();
+    bool sendRead(int16_t index, const char* id);
+    bool sendSet(const PendingSet& s);
+
+    static void onHandshakeTimer(void* self, uint32_t);
+    static void onSlotTimer(void* self, uint32_t slot);
+    static void onSetTimer(void* self, uint32_t slot);
+    void onHandshakeTimeout();
+
+    void ready(bool from_cache);
+    void fail(const char* why);
+    void saveCache();
+
+    TxQueue& txQueue;
+    uint8_t target_sysid;
+    sockaddr_in px4_addr;
+    TimerWheel* wheel_ = nullptr;
+    const ParamCache* cache_ = nullptr;
+
+    State state_ = State::IDLE;
+    Stats stats_;
+    GcsClock::time_point registered_;
+    std::atomic<int64_t> ready_ms_{-1};
+
+    ParamCacheKey key_;
+    bool hash_known_ = false;
+    bool rehash_ = false;           // sets landed: re-read the hash, then save
+
+    // _HASH_CHECK / REQUEST_LIST / stream idle, and the TX-full kick
+    TimerNode handshake_timer_;
+    int handshake_tries_ = 0;
+    GcsClock::time_point last_value_{};
+
+    // ---- Download ----
+    std::vector<VehicleParam> params_;
+    std::vector<uint64_t> have_;    // bit per index
+    bool count_known_ = false;
+    uint16_t count_ = 0;
+    uint16_t received_ = 0;
+    uint16_t next_gap_ = 0;
+    Slot slots_[PARAM_READ_BATCH];
+    TimerNode slot_timers_[PARAM_READ_BATCH];
+
+    // ---- Sets ----
+    PendingSet sets_[PARAM_SET_WINDOW];
+    TimerNode set_timers_[PARAM_SET_WINDOW];
+    size_t sets_in_flight_ = 0;
+};
+
+const char* paramStateName(ParamTransfer::State state);
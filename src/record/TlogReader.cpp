@@ -0,0 +1,88 @@
+#include "record/TlogReader.h"
+#include "record/TlogRecorder.h"
+#include "core/Logger.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint64_t getBe64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+TlogReader::~TlogReader() {
+    close();
+}
+
+bool TlogReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("TLOG", "open {}: {}", path.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (p == MAP_FAILED) {
+        LOG_ERROR("TLOG", "mmap {}: {}", path.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    // Advice values are not flags: read-ahead comes from the hint,
+    // without prefetching a whole segment up front
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+
+    map = static_cast<const uint8_t*>(p);
+    file_size = static_cast<size_t>(st.st_size);
+    offset = 0;
+    return true;
+}
+
+void TlogReader::close() {
+    if (map)
+        munmap(const_cast<uint8_t*>(map), file_size);
+    map = nullptr;
+    file_size = 0;
+    offset = 0;
+}
+
+bool TlogReader::next(TlogRecord& out) {
+    if (!map || offset + TLOG_RECORD_HEADER_BYTES > file_size)
+        return false;
+
+    const uint8_t* p = map + offset;
+
+    out.timestamp_us = getBe64(p);
+    out.len = static_cast<uint16_t>((p[14] << 8) | p[15]);
+
+    // Zero timestamp + zero length: preallocated, never-written tail
+    if (out.timestamp_us == 0 && out.len == 0)
+        return false;
+
+    if (offset + TLOG_RECORD_HEADER_BYTES + out.len > file_size)
+        return false;
+
+    out.src = sockaddr_in{};
+    out.src.sin_family = AF_INET;
+    std::memcpy(&out.src.sin_addr.s_addr, p + 8, 4);
+    std::memcpy(&out.src.sin_port, p + 12, 2);
+    out.data = p + TLOG_RECORD_HEADER_BYTES;
+
+    offset += TLOG_RECORD_HEADER_BYTES + out.len;
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <netinet/in.h>
+#include <string>
+
+// One record of a TlogRecorder segment, pointing into the mapping
+struct TlogRecord {
+    uint64_t timestamp_us = 0;
+    sockaddr_in src{};
+    const uint8_t* data = nullptr;
+    uint16_t len = 0;
+};
+
+// -------------------------------------------------
+// Read-only mmap view of one recorded segment. Stops
+// at the end of the file or at the zeroed tail left
+// by a segment that was never trimmed (crash/kill).
+// -------------------------------------------------
+class TlogReader {
+public:
+    TlogReader() = default;
+    ~TlogReader();
+
+    TlogReader(const TlogReader&) = delete;
+    TlogReader& operator=(const TlogReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool next(TlogRecord& out);
+
+    size_t size() const { return file_size; }
+
+private:
+    const uint8_t* map = nullptr;
+    size_t file_size = 0;
+    size_t offset = 0;
+};
@@ -0,0 +1,162 @@
+#include "record/TlogRecorder.h"
+#include "comm/RxDatagram.h"
+#include "core/Logger.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static void putBe64(uint8_t* p, uint64_t v) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = static_cast<uint8_t>(v);
+        v >>= 8;
+    }
+}
+
+TlogRecorder::~TlogRecorder() {
+    close();
+}
+
+bool TlogRecorder::open(const std::string& directory, size_t segment_bytes) {
+    close();
+
+    if (mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST) {
+        LOG_ERROR("TLOG", "mkdir {}: {}", directory.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    dir = directory;
+    segment_size = segment_bytes;
+    segment_index = 0;
+
+    char stamp[32];
+    time_t now = time(nullptr);
+    tm local;
+    localtime_r(&now, &local);
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+    session = stamp;
+
+    return openSegment();
+}
+
+bool TlogRecorder::openSegment() {
+    char name[64];
+    std::snprintf(name, sizeof(name), "/gcs-%s-%04u%s",
+                  session.c_str(), segment_index, TLOG_SEGMENT_SUFFIX);
+    const std::string path = dir + name;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("TLOG", "open {}: {}", name, std::strerror(errno));
+        return false;
+    }
+
+    // Reserve real blocks so a full disk fails here, not as SIGBUS
+    // later. Only a filesystem that can't reserve gets a sparse file.
+    int err = posix_fallocate(fd, 0, static_cast<off_t>(segment_size));
+    if (err == EOPNOTSUPP || err == EINVAL)
+        err = ftruncate(fd, static_cast<off_t>(segment_size)) < 0 ? errno : 0;
+
+    if (err != 0) {
+        LOG_ERROR("TLOG", "size {}: {}", name, std::strerror(err));
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    void* p = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        LOG_ERROR("TLOG", "mmap {}: {}", name, std::strerror(errno));
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    madvise(p, segment_size, MADV_SEQUENTIAL);
+
+    map = static_cast<uint8_t*>(p);
+    used = 0;
+    flushed = 0;
+    segment_index++;
+    stats_.segments++;
+
+    LOG_INFO("TLOG", "Recording to {}{}", dir.c_str(), name);
+    return true;
+}
+
+void TlogRecorder::closeSegment() {
+    if (!map)
+        return;
+
+    munmap(map, segment_size);
+    map = nullptr;
+
+    // Drop the unused preallocated tail
+    if (ftruncate(fd, static_cast<off_t>(used)) < 0)
+        LOG_WARN("TLOG", "truncate: {}", std::strerror(errno));
+
+    sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+    ::close(fd);
+    fd = -1;
+}
+
+void TlogRecorder::close() {
+    closeSegment();
+}
+
+void TlogRecorder::record(const RxDatagram& dgram) {
+    record(dgram.rx_time, dgram.src, dgram.data, static_cast<uint16_t>(dgram.len));
+}
+
+void TlogRecorder::record(
+    const timespec& rx_time,
+    const sockaddr_in& src,
+    const uint8_t* data,
+    uint16_t len) {
+
+    const size_t need = TLOG_RECORD_HEADER_BYTES + len;
+
+    if (!map || used + need > segment_size) {
+        if (!map || need > segment_size) {
+            stats_.dropped++;
+            return;
+        }
+        closeSegment();
+        if (!openSegment()) {
+            stats_.dropped++;
+            return;
+        }
+    }
+
+    uint8_t* p = map + used;
+
+    const uint64_t usec = uint64_t(rx_time.tv_sec) * 1000000ULL +
+                          uint64_t(rx_time.tv_nsec) / 1000ULL;
+    putBe64(p, usec);
+
+    // sockaddr_in fields are already big-endian
+    std::memcpy(p + 8, &src.sin_addr.s_addr, 4);
+    std::memcpy(p + 12, &src.sin_port, 2);
+    p[14] = static_cast<uint8_t>(len >> 8);
+    p[15] = static_cast<uint8_t>(len);
+
+    std::memcpy(p + TLOG_RECORD_HEADER_BYTES, data, len);
+
+    used += need;
+    stats_.records++;
+    stats_.bytes += need;
+}
+
+void TlogRecorder::flush() {
+    if (!map || used == flushed)
+        return;
+
+    // Kick off writeback of the new range; never waits on the disk
+    sync_file_range(fd, static_cast<off_t>(flushed),
+                    static_cast<off_t>(used - flushed), SYNC_FILE_RANGE_WRITE);
+    flushed = used;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <netinet/in.h>
+#include <string>
+
+struct RxDatagram;
+
+static constexpr size_t TLOG_DEFAULT_SEGMENT_BYTES = 256u << 20;
+
+// How often the owning loop should call flush()
+static constexpr int TLOG_FLUSH_PERIOD_MS = 1000;
+
+// -------------------------------------------------
+// On-disk record (all integers big-endian):
+//
+//   u64  receive time, µs since the UNIX epoch
+//   u32  source IPv4 address
+//   u16  source UDP port
+//   u16  datagram length N
+//   u8[N] datagram bytes (one or more MAVLink frames)
+//
+// The leading timestamp uses the same layout as a
+// standard MAVLink .tlog; the endpoint and length
+// fields are what lets multi-vehicle traffic replay
+// through the fleet registry. Tools that expect a
+// plain .tlog take `gcs_replay --export-tlog` output.
+// -------------------------------------------------
+static constexpr size_t TLOG_RECORD_HEADER_BYTES = 16;
+static constexpr const char* TLOG_SEGMENT_SUFFIX = ".gtlog";
+
+// -------------------------------------------------
+// Append-only recorder over pre-sized mmap'd segment
+// files. Recording a datagram is a bounds check and a
+// memcpy into the mapping; segments roll by size and
+// dirty pages are pushed to disk asynchronously.
+// -------------------------------------------------
+class TlogRecorder {
+public:
+    struct Stats {
+        uint64_t records = 0;
+        uint64_t bytes = 0;
+        uint64_t segments = 0;
+        uint64_t dropped = 0;        // no segment could be opened
+    };
+
+    TlogRecorder() = default;
+    ~TlogRecorder();
+
+    TlogRecorder(const TlogRecorder&) = delete;
+    TlogRecorder& operator=(const TlogRecorder&) = delete;
+
+    // Creates directory if needed and maps the first segment
+    bool open(const std::string& directory,
+              size_t segment_bytes = TLOG_DEFAULT_SEGMENT_BYTES);
+
+    bool isOpen() const { return map != nullptr; }
+
+    void record(const RxDatagram& dgram);
+    void record(const timespec& rx_time,
+                const sockaddr_in& src,
+                const uint8_t* data,
+                uint16_t len);
+
+    // Starts writeback of everything appended since the last call
+    // without waiting for it (call from a periodic timer)
+    void flush();
+
+    // Trims the current segment to its used size and unmaps it
+    void close();
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    bool openSegment();
+    void closeSegment();
+
+    std::string dir;
+    std::string session;             // start time, shared by all segments
+    size_t segment_size = 0;
+    uint32_t segment_index = 0;
+
+    int fd = -1;
+    uint8_t* map = nullptr;
+    size_t used = 0;
+    size_t flushed = 0;
+
+    Stats stats_;
+};
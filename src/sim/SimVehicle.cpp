@@ -0,0 +1,729 @@
+#include "sim/SimVehicle.h"
+#include "core/Logger.h"
+#include "mission/MissionPlan.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+
+// PX4 custom_mode = main_mode << 16 | sub_mode << 24
+static constexpr uint32_t PX4_MAIN_AUTO = 4;
+static constexpr uint32_t PX4_AUTO_TAKEOFF = 2;
+static constexpr uint32_t PX4_AUTO_LOITER = 3;
+static constexpr uint32_t PX4_AUTO_LAND = 6;
+
+static uint32_t px4Mode(uint32_t main_mode, uint32_t sub_mode) {
+    return (main_mode << 16) | (sub_mode << 24);
+}
+
+// A few real PX4 names up front; the rest are numbered
+static const struct { const char* id; uint8_t type; double value; } PX4_PARAMS[] = {
+    { "SYS_AUTOSTART",  MAV_PARAM_TYPE_INT32,  4001 },
+    { "COM_RC_IN_MODE", MAV_PARAM_TYPE_INT32,  1 },
+    { "MIS_TAKEOFF_ALT", MAV_PARAM_TYPE_REAL32, 2.5 },
+    { "MPC_XY_VEL_MAX", MAV_PARAM_TYPE_REAL32, 12.0 },
+    { "NAV_DLL_ACT",    MAV_PARAM_TYPE_INT32,  0 },
+    { "BAT1_N_CELLS",   MAV_PARAM_TYPE_INT32,  4 },
+};
+
+static constexpr uint32_t SIM_FIRMWARE = 0x010f00ff;   // 1.15.0 release
+
+static GcsClock::duration periodOf(double hz) {
+    if (hz <= 0)
+        return GcsClock::duration::zero();
+    return chrono::duration_cast<GcsClock::duration>(
+        chrono::duration<double>(1.0 / hz));
+}
+
+SimVehicle::~SimVehicle() {
+    if (sockfd >= 0)
+        close(sockfd);
+}
+
+bool SimVehicle::start(
+    const SimConfig& cfg,
+    int index,
+    uint8_t sysid,
+    GcsClock::time_point now) {
+
+    config = &cfg;
+    sysid_ = sysid;
+    rng = cfg.seed * 2654435761u + static_cast<uint32_t>(index) + 1;
+
+    sockfd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sockfd < 0) {
+        perror("socket");
+        return false;
+    }
+
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    local.sin_port = htons(static_cast<uint16_t>(cfg.base_port + index));
+
+    if (bind(sockfd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0) {
+        perror("bind");
+        close(sockfd);
+        sockfd = -1;
+        return false;
+    }
+
+    period[HEARTBEAT] = periodOf(cfg.heartbeat_hz);
+    period[SYS_STATUS] = periodOf(cfg.sys_status_hz);
+    period[ESTIMATOR] = periodOf(cfg.estimator_hz);
+    period[EXTENDED_STATE] = periodOf(cfg.extended_state_hz);
+    period[ATTITUDE] = periodOf(cfg.attitude_hz);
+    period[GLOBAL_POSITION] = periodOf(cfg.position_hz);
+    period[HIGHRES_IMU] = periodOf(cfg.imu_hz);
+
+    for (int s = 0; s < STREAM_COUNT; s++)
+        default_period[s] = period[s];
+
+    // Random phase per stream so a large fleet does not send in lockstep;
+    // the first heartbeat goes out at once so the GCS registers us
+    for (int s = 0; s < STREAM_COUNT; s++) {
+        const auto p = period[s].count();
+        next_due[s] = now + GcsClock::duration(p > 0 ? random() % p : 0);
+    }
+    next_due[HEARTBEAT] = now;
+
+    // Somewhere different for every vehicle, ~200 m apart
+    const MissionPlan onboard = MissionPlan::survey(
+        cfg.mission_items, 473977420 + index * 18000, 85455940, 30.0f);
+    mission.reserve(onboard.size());
+    for (size_t i = 0; i < onboard.size(); i++)
+        mission.push_back(onboard[i]);
+
+    params.resize(cfg.params);
+    for (size_t i = 0; i < params.size(); i++) {
+        VehicleParam& p = params[i];
+        if (i < sizeof(PX4_PARAMS) / sizeof(PX4_PARAMS[0])) {
+            std::snprintf(p.id, sizeof(p.id), "%s", PX4_PARAMS[i].id);
+            p.type = PX4_PARAMS[i].type;
+            p.value = paramIsInteger(p.type)
+                ? paramFromInt(static_cast<int64_t>(PX4_PARAMS[i].value), p.type)
+                : static_cast<float>(PX4_PARAMS[i].value);
+        } else if (i & 1) {
+            std::snprintf(p.id, sizeof(p.id), "SIM_I%04u", unsigned(i));
+            p.type = MAV_PARAM_TYPE_INT32;
+            p.value = paramFromInt(static_cast<int64_t>(i), p.type);
+        } else {
+            std::snprintf(p.id, sizeof(p.id), "SIM_F%04u", unsigned(i));
+            p.type = MAV_PARAM_TYPE_REAL32;
+            p.value = static_cast<float>(i) * 0.5f;
+        }
+    }
+    rehashParams();
+    param_period = periodOf(cfg.param_rate_hz);
+
+    return true;
+}
+
+uint32_t SimVehicle::random() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// ---------------- Receive ----------------
+void SimVehicle::onReadable(GcsClock::time_point now) {
+    uint8_t buf[2048];
+
+    for (;;) {
+        ssize_t n = recv(sockfd, buf, sizeof(buf), 0);
+        if (n <= 0)
+            break;
+
+        scanner.scan(buf, static_cast<size_t>(n),
+            [&](const MavlinkFrameView& frame) {
+                if (frame.msgid == MAVLINK_MSG_ID_COMMAND_LONG)
+                    handleCommand(frame, now);
+                else if (frame.msgid >= MAVLINK_MSG_ID_PARAM_REQUEST_READ &&
+                         frame.msgid <= MAVLINK_MSG_ID_PARAM_SET)
+                    handleParam(frame);
+                else
+                    handleMission(frame);
+            });
+    }
+}
+
+void SimVehicle::handleCommand(const MavlinkFrameView& frame, GcsClock::time_point now) {
+
+    mavlink_command_long_t cmd;
+    decodePayload(frame, cmd);
+
+    if (cmd.target_system != sysid_ && cmd.target_system != 0)
+        return;
+
+    stats_.commands_rx++;
+
+    // State changes even when the ACK is lost, like a real link
+    const uint8_t result = execute(cmd, now);
+
+    if (config->ack_drop > 0 &&
+        random() < config->ack_drop * 4294967295.0) {
+        stats_.acks_dropped++;
+        return;
+    }
+
+    if (ack_count == ACK_QUEUE) {
+        stats_.acks_dropped++;
+        return;
+    }
+
+    PendingAck& ack = acks[(ack_head + ack_count) % ACK_QUEUE];
+    ack.due = now + chrono::milliseconds(config->ack_delay_ms);
+    ack.command = cmd.command;
+    ack.result = result;
+    ack.target_sys = frame.sysid;
+    ack.target_comp = frame.compid;
+    ack_count++;
+}
+
+// Retries of a command already carried out are accepted again
+uint8_t SimVehicle::execute(const mavlink_command_long_t& cmd, GcsClock::time_point now) {
+
+    switch (cmd.command) {
+
+    case MAV_CMD_COMPONENT_ARM_DISARM:
+        if (landed_state != MAV_LANDED_STATE_ON_GROUND)
+            return MAV_RESULT_DENIED;
+        armed = cmd.param1 > 0.5f;
+        return MAV_RESULT_ACCEPTED;
+
+    case MAV_CMD_DO_SET_MODE:
+        if (!armed)
+            return MAV_RESULT_DENIED;
+        custom_mode = px4Mode(static_cast<uint32_t>(cmd.param2),
+                              static_cast<uint32_t>(cmd.param3));
+        return MAV_RESULT_ACCEPTED;
+
+    case MAV_CMD_NAV_TAKEOFF:
+        if (landed_state == MAV_LANDED_STATE_TAKEOFF ||
+            landed_state == MAV_LANDED_STATE_IN_AIR)
+            return MAV_RESULT_ACCEPTED;
+        if (!armed)
+            return MAV_RESULT_DENIED;
+        landed_state = MAV_LANDED_STATE_TAKEOFF;
+        custom_mode = px4Mode(PX4_MAIN_AUTO, PX4_AUTO_TAKEOFF);
+        transition_at = now + chrono::milliseconds(config->takeoff_ms);
+        return MAV_RESULT_ACCEPTED;
+
+    case MAV_CMD_NAV_LAND:
+    case MAV_CMD_NAV_RETURN_TO_LAUNCH:
+        if (landed_state == MAV_LANDED_STATE_LANDING)
+            return MAV_RESULT_ACCEPTED;
+        if (landed_state == MAV_LANDED_STATE_ON_GROUND)
+            return MAV_RESULT_DENIED;
+        landed_state = MAV_LANDED_STATE_LANDING;
+        custom_mode = px4Mode(PX4_MAIN_AUTO, PX4_AUTO_LAND);
+        transition_at = now + chrono::milliseconds(config->land_ms);
+        return MAV_RESULT_ACCEPTED;
+
+    case MAV_CMD_REQUEST_MESSAGE:
+        if (static_cast<uint32_t>(cmd.param1) != MAVLINK_MSG_ID_AUTOPILOT_VERSION)
+            return MAV_RESULT_UNSUPPORTED;
+        sendAutopilotVersion();
+        return MAV_RESULT_ACCEPTED;
+
+    case MAV_CMD_SET_MESSAGE_INTERVAL:
+        return setInterval(static_cast<uint32_t>(cmd.param1), cmd.param2, now);
+
+    default:
+        return MAV_RESULT_UNSUPPORTED;
+    }
+}
+
+// ---------------- Mission protocol ----------------
+bool SimVehicle::missionLost() {
+    if (config->mission_drop > 0 &&
+        random() < config->mission_drop * 4294967295.0) {
+        stats_.mission_dropped++;
+        return true;
+    }
+    return false;
+}
+
+void SimVehicle::handleMission(const MavlinkFrameView& frame) {
+
+    // Heartbeats and anything else the GCS sends are ignored
+    switch (frame.msgid) {
+    case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+    case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+    case MAVLINK_MSG_ID_MISSION_REQUEST:
+    case MAVLINK_MSG_ID_MISSION_COUNT:
+    case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+    case MAVLINK_MSG_ID_MISSION_ACK:
+        break;
+    default:
+        return;
+    }
+
+    if (missionLost())
+        return;
+
+    mission_peer_sys = frame.sysid;
+    mission_peer_comp = frame.compid;
+
+    switch (frame.msgid) {
+    case MAVLINK_MSG_ID_MISSION_REQUEST_LIST: {
+        mavlink_mission_request_list_t req;
+        decodePayload(frame, req);
+        if (req.target_system == sysid_)
+            sendMissionCount();
+        break;
+    }
+    case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+    case MAVLINK_MSG_ID_MISSION_REQUEST: {
+        mavlink_mission_request_int_t req;
+        decodePayload(frame, req);
+        if (req.target_system == sysid_ && req.seq < mission.size())
+            sendMissionItem(req.seq);
+        break;
+    }
+    case MAVLINK_MSG_ID_MISSION_COUNT: {
+        mavlink_mission_count_t count;
+        decodePayload(frame, count);
+        if (count.target_system == sysid_)
+            onMissionCount(count);
+        break;
+    }
+    case MAVLINK_MSG_ID_MISSION_ITEM_INT: {
+        mavlink_mission_item_int_t item;
+        decodePayload(frame, item);
+        if (item.target_system == sysid_)
+            onMissionItem(item);
+        break;
+    }
+    default:
+        break;      // the GCS ACK after a download needs no answer
+    }
+}
+
+void SimVehicle::onMissionCount(const mavlink_mission_count_t& count) {
+    // A resent COUNT restarts the upload, as on PX4
+    upload.assign(count.count, mavlink_mission_item_int_t{});
+    upload_next = 0;
+    receiving = count.count > 0;
+
+    if (receiving) {
+        sendMissionRequest(0);
+    } else {
+        mission.clear();
+        sendMissionAck(MAV_MISSION_ACCEPTED);
+    }
+}
+
+void SimVehicle::onMissionItem(const mavlink_mission_item_int_t& item) {
+    if (!receiving) {
+        // Our final ACK was lost and the GCS resent the last item
+        if (item.seq + 1u == mission.size())
+            sendMissionAck(MAV_MISSION_ACCEPTED);
+        return;
+    }
+
+    if (item.seq != upload_next) {
+        sendMissionRequest(upload_next);
+        return;
+    }
+
+    upload[upload_next++] = item;
+    stats_.mission_items_rx++;
+
+    if (upload_next < upload.size()) {
+        sendMissionRequest(upload_next);
+        return;
+    }
+
+    mission.swap(upload);
+    upload.clear();
+    receiving = false;
+    sendMissionAck(MAV_MISSION_ACCEPTED);
+}
+
+void SimVehicle::sendMissionCount() {
+    if (missionLost())
+        return;
+
+    mavlink_mission_count_t count{};
+    count.count = static_cast<uint16_t>(mission.size());
+    count.target_system = mission_peer_sys;
+    count.target_component = mission_peer_comp;
+    count.mission_type = MAV_MISSION_TYPE_MISSION;
+
+    mavlink_message_t msg;
+    claimSequence();
+    mavlink_msg_mission_count_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &count);
+    send(msg);
+}
+
+void SimVehicle::sendMissionItem(uint16_t seq) {
+    if (missionLost())
+        return;
+
+    mavlink_mission_item_int_t item = mission[seq];
+    item.seq = seq;
+    item.target_system = mission_peer_sys;
+    item.target_component = mission_peer_comp;
+    item.mission_type = MAV_MISSION_TYPE_MISSION;
+
+    mavlink_message_t msg;
+    claimSequence();
+    mavlink_msg_mission_item_int_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &item);
+    send(msg);
+    stats_.mission_items_tx++;
+}
+
+void SimVehicle::sendMissionRequest(uint16_t seq) {
+    if (missionLost())
+        return;
+
+    mavlink_mission_request_int_t req{};
+    req.seq = seq;
+    req.target_system = mission_peer_sys;
+    req.target_component = mission_peer_comp;
+    req.mission_type = MAV_MISSION_TYPE_MISSION;
+
+    mavlink_message_t msg;
+    claimSequence();
+    mavlink_msg_mission_request_int_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &req);
+    send(msg);
+}
+
+void SimVehicle::sendMissionAck(uint8_t result) {
+    if (missionLost())
+        return;
+
+    mavlink_mission_ack_t ack{};
+    ack.target_system = mission_peer_sys;
+    ack.target_component = mission_peer_comp;
+    ack.type = result;
+    ack.mission_type = MAV_MISSION_TYPE_MISSION;
+
+    mavlink_message_t msg;
+    claimSequence();
+    mavlink_msg_mission_ack_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &ack);
+    send(msg);
+}
+
+// ---------------- Parameter protocol ----------------
+bool SimVehicle::paramLost() {
+    if (config->param_drop > 0 &&
+        random() < config->param_drop * 4294967295.0) {
+        stats_.params_dropped++;
+        return true;
+    }
+    return false;
+}
+
+// FNV-1a over ids and values; any change moves it, as PX4's does
+void SimVehicle::rehashParams() {
+    uint32_t h = 2166136261u;
+    auto mix = [&h](const void* data, size_t len) {
+        const uint8_t* b = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < len; i++) {
+            h ^= b[i];
+            h *= 16777619u;
+        }
+    };
+
+    for (const VehicleParam& p : params) {
+        mix(p.id, std::strlen(p.id));
+        mix(&p.value, sizeof(p.value));
+    }
+    param_hash = h;
+}
+
+int SimVehicle::findParam(const char* id) const {
+    for (size_t i = 0; i < params.size(); i++) {
+        if (std::strncmp(params[i].id, id, PARAM_ID_LEN) == 0)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void SimVehicle::handleParam(const MavlinkFrameView& frame) {
+
+    if (paramLost())
+        return;
+
+    switch (frame.msgid) {
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST: {
+        mavlink_param_request_list_t req;
+        decodePayload(frame, req);
+        if (req.target_system != sysid_)
+            break;
+
+        // A repeated request restarts the stream, as on PX4
+        param_streaming = true;
+        param_next = 0;
+        param_due = GcsClock::time_point{};
+        break;
+    }
+    case MAVLINK_MSG_ID_PARAM_REQUEST_READ: {
+        mavlink_param_request_read_t req;
+        decodePayload(frame, req);
+        if (req.target_system != sysid_)
+            break;
+
+        char id[PARAM_ID_LEN + 1] = {};
+        std::memcpy(id, req.param_id, PARAM_ID_LEN);
+
+        if (req.param_index >= 0) {
+            if (static_cast<size_t>(req.param_index) < params.size())
+                sendParam(req.param_index);
+        } else if (std::strcmp(id, "_HASH_CHECK") == 0) {
+            sendParam(-1);
+        } else {
+            const int index = findParam(id);
+            if (index >= 0)
+                sendParam(index);
+        }
+        break;
+    }
+    case MAVLINK_MSG_ID_PARAM_SET: {
+        mavlink_param_set_t set;
+        decodePayload(frame, set);
+        if (set.target_system != sysid_)
+            break;
+
+        char id[PARAM_ID_LEN + 1] = {};
+        std::memcpy(id, set.param_id, PARAM_ID_LEN);
+
+        const int index = findParam(id);
+        if (index < 0)
+            break;
+
+        params[index].value = set.param_value;
+        rehashParams();
+        stats_.params_set++;
+        sendParam(index);       // the echo confirms the set
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void SimVehicle::sendParam(int index) {
+    if (paramLost())
+        return;
+
+    mavlink_param_value_t pv{};
+    pv.param_count = static_cast<uint16_t>(params.size());
+
+    if (index < 0) {
+        std::memcpy(&pv.param_value, &param_hash, sizeof(param_hash));
+        pv.param_index = UINT16_MAX;
+        std::memcpy(pv.param_id, "_HASH_CHECK", sizeof("_HASH_CHECK") - 1);
+        pv.param_type = MAV_PARAM_TYPE_UINT32;
+    } else {
+        const VehicleParam& p = params[index];
+        pv.param_value = p.value;
+        pv.param_index = static_cast<uint16_t>(index);
+        std::memcpy(pv.param_id, p.id, strnlen(p.id, PARAM_ID_LEN));
+        pv.param_type = p.type;
+    }
+
+    mavlink_message_t msg;
+    claimSequence();
+    mavlink_msg_param_value_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &pv);
+    send(msg);
+    stats_.params_tx++;
+}
+
+// Paced like a radio link; the hash closes the list
+void SimVehicle::streamParams(GcsClock::time_point now) {
+    if (!param_streaming)
+        return;
+
+    if (param_due == GcsClock::time_point{})
+        param_due = now;
+
+    while (param_due <= now) {
+        if (param_next >= params.size()) {
+            sendParam(-1);
+            param_streaming = false;
+            return;
+        }
+
+        sendParam(static_cast<int>(param_next++));
+        param_due += param_period;
+        if (param_period == GcsClock::duration::zero())
+            continue;       // unpaced: the whole list at once
+    }
+}
+
+void SimVehicle::sendAutopilotVersion() {
+    mavlink_autopilot_version_t version{};
+    version.flight_sw_version = SIM_FIRMWARE;
+    version.uid = 0x53494d0000000000ULL | sysid_;     // "SIM" + sysid
+    version.vendor_id = 0x26ac;
+    version.product_id = 0x0011;
+
+    mavlink_message_t msg;
+    claimSequence();
+    mavlink_msg_autopilot_version_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &version);
+    send(msg);
+}
+
+// ---------------- Transmit ----------------
+void SimVehicle::tick(GcsClock::time_point now) {
+
+    streamParams(now);
+
+    if (now >= transition_at) {
+        if (landed_state == MAV_LANDED_STATE_TAKEOFF) {
+            landed_state = MAV_LANDED_STATE_IN_AIR;
+            custom_mode = px4Mode(PX4_MAIN_AUTO, PX4_AUTO_LOITER);
+        } else if (landed_state == MAV_LANDED_STATE_LANDING) {
+            landed_state = MAV_LANDED_STATE_ON_GROUND;
+            armed = false;      // PX4 auto-disarms after touchdown
+        }
+    }
+
+    while (ack_count > 0 && acks[ack_head].due <= now) {
+        const PendingAck& a = acks[ack_head];
+
+        mavlink_message_t msg;
+        claimSequence();
+        mavlink_msg_command_ack_pack(
+            sysid_, MAV_COMP_ID_AUTOPILOT1, &msg,
+            a.command, a.result, 0, 0, a.target_sys, a.target_comp);
+        send(msg);
+        stats_.acks_sent++;
+
+        ack_head = (ack_head + 1) % ACK_QUEUE;
+        ack_count--;
+    }
+
+    for (int s = 0; s < STREAM_COUNT; s++) {
+        if (period[s] == GcsClock::duration::zero() || now < next_due[s])
+            continue;
+
+        sendStream(static_cast<Stream>(s));
+
+        // Skip missed periods after a stall instead of bursting
+        next_due[s] += period[s];
+        if (next_due[s] <= now)
+            next_due[s] = now + period[s];
+    }
+}
+
+// PX4 semantics: -1 stops the stream, 0 restores its default rate.
+// The heartbeat is not negotiable.
+uint8_t SimVehicle::setInterval(uint32_t msgid, float interval_us, GcsClock::time_point now) {
+    Stream s;
+    switch (msgid) {
+    case MAVLINK_MSG_ID_SYS_STATUS:          s = SYS_STATUS;      break;
+    case MAVLINK_MSG_ID_ESTIMATOR_STATUS:    s = ESTIMATOR;       break;
+    case MAVLINK_MSG_ID_EXTENDED_SYS_STATE:  s = EXTENDED_STATE;  break;
+    case MAVLINK_MSG_ID_ATTITUDE:            s = ATTITUDE;        break;
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT: s = GLOBAL_POSITION; break;
+    case MAVLINK_MSG_ID_HIGHRES_IMU:         s = HIGHRES_IMU;     break;
+    default:
+        return MAV_RESULT_UNSUPPORTED;
+    }
+
+    if (interval_us < 0)
+        period[s] = GcsClock::duration::zero();
+    else if (interval_us == 0)
+        period[s] = default_period[s];
+    else
+        period[s] = chrono::duration_cast<GcsClock::duration>(
+            chrono::duration<double, micro>(interval_us));
+
+    next_due[s] = now + period[s];
+    stats_.intervals_set++;
+    return MAV_RESULT_ACCEPTED;
+}
+
+void SimVehicle::sendStream(Stream s) {
+    mavlink_message_t msg;
+    claimSequence();
+
+    switch (s) {
+    case HEARTBEAT: {
+        uint8_t base_mode = MAV_MODE_FLAG_CUSTOM_MODE_ENABLED;
+        if (armed)
+            base_mode |= MAV_MODE_FLAG_SAFETY_ARMED;
+
+        mavlink_msg_heartbeat_pack(
+            sysid_, MAV_COMP_ID_AUTOPILOT1, &msg,
+            MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, base_mode, custom_mode,
+            armed ? MAV_STATE_ACTIVE : MAV_STATE_STANDBY);
+        break;
+    }
+    case SYS_STATUS: {
+        mavlink_sys_status_t sys{};
+        sys.voltage_battery = 16200;
+        sys.current_battery = -1;
+        sys.battery_remaining = 80;
+        mavlink_msg_sys_status_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &sys);
+        break;
+    }
+    case ESTIMATOR: {
+        mavlink_estimator_status_t est{};
+        est.flags = 0x3;    // attitude + velocity OK
+        mavlink_msg_estimator_status_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &est);
+        break;
+    }
+    case EXTENDED_STATE: {
+        mavlink_extended_sys_state_t ext{};
+        ext.landed_state = landed_state;
+        mavlink_msg_extended_sys_state_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &ext);
+        break;
+    }
+    case ATTITUDE: {
+        mavlink_attitude_t att{};
+        mavlink_msg_attitude_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &att);
+        break;
+    }
+    case GLOBAL_POSITION: {
+        mavlink_global_position_int_t pos{};
+        pos.lat = 473977420;
+        pos.lon = 85455940;
+        pos.relative_alt = landed_state == MAV_LANDED_STATE_IN_AIR ? 10000 : 0;
+        mavlink_msg_global_position_int_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &pos);
+        break;
+    }
+    case HIGHRES_IMU: {
+        mavlink_highres_imu_t imu{};
+        imu.zacc = -9.81f;
+        mavlink_msg_highres_imu_encode(sysid_, MAV_COMP_ID_AUTOPILOT1, &msg, &imu);
+        break;
+    }
+    default:
+        return;
+    }
+
+    send(msg);
+}
+
+void SimVehicle::claimSequence() {
+    mavlink_get_channel_status(MAVLINK_COMM_0)->current_tx_seq = tx_seq;
+}
+
+void SimVehicle::send(const mavlink_message_t& msg) {
+    tx_seq = static_cast<uint8_t>(msg.seq + 1);
+
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t len = mavlink_msg_to_send_buffer(buf, &msg);
+
+    if (sendto(sockfd, buf, len, 0,
+               reinterpret_cast<const sockaddr*>(&config->gcs),
+               sizeof(config->gcs)) < 0) {
+        if (errno != EAGAIN && errno != ECONNREFUSED)
+            LOG_WARN("SIM", "SysID {} send failed: {}", sysid_, strerror(errno));
+        stats_.send_errors++;
+        return;
+    }
+    stats_.frames_sent++;
+}
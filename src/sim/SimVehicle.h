@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <netinet/in.h>
+#include <vector>
+
+#include "core/GcsClock.h"
+#include "param/ParamCache.h"
+#include "telemetry/MavlinkFrameScanner.h"
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+// Shared by every simulated vehicle
+struct SimConfig {
+    int vehicles = 1;
+    int base_port = 18570;            // vehicle i listens on base_port + i
+    uint8_t base_sysid = 1;           // GCS sysids are skipped
+    sockaddr_in gcs{};                // where telemetry goes
+
+    // Stream rates in Hz (0 disables the stream)
+    double heartbeat_hz = 1.0;
+    double sys_status_hz = 2.0;
+    double estimator_hz = 2.0;
+    double extended_state_hz = 5.0;
+    double attitude_hz = 10.0;
+    double position_hz = 5.0;
+    double imu_hz = 50.0;             // HIGHRES_IMU: nobody at the GCS decodes it
+
+    int ack_delay_ms = 20;
+    double ack_drop = 0.0;            // probability an ACK is never sent
+    int takeoff_ms = 3000;            // TAKEOFF -> IN_AIR
+    int land_ms = 3000;               // LANDING -> ON_GROUND, then disarm
+
+    size_t mission_items = 0;         // onboard mission at start (survey grid)
+    double mission_drop = 0.0;        // probability a mission frame is lost, each way
+
+    size_t params = 1000;             // onboard parameters, roughly PX4's count
+    double param_rate_hz = 200;       // PARAM_REQUEST_LIST pace, about a 57600 baud radio
+    double param_drop = 0.0;          // probability a parameter frame is lost, each way
+
+    uint32_t seed = 1;
+};
+
+// -------------------------------------------------
+// One fake PX4 autopilot on its own UDP port. Emits
+// the streams the GCS gates commands on, answers
+// COMMAND_LONG with a delayed (or lost) COMMAND_ACK
+// and walks the landed state on TAKEOFF/LAND. Speaks
+// the mission protocol both ways, PX4-style: uploads
+// are pulled one item at a time, re-requesting the
+// expected item whenever anything else arrives.
+// Parameters stream at a radio's pace, carry a
+// `_HASH_CHECK`, and answer AUTOPILOT_VERSION requests.
+// SET_MESSAGE_INTERVAL retunes or stops any stream.
+// -------------------------------------------------
+class SimVehicle {
+public:
+    struct Stats {
+        uint64_t frames_sent = 0;
+        uint64_t commands_rx = 0;
+        uint64_t acks_sent = 0;
+        uint64_t acks_dropped = 0;
+        uint64_t send_errors = 0;
+        uint64_t mission_items_rx = 0;    // uploaded items stored
+        uint64_t mission_items_tx = 0;    // items served to downloads
+        uint64_t mission_dropped = 0;     // lost to mission_drop
+        uint64_t params_tx = 0;           // PARAM_VALUEs sent
+        uint64_t params_set = 0;          // PARAM_SETs applied
+        uint64_t params_dropped = 0;      // lost to param_drop
+        uint64_t intervals_set = 0;       // SET_MESSAGE_INTERVALs applied
+    };
+
+    SimVehicle() = default;
+    ~SimVehicle();
+
+    SimVehicle(const SimVehicle&) = delete;
+    SimVehicle& operator=(const SimVehicle&) = delete;
+
+    bool start(
+        const SimConfig& config,
+        int index,
+        uint8_t sysid,
+        GcsClock::time_point now);
+
+    // Drains the socket; handles COMMAND_LONG, mission and parameter traffic
+    void onReadable(GcsClock::time_point now);
+
+    // Streams, due ACKs and state transitions up to now
+    void tick(GcsClock::time_point now);
+
+    int fd() const { return sockfd; }
+    uint8_t sysid() const { return sysid_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    enum Stream {
+        HEARTBEAT,
+        SYS_STATUS,
+        ESTIMATOR,
+        EXTENDED_STATE,
+        ATTITUDE,
+        GLOBAL_POSITION,
+        HIGHRES_IMU,
+        STREAM_COUNT
+    };
+
+    struct PendingAck {
+        GcsClock::time_point due;
+        uint16_t command;
+        uint8_t result;
+        uint8_t target_sys;
+        uint8_t target_comp;
+    };
+
+    // Every ACK shares one delay, so due times stay in FIFO order
+    static constexpr size_t ACK_QUEUE = 16;
+
+    void handleCommand(const MavlinkFrameView& frame, GcsClock::time_point now);
+    uint8_t execute(const mavlink_command_long_t& cmd, GcsClock::time_point now);
+
+    // ---- Mission protocol ----
+    void handleMission(const MavlinkFrameView& frame);
+    void onMissionCount(const mavlink_mission_count_t& count);
+    void onMissionItem(const mavlink_mission_item_int_t& item);
+    void sendMissionCount();
+    void sendMissionItem(uint16_t seq);
+    void sendMissionRequest(uint16_t seq);
+    void sendMissionAck(uint8_t result);
+    bool missionLost();
+
+    // ---- Parameter protocol ----
+    void handleParam(const MavlinkFrameView& frame);
+    void sendParam(int index);         // -1 = _HASH_CHECK
+    void streamParams(GcsClock::time_point now);
+    void rehashParams();
+    int findParam(const char* id) const;
+    bool paramLost();
+
+    void sendAutopilotVersion();
+
+    void sendStream(Stream s);
+    uint8_t setInterval(uint32_t msgid, float interval_us, GcsClock::time_point now);
+
+    // Every vehicle keeps its own sequence, though all encode on channel 0
+    void claimSequence();
+    void send(const mavlink_message_t& msg);
+
+    uint32_t random();
+
+    const SimConfig* config = nullptr;
+    int sockfd = -1;
+    uint8_t sysid_ = 0;
+    MavlinkFrameScanner scanner;
+
+    // ---- Autopilot state ----
+    bool armed = false;
+    uint8_t landed_state = MAV_LANDED_STATE_ON_GROUND;
+    uint32_t custom_mode = 0;
+    GcsClock::time_point transition_at{};    // end of TAKEOFF / LANDING
+
+    std::vector<mavlink_mission_item_int_t> mission;
+    std::vector<mavlink_mission_item_int_t> upload;   // being received
+    bool receiving = false;
+    uint16_t upload_next = 0;
+    uint8_t mission_peer_sys = 0;
+    uint8_t mission_peer_comp = 0;
+
+    std::vector<VehicleParam> params;
+    uint32_t param_hash = 0;
+    bool param_streaming = false;
+    size_t param_next = 0;                   // next index to stream
+    GcsClock::time_point param_due{};
+    GcsClock::duration param_period{};
+
+    GcsClock::duration default_period[STREAM_COUNT]{};
+    GcsClock::duration period[STREAM_COUNT]{};
+    GcsClock::time_point next_due[STREAM_COUNT]{};
+
+    PendingAck acks[ACK_QUEUE];
+    size_t ack_head = 0;
+    size_t ack_count = 0;
+
+    uint8_t tx_seq = 0;
+    uint32_t rng = 1;
+    Stats stats_;
+};
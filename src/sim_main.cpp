@@ -0,0 +1,231 @@
+#include <iostream>
+#include <arpa/inet.h>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sys/signalfd.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+#include "comm/GcsIdentity.h"
+#include "core/EventLoop.h"
+#include "core/GcsClock.h"
+#include "core/Logger.h"
+#include "sim/SimVehicle.h"
+
+// -------------------------------------------------
+// gcs_sim: a fleet of fake PX4 autopilots on local
+// UDP ports for load-testing my_gcs without SITL.
+// Vehicle i listens on base port + i and takes the
+// next free sysid from base sysid, skipping the ids
+// the GCS itself sends under.
+// -------------------------------------------------
+
+static constexpr int SIM_TICK_MS = 5;
+static constexpr int SIM_STATS_PERIOD_MS = 5000;
+
+static void usage(const char* argv0) {
+    cerr << "usage: " << argv0 << " [options]\n"
+         << "  --vehicles N          fake autopilots (default 1)\n"
+         << "  --base-port P         first vehicle port (default 18570)\n"
+         << "  --base-sysid S        first vehicle sysid (default 1)\n"
+         << "  --gcs HOST:PORT       telemetry destination (default 127.0.0.1:14550)\n"
+         << "  --rates HB,SYS,EST,EXT[,ATT,POS,IMU]  stream rates in Hz\n"
+         << "                        (default 1,2,2,5,10,5,50)\n"
+         << "  --ack-delay MS        COMMAND_ACK delay (default 20)\n"
+         << "  --ack-drop P          probability an ACK is lost (default 0)\n"
+         << "  --takeoff-ms MS       takeoff duration (default 3000)\n"
+         << "  --land-ms MS          landing duration (default 3000)\n"
+         << "  --mission-items N     onboard mission size at start (default 0)\n"
+         << "  --mission-drop P      probability a mission frame is lost (default 0)\n"
+         << "  --params N            onboard parameters (default 1000)\n"
+         << "  --param-rate HZ       PARAM_VALUEs per second while streaming (default 200,\n"
+         << "                        0 = unpaced)\n"
+         << "  --param-drop P        probability a parameter frame is lost (default 0)\n"
+         << "  --duration S          exit after S seconds (default: until signalled)\n"
+         << "  --seed N              random seed (default 1)\n";
+}
+
+static bool parseEndpoint(const char* text, sockaddr_in& out) {
+    char host[64];
+    int port = 0;
+    if (sscanf(text, "%63[^:]:%d", host, &port) != 2 || port <= 0 || port > 65535)
+        return false;
+
+    out = sockaddr_in{};
+    out.sin_family = AF_INET;
+    out.sin_port = htons(static_cast<uint16_t>(port));
+    return inet_pton(AF_INET, host, &out.sin_addr) == 1;
+}
+
+int main(int argc, char** argv) {
+
+    SimConfig config;
+    parseEndpoint("127.0.0.1:14550", config.gcs);
+    double duration_s = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+
+        if (strcmp(argv[i], "--vehicles") == 0 && has_value) {
+            config.vehicles = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--base-port") == 0 && has_value) {
+            config.base_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--base-sysid") == 0 && has_value) {
+            config.base_sysid = static_cast<uint8_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--gcs") == 0 && has_value) {
+            if (!parseEndpoint(argv[++i], config.gcs)) {
+                usage(argv[0]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--rates") == 0 && has_value) {
+            const int n = sscanf(argv[++i], "%lf,%lf,%lf,%lf,%lf,%lf,%lf",
+                                 &config.heartbeat_hz, &config.sys_status_hz,
+                                 &config.estimator_hz, &config.extended_state_hz,
+                                 &config.attitude_hz, &config.position_hz, &config.imu_hz);
+            if (n != 4 && n != 7) {
+                usage(argv[0]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--ack-delay") == 0 && has_value) {
+            config.ack_delay_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ack-drop") == 0 && has_value) {
+            config.ack_drop = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--takeoff-ms") == 0 && has_value) {
+            config.takeoff_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--land-ms") == 0 && has_value) {
+            config.land_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--mission-items") == 0 && has_value) {
+            config.mission_items = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--mission-drop") == 0 && has_value) {
+            config.mission_drop = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--params") == 0 && has_value) {
+            config.params = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--param-rate") == 0 && has_value) {
+            config.param_rate_hz = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--param-drop") == 0 && has_value) {
+            config.param_drop = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && has_value) {
+            duration_s = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            config.seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else {
+            usage(argv[0]);
+            return -1;
+        }
+    }
+
+    // GCS echoes are dropped by sysid, so a vehicle must never use one
+    vector<uint8_t> sysids;
+    for (int id = config.base_sysid;
+         id > 0 && id <= 255 && int(sysids.size()) < config.vehicles; id++) {
+        if (!isGcsSystemId(static_cast<uint8_t>(id)))
+            sysids.push_back(static_cast<uint8_t>(id));
+    }
+
+    if (config.vehicles < 1 ||
+        int(sysids.size()) < config.vehicles ||
+        config.base_port + config.vehicles - 1 > 65535) {
+        cerr << "Vehicle count does not fit the sysid/port range\n";
+        return -1;
+    }
+
+    // Indices are 16-bit and 65535 marks _HASH_CHECK
+    if (config.params >= 65535) {
+        cerr << "Parameter count must be below 65535\n";
+        return -1;
+    }
+
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &stop_signals, nullptr);
+    int sigfd = signalfd(-1, &stop_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+    EventLoop loop;
+    if (!loop.start()) {
+        cerr << "Failed to start event loop\n";
+        return -1;
+    }
+
+    const GcsClock::time_point start = GcsClock::now();
+    unique_ptr<SimVehicle[]> vehicles(new SimVehicle[config.vehicles]);
+
+    for (int i = 0; i < config.vehicles; i++) {
+        SimVehicle& v = vehicles[i];
+        if (!v.start(config, i, sysids[i], start)) {
+            cerr << "Failed to start vehicle " << i
+                 << " on port " << config.base_port + i << "\n";
+            return -1;
+        }
+        loop.addReader(v.fd(), [&v]() { v.onReadable(GcsClock::now()); });
+    }
+
+    LOG_INFO("SIM", "{} vehicles on ports {}-{}, sysids {}-{}",
+             config.vehicles,
+             config.base_port, config.base_port + config.vehicles - 1,
+             sysids.front(), sysids[config.vehicles - 1]);
+
+    auto totals = [&]() {
+        SimVehicle::Stats t;
+        for (int i = 0; i < config.vehicles; i++) {
+            const SimVehicle::Stats& s = vehicles[i].stats();
+            t.frames_sent += s.frames_sent;
+            t.commands_rx += s.commands_rx;
+            t.acks_sent += s.acks_sent;
+            t.acks_dropped += s.acks_dropped;
+            t.send_errors += s.send_errors;
+            t.mission_items_rx += s.mission_items_rx;
+            t.mission_items_tx += s.mission_items_tx;
+            t.mission_dropped += s.mission_dropped;
+            t.params_tx += s.params_tx;
+            t.params_set += s.params_set;
+            t.params_dropped += s.params_dropped;
+            t.intervals_set += s.intervals_set;
+        }
+        return t;
+    };
+
+    // ---------- Streams, ACKs, state transitions ----------
+    loop.addTimer(SIM_TICK_MS, [&]() {
+        const GcsClock::time_point now = GcsClock::now();
+        for (int i = 0; i < config.vehicles; i++)
+            vehicles[i].tick(now);
+
+        if (duration_s > 0 &&
+            chrono::duration<double>(now - start).count() >= duration_s)
+            loop.stop();
+    });
+
+    loop.addTimer(SIM_STATS_PERIOD_MS, [&]() {
+        SimVehicle::Stats t = totals();
+        LOG_INFO("SIM", "sent {} frames, {} commands, {} acks ({} dropped)",
+                 t.frames_sent, t.commands_rx, t.acks_sent, t.acks_dropped);
+    });
+
+    loop.addReader(sigfd, [&]() {
+        signalfd_siginfo info;
+        if (read(sigfd, &info, sizeof(info)) > 0)
+            loop.stop();
+    });
+
+    loop.run();
+
+    SimVehicle::Stats t = totals();
+    LOG_INFO("SIM", "done: {} frames, {} commands, {} acks, {} dropped, {} send errors",
+             t.frames_sent, t.commands_rx, t.acks_sent, t.acks_dropped, t.send_errors);
+    LOG_INFO("SIM", "mission: {} items uploaded, {} items downloaded, {} frames lost",
+             t.mission_items_rx, t.mission_items_tx, t.mission_dropped);
+    LOG_INFO("SIM", "params: {} values sent, {} set, {} frames lost",
+             t.params_tx, t.params_set, t.params_dropped);
+    LOG_INFO("SIM", "streams: {} intervals set", t.intervals_set);
+
+    close(sigfd);
+    return 0;
+}
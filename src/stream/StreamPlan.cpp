@@ -0,0 +1,108 @@
+#include "stream/StreamPlan.h"
+#include "core/Logger.h"
+
+#include <cstdio>
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+const char* streamConsumerName(StreamConsumer consumer) {
+    switch (consumer) {
+    case StreamConsumer::PARSER:   return "parser";
+    case StreamConsumer::RECORDER: return "recorder";
+    case StreamConsumer::ROUTER:   return "router";
+    case StreamConsumer::USER:     return "user";
+    default:                       return "unknown";
+    }
+}
+
+StreamPlan::StreamPlan() {
+    requests_.reserve(32);
+}
+
+bool StreamPlan::isStream(uint32_t msgid) {
+    if (msgid >= STREAM_MSGID_SLOTS)
+        return false;
+
+    switch (msgid) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    case MAVLINK_MSG_ID_PARAM_VALUE:
+    case MAVLINK_MSG_ID_MISSION_ITEM:
+    case MAVLINK_MSG_ID_MISSION_REQUEST:
+    case MAVLINK_MSG_ID_MISSION_COUNT:
+    case MAVLINK_MSG_ID_MISSION_ACK:
+    case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+    case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+    case MAVLINK_MSG_ID_COMMAND_LONG:
+    case MAVLINK_MSG_ID_COMMAND_ACK:
+    case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+    case MAVLINK_MSG_ID_TIMESYNC:
+    case MAVLINK_MSG_ID_LOG_ENTRY:
+    case MAVLINK_MSG_ID_LOG_DATA:
+    case MAVLINK_MSG_ID_AUTOPILOT_VERSION:
+    case MAVLINK_MSG_ID_MESSAGE_INTERVAL:
+    case MAVLINK_MSG_ID_STATUSTEXT:
+    case MAVLINK_MSG_ID_PROTOCOL_VERSION:
+    case MAVLINK_MSG_ID_EVENT:
+    case MAVLINK_MSG_ID_CURRENT_EVENT_SEQUENCE:
+        return false;
+    default:
+        return true;
+    }
+}
+
+bool StreamPlan::request(StreamConsumer who, uint32_t msgid, float hz) {
+    if (!isStream(msgid) || hz < 0)
+        return false;
+
+    const uint8_t bit = uint8_t(1) << static_cast<int>(who);
+
+    if (slot_[msgid]) {
+        StreamRequest& r = requests_[slot_[msgid] - 1];
+        if (hz > r.hz)
+            r.hz = hz;
+        r.consumers |= bit;
+        return true;
+    }
+
+    StreamRequest r;
+    r.msgid = msgid;
+    r.hz = hz;
+    r.consumers = bit;
+    requests_.push_back(r);
+    slot_[msgid] = static_cast<uint16_t>(requests_.size());
+    return true;
+}
+
+void StreamPlan::keepUnrequested(StreamConsumer who) {
+    keepers_ |= uint8_t(1) << static_cast<int>(who);
+}
+
+void StreamPlan::log() const {
+    for (const StreamRequest& r : requests_) {
+        char who[48] = {};
+        size_t n = 0;
+        for (int c = 0; c < static_cast<int>(StreamConsumer::COUNT); c++) {
+            if (r.consumers & (1 << c))
+                n += std::snprintf(who + n, sizeof(who) - n, "%s%s", n ? "," : "",
+                                   streamConsumerName(static_cast<StreamConsumer>(c)));
+        }
+
+        if (r.hz > 0)
+            LOG_INFO("STREAM", "msgid {} at {} Hz ({})", r.msgid, r.hz, who);
+        else
+            LOG_INFO("STREAM", "msgid {} off ({})", r.msgid, who);
+    }
+
+    if (disablesUnrequested()) {
+        LOG_INFO("STREAM", "Unrequested streams are turned off");
+        return;
+    }
+
+    for (int c = 0; c < static_cast<int>(StreamConsumer::COUNT); c++) {
+        if (keepers_ & (1 << c))
+            LOG_INFO("STREAM", "Unrequested streams kept for the {}",
+                     streamConsumerName(static_cast<StreamConsumer>(c)));
+    }
+}
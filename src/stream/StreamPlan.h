@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Message ids the manager can measure and set; matches the dispatch table
+static constexpr uint32_t STREAM_MSGID_SLOTS = 512;
+
+// Who asked for a stream. A consumer that needs the vehicle's own
+// streams untouched (a tlog, a downstream GCS) keeps the unrequested ones.
+enum class StreamConsumer : uint8_t {
+    PARSER,         // built-in telemetry handlers
+    RECORDER,
+    ROUTER,
+    USER,           // --stream on the command line
+    COUNT
+};
+
+const char* streamConsumerName(StreamConsumer consumer);
+
+struct StreamRequest {
+    uint32_t msgid = 0;
+    float hz = 0;               // 0: wanted off
+    uint8_t consumers = 0;      // bit per StreamConsumer
+};
+
+// -------------------------------------------------
+// Fleet-wide stream wishes, built once at startup.
+// Every consumer declares the messages it decodes and
+// how often; a stream asked for twice runs at the
+// higher rate. Streams nobody asked for are turned off
+// unless a consumer keeps them. Read-only once the
+// GroundStation has it, so every vehicle shares it.
+// -------------------------------------------------
+class StreamPlan {
+public:
+    StreamPlan();
+
+    // False for an id past STREAM_MSGID_SLOTS or one that is not a
+    // periodic stream (protocol replies are never rate-managed)
+    bool request(StreamConsumer who, uint32_t msgid, float hz);
+
+    void keepUnrequested(StreamConsumer who);
+    bool disablesUnrequested() const { return keepers_ == 0; }
+
+    // The request for msgid, nullptr when nobody asked
+    const StreamRequest* find(uint32_t msgid) const {
+        return msgid < STREAM_MSGID_SLOTS && slot_[msgid]
+            ? &requests_[slot_[msgid] - 1] : nullptr;
+    }
+
+    const std::vector<StreamRequest>& requests() const { return requests_; }
+
+    void log() const;
+
+    // Periodic telemetry, as opposed to handshake replies, events
+    // and heartbeats, which SET_MESSAGE_INTERVAL must never touch
+    static bool isStream(uint32_t msgid);
+
+private:
+    std::vector<StreamRequest> requests_;
+    uint16_t slot_[STREAM_MSGID_SLOTS] = {};    // 0 = none, else index + 1
+    uint8_t keepers_ = 0;
+};
@@ -0,0 +1,269 @@
+#include "stream/StreamRates.h"
+#include "comm/GcsIdentity.h"
+#include "comm/TxQueue.h"
+#include "core/Logger.h"
+#include "core/Metrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+static constexpr chrono::milliseconds STREAM_ACK_TIMEOUT{STREAM_ACK_TIMEOUT_MS};
+static constexpr chrono::milliseconds STREAM_CHECK_PERIOD{STREAM_CHECK_PERIOD_MS};
+
+const char* streamStateName(StreamRates::State state) {
+    switch (state) {
+    case StreamRates::State::IDLE:       return "IDLE";
+    case StreamRates::State::APPLYING:   return "APPLYING";
+    case StreamRates::State::MONITORING: return "MONITORING";
+    case StreamRates::State::LINK_LOST:  return "LINK_LOST";
+    }
+    return "UNKNOWN";
+}
+
+StreamRates::StreamRates(
+    TxQueue& tx,
+    uint8_t target_sys,
+    uint8_t target_comp,
+    const sockaddr_in& vehicle_addr,
+    const StreamCounters& counters)
+    : txQueue(tx),
+      target_sysid(target_sys),
+      target_compid(target_comp),
+      px4_addr(vehicle_addr),
+      counters_(counters) {
+
+    for (uint32_t id = 0; id < STREAM_MSGID_SLOTS; id++) {
+        target_hz_[id].store(-1.0f, memory_order_relaxed);
+        measured_hz_[id].store(-1.0f, memory_order_relaxed);
+    }
+
+    ack_timer_.fn = onAckTimer;
+    ack_timer_.owner = this;
+    check_timer_.fn = onCheckTimer;
+    check_timer_.owner = this;
+}
+
+// ---------------- Wire ----------------
+// param2: interval in us, -1 disables
+bool StreamRates::sendInterval(uint32_t msgid) {
+    const float hz = target_hz_[msgid].load(memory_order_relaxed);
+    const float interval_us = hz > 0 ? 1e6f / hz : -1.0f;
+
+    mavlink_message_t msg;
+    mavlink_msg_command_long_pack(
+        GCS_COMMAND_SYS_ID, GCS_COMP_ID, &msg,
+        target_sysid, target_compid,
+        MAV_CMD_SET_MESSAGE_INTERVAL, 0,
+        static_cast<float>(msgid), interval_us, 0, 0, 0, 0, 0);
+
+    Metrics::local().add(Counter::STREAM_INTERVALS_SENT);
+    return txQueue.enqueue(txQueue.pushFrame(msg), px4_addr);
+}
+
+// -------------------------------------------------
+void StreamRates::update(StreamAckQueue& acks, bool link_up) {
+    CommandAckData ack;
+    while (acks.pop(ack))
+        onAck(ack);
+
+    if (!plan_ || !wheel_)
+        return;
+
+    if (!link_up) {
+        if (state_ == State::APPLYING || state_ == State::MONITORING)
+            park();
+        return;
+    }
+
+    if (state_ == State::IDLE || state_ == State::LINK_LOST)
+        apply();
+}
+
+void StreamRates::apply() {
+    if (applications_++)
+        LOG_INFO("STREAM", "SysID {} back, setting streams again", target_sysid);
+
+    queue_head_ = queue_len_ = 0;
+
+    for (uint32_t id = 0; id < STREAM_MSGID_SLOTS; id++) {
+        entries_[id] = Entry{};
+        target_hz_[id].store(-1.0f, memory_order_relaxed);
+    }
+
+    for (const StreamRequest& r : plan_->requests()) {
+        target_hz_[r.msgid].store(r.hz, memory_order_relaxed);
+        enqueue(r.msgid);
+    }
+
+    // Whatever it streamed so far that nobody asked for
+    if (plan_->disablesUnrequested()) {
+        for (uint32_t id = 0; id < STREAM_MSGID_SLOTS; id++) {
+            if (plan_->find(id) || !StreamPlan::isStream(id) ||
+                counters_.frames[id].load(memory_order_relaxed) == 0)
+                continue;
+            target_hz_[id].store(0.0f, memory_order_relaxed);
+            enqueue(id);
+        }
+    }
+
+    state_ = State::APPLYING;
+    sendNext();
+}
+
+void StreamRates::enqueue(uint32_t msgid) {
+    Entry& e = entries_[msgid];
+    if (e.queued || static_cast<int>(msgid) == in_flight_)
+        return;
+
+    e.queued = true;
+    e.status = Status::PENDING;
+    queue_[(queue_head_ + queue_len_++) % STREAM_MSGID_SLOTS] = static_cast<uint16_t>(msgid);
+}
+
+void StreamRates::sendNext() {
+    if (in_flight_ >= 0)
+        return;
+
+    if (queue_len_ == 0) {
+        startMonitoring();
+        return;
+    }
+
+    const uint32_t msgid = queue_[queue_head_];
+    queue_head_ = (queue_head_ + 1) % STREAM_MSGID_SLOTS;
+    queue_len_--;
+    entries_[msgid].queued = false;
+
+    // A full TX queue costs a try, like a lost frame
+    in_flight_ = static_cast<int>(msgid);
+    tries_ = 0;
+    sendInterval(msgid);
+    wheel_->schedule(ack_timer_, STREAM_ACK_TIMEOUT);
+}
+
+void StreamRates::onAck(const CommandAckData& ack) {
+    if (in_flight_ < 0 || ack.result == MAV_RESULT_IN_PROGRESS)
+        return;     // late duplicate of an ACK already taken
+
+    Entry& e = entries_[in_flight_];
+    if (ack.result == MAV_RESULT_ACCEPTED) {
+        e.status = Status::APPLIED;
+    } else {
+        e.status = Status::REJECTED;
+        LOG_INFO("STREAM", "SysID {} refused an interval for msgid {} (result {})",
+                 target_sysid, in_flight_, ack.result);
+    }
+
+    wheel_->cancel(ack_timer_);
+    in_flight_ = -1;
+    sendNext();
+}
+
+void StreamRates::onAckTimer(void* self, uint32_t) {
+    static_cast<StreamRates*>(self)->onAckTimeout();
+}
+
+void StreamRates::onAckTimeout() {
+    if (in_flight_ < 0)
+        return;
+
+    if (tries_ < STREAM_MAX_RETRIES) {
+        tries_++;
+        sendInterval(static_cast<uint32_t>(in_flight_));
+        wheel_->schedule(ack_timer_, STREAM_ACK_TIMEOUT);
+        return;
+    }
+
+    // The next check window shows whether it took anyway
+    entries_[in_flight_].status = Status::NO_ACK;
+    in_flight_ = -1;
+    sendNext();
+}
+
+void StreamRates::park() {
+    state_ = State::LINK_LOST;
+    in_flight_ = -1;
+    queue_head_ = queue_len_ = 0;
+    wheel_->cancel(ack_timer_);
+    wheel_->cancel(check_timer_);
+}
+
+// ---------------- Measurement ----------------
+void StreamRates::startMonitoring() {
+    state_ = State::MONITORING;
+
+    for (uint32_t id = 0; id < STREAM_MSGID_SLOTS; id++)
+        baseline_[id] = counters_.frames[id].load(memory_order_relaxed);
+    baseline_at_ = wheel_->now();
+
+    wheel_->schedule(check_timer_, STREAM_CHECK_PERIOD);
+}
+
+void StreamRates::onCheckTimer(void* self, uint32_t) {
+    static_cast<StreamRates*>(self)->check();
+}
+
+void StreamRates::check() {
+    const double elapsed = chrono::duration<double>(wheel_->now() - baseline_at_).count();
+    if (elapsed <= 0) {
+        wheel_->schedule(check_timer_, STREAM_CHECK_PERIOD);
+        return;
+    }
+
+    for (uint32_t id = 0; id < STREAM_MSGID_SLOTS; id++) {
+        const uint32_t count = counters_.frames[id].load(memory_order_relaxed);
+        const uint32_t frames = count - baseline_[id];
+        baseline_[id] = count;
+
+        const float target = target_hz_[id].load(memory_order_relaxed);
+        if (frames == 0 && target < 0)
+            continue;
+
+        const double rate = frames / elapsed;
+        measured_hz_[id].store(static_cast<float>(rate), memory_order_relaxed);
+
+        // A stream that started after the plan went out
+        if (target < 0) {
+            if (plan_->disablesUnrequested() && StreamPlan::isStream(id)) {
+                target_hz_[id].store(0.0f, memory_order_relaxed);
+                enqueue(id);
+            }
+            continue;
+        }
+
+        Entry& e = entries_[id];
+        if (e.status == Status::REJECTED)
+            continue;
+
+        const double expected = target * elapsed;
+        const bool off = std::fabs(frames - expected) >
+                         std::max(expected * STREAM_RATE_TOLERANCE, 2.0);
+        if (!off)
+            continue;
+
+        if (e.reapplied < STREAM_MAX_REAPPLY) {
+            e.reapplied++;
+            Metrics::local().add(Counter::STREAMS_REAPPLIED);
+            LOG_DEBUG("STREAM", "SysID {} msgid {} at {} Hz, wanted {}; setting again",
+                      target_sysid, id, rate, target);
+            enqueue(id);
+        } else if (!e.warned) {
+            e.warned = true;
+            LOG_WARN("STREAM", "SysID {} msgid {} stays at {} Hz, wanted {}",
+                     target_sysid, id, rate, target);
+        }
+    }
+
+    baseline_at_ = wheel_->now();
+
+    if (queue_len_ != 0) {
+        state_ = State::APPLYING;
+        sendNext();
+        return;
+    }
+
+    wheel_->schedule(check_timer_, STREAM_CHECK_PERIOD);
+}
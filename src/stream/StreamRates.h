@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <netinet/in.h>
+
+#include "core/GcsClock.h"
+#include "core/TimerWheel.h"
+#include "stream/StreamPlan.h"
+#include "telemetry/TelemetryData.h"
+
+class TxQueue;
+
+static constexpr int STREAM_ACK_TIMEOUT_MS = 500;
+static constexpr int STREAM_MAX_RETRIES = 3;
+
+// Measurement window; a stream off its target by more than the
+// tolerance (or two frames, for slow ones) gets set again
+static constexpr int STREAM_CHECK_PERIOD_MS = 5000;
+static constexpr float STREAM_RATE_TOLERANCE = 0.25f;
+
+// Re-sends per stream per connection once the first one was accepted
+static constexpr int STREAM_MAX_REAPPLY = 3;
+
+// Frames per msgid from one vehicle. The parse side counts; the
+// control side and the metrics scraper read.
+struct StreamCounters {
+    std::atomic<uint32_t> frames[STREAM_MSGID_SLOTS] = {};
+
+    void count(uint32_t msgid) {
+        if (msgid >= STREAM_MSGID_SLOTS)
+            return;
+        std::atomic<uint32_t>& c = frames[msgid];
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+// -------------------------------------------------
+// One vehicle's streams brought in line with the
+// StreamPlan; control side only.
+//
+// Once the link is up, every planned stream gets a
+// MAV_CMD_SET_MESSAGE_INTERVAL, then every stream the
+// vehicle sends that nobody asked for is set to -1.
+// One command is in flight at a time: their ACKs all
+// carry the same command id.
+//
+// After that each check window compares the counted
+// rates with the targets: a stream that drifted, or
+// showed up unasked, is queued again. A lost link
+// parks everything; the plan is applied afresh when
+// traffic returns (a reboot forgets its intervals).
+// -------------------------------------------------
+class StreamRates {
+public:
+    enum class State : uint8_t {
+        IDLE,
+        APPLYING,
+        MONITORING,
+        LINK_LOST
+    };
+
+    enum class Status : uint8_t {
+        UNMANAGED,
+        PENDING,
+        APPLIED,
+        REJECTED,       // refused by the vehicle; left as it is
+        NO_ACK
+    };
+
+    StreamRates(
+        TxQueue& tx,
+        uint8_t target_sys,
+        uint8_t target_comp,
+        const sockaddr_in& vehicle_addr,
+        const StreamCounters& counters);
+
+    // Timers point back at this instance
+    StreamRates(const StreamRates&) = delete;
+    StreamRates& operator=(const StreamRates&) = delete;
+
+    // Must be the wheel of the thread calling update()
+    void setTimerWheel(TimerWheel* wheel) { wheel_ = wheel; }
+    void setPlan(const StreamPlan* plan) { plan_ = plan; }
+
+    // Drains the interval ACKs; `link_up` starts or parks the vehicle
+    void update(StreamAckQueue& acks, bool link_up);
+
+    State state() const { return state_; }
+    Status status(uint32_t msgid) const { return entries_[msgid].status; }
+
+    // Any thread. Target -1 when unmanaged, 0 when turned off;
+    // measured over the last check window, -1 before the first.
+    float targetHz(uint32_t msgid) const { return target_hz_[msgid].load(std::memory_order_relaxed); }
+    float measuredHz(uint32_t msgid) const { return measured_hz_[msgid].load(std::memory_order_relaxed); }
+
+    // Times the plan was applied: 1 + reconnects
+    uint32_t applications() const { return applications_; }
+
+private:
+    struct Entry {
+        Status status = Status::UNMANAGED;
+        uint8_t reapplied = 0;
+        bool queued = false;
+        bool warned = false;
+    };
+
+    void apply();
+    void enqueue(uint32_t msgid);
+    void sendNext();
+    bool sendInterval(uint32_t msgid);
+    void startMonitoring();
+    void park();
+
+    void onAck(const CommandAckData& ack);
+    static void onAckTimer(void* self, uint32_t);
+    static void onCheckTimer(void* self, uint32_t);
+    void onAckTimeout();
+    void check();
+
+    TxQueue& txQueue;
+    uint8_t target_sysid;
+    uint8_t target_compid;
+    sockaddr_in px4_addr;
+    const StreamCounters& counters_;
+    const StreamPlan* plan_ = nullptr;
+    TimerWheel* wheel_ = nullptr;
+
+    State state_ = State::IDLE;
+    uint32_t applications_ = 0;
+
+    Entry entries_[STREAM_MSGID_SLOTS];
+    std::atomic<float> target_hz_[STREAM_MSGID_SLOTS];
+    std::atomic<float> measured_hz_[STREAM_MSGID_SLOTS];
+
+    // FIFO of msgids to set; each is queued at most once
+    uint16_t queue_[STREAM_MSGID_SLOTS];
+    size_t queue_head_ = 0;
+    size_t queue_len_ = 0;
+
+    int in_flight_ = -1;            // msgid awaiting its ACK
+    int tries_ = 0;
+    TimerNode ack_timer_;
+
+    // Counts at the start of the check window
+    uint32_t baseline_[STREAM_MSGID_SLOTS] = {};
+    GcsClock::time_point baseline_at_{};
+    TimerNode check_timer_;
+};
+
+const char* streamStateName(StreamRates::State state);
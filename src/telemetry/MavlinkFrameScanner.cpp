@@ -0,0 +1,83 @@
+#include "telemetry/MavlinkFrameScanner.h"
+
+size_t MavlinkFrameScanner::check(
+    const uint8_t* p,
+    size_t avail,
+    MavlinkFrameView& view) {
+
+    size_t header_len;
+    size_t frame_len;
+
+    view.magic = p[0];
+
+    if (p[0] == MAVLINK_STX) {
+        if (avail < V2_HEADER_LEN)
+            return SIZE_MAX;
+
+        // Any flag but signing changes the framing in ways we can't parse
+        const uint8_t incompat = p[2];
+        if (incompat & ~MAVLINK_IFLAG_SIGNED) {
+            stats_.malformed++;
+            return 0;
+        }
+
+        view.payload_len = p[1];
+        view.seq = p[4];
+        view.sysid = p[5];
+        view.compid = p[6];
+        view.msgid = uint32_t(p[7]) | (uint32_t(p[8]) << 8) | (uint32_t(p[9]) << 16);
+
+        header_len = V2_HEADER_LEN;
+        frame_len = header_len + view.payload_len + MAVLINK_NUM_CHECKSUM_BYTES;
+        if (incompat & MAVLINK_IFLAG_SIGNED)
+            frame_len += MAVLINK_SIGNATURE_BLOCK_LEN;
+    } else {
+        if (avail < V1_HEADER_LEN)
+            return SIZE_MAX;
+
+        view.payload_len = p[1];
+        view.seq = p[2];
+        view.sysid = p[3];
+        view.compid = p[4];
+        view.msgid = p[5];
+
+        header_len = V1_HEADER_LEN;
+        frame_len = header_len + view.payload_len + MAVLINK_NUM_CHECKSUM_BYTES;
+    }
+
+    if (frame_len > avail)
+        return SIZE_MAX;
+
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(view.msgid);
+    if (!entry) {
+        // No CRC_EXTRA: cannot be validated, treat like a bad frame
+        stats_.unknown_msgid++;
+        return 0;
+    }
+
+    // v2 drops trailing zero bytes, so only v1 must reach min_msg_len
+    if (view.payload_len > entry->max_msg_len ||
+        (p[0] == MAVLINK_STX_MAVLINK1 && view.payload_len < entry->min_msg_len)) {
+        stats_.malformed++;
+        return 0;
+    }
+
+    // CRC covers everything after STX up to the checksum, then CRC_EXTRA
+    const size_t crc_len = header_len - 1 + view.payload_len;
+    uint16_t crc;
+    crc_init(&crc);
+    for (size_t k = 1; k <= crc_len; k++)
+        crc_accumulate(p[k], &crc);
+    crc_accumulate(entry->crc_extra, &crc);
+
+    const uint8_t* ck = p + header_len + view.payload_len;
+    if (crc != (uint16_t(ck[0]) | (uint16_t(ck[1]) << 8))) {
+        stats_.crc_errors++;
+        return 0;
+    }
+
+    view.frame = p;
+    view.frame_len = static_cast<uint16_t>(frame_len);
+    view.payload = p + header_len;
+    return frame_len;
+}
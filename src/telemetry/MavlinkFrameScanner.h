@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+// -------------------------------------------------
+// Borrowed view of one validated frame inside a
+// receive buffer. Valid only while that buffer is.
+// -------------------------------------------------
+struct MavlinkFrameView {
+    const uint8_t* frame = nullptr;    // starts at STX (null on the byte path)
+    uint16_t frame_len = 0;
+    const uint8_t* payload = nullptr;
+    uint8_t payload_len = 0;           // v2 payloads may be zero-truncated
+
+    uint8_t magic = 0;
+    uint8_t seq = 0;
+    uint8_t sysid = 0;
+    uint8_t compid = 0;
+    uint32_t msgid = 0;
+};
+
+// Decodes a payload straight from the view. MAVLink wire order equals
+// the packed struct layout on little-endian hosts, and v2 senders drop
+// trailing zero bytes, so the tail is zero-filled like mavlink_msg_*_decode.
+template <typename T>
+inline void decodePayload(const MavlinkFrameView& frame, T& out) {
+    const size_t n = frame.payload_len < sizeof(T) ? frame.payload_len : sizeof(T);
+    std::memcpy(&out, frame.payload, n);
+    if (n < sizeof(T))
+        std::memset(reinterpret_cast<uint8_t*>(&out) + n, 0, sizeof(T) - n);
+}
+
+// Builds a view over a frame completed by the byte-wise parser
+inline MavlinkFrameView frameViewOf(const mavlink_message_t& msg) {
+    MavlinkFrameView v;
+    v.payload = reinterpret_cast<const uint8_t*>(_MAV_PAYLOAD(&msg));
+    v.payload_len = msg.len;
+    v.magic = msg.magic;
+    v.seq = msg.seq;
+    v.sysid = msg.sysid;
+    v.compid = msg.compid;
+    v.msgid = msg.msgid;
+    return v;
+}
+
+// -------------------------------------------------
+// Datagram-level fast path. UDP datagrams carry whole
+// frames, so instead of stepping mavlink_parse_char per
+// byte we jump header to header, check the length and
+// CRC (with CRC_EXTRA) in one pass and hand out views.
+// Stream transports keep using the byte-wise parser.
+// -------------------------------------------------
+class MavlinkFrameScanner {
+public:
+    struct Stats {
+        uint64_t frames_ok = 0;
+        uint64_t crc_errors = 0;
+        uint64_t unknown_msgid = 0;
+        uint64_t truncated = 0;
+        uint64_t malformed = 0;        // unknown incompat flags, bad payload length
+        uint64_t bytes_skipped = 0;    // garbage between frames
+    };
+
+    // Invokes on_frame(const MavlinkFrameView&) for every valid frame.
+    // Returns the number of frames delivered.
+    template <typename OnFrame>
+    size_t scan(const uint8_t* buf, size_t len, OnFrame&& on_frame);
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    static constexpr size_t V1_HEADER_LEN = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+    static constexpr size_t V2_HEADER_LEN = MAVLINK_NUM_HEADER_BYTES;
+
+    // Returns the frame length, 0 to resync one byte on, or
+    // SIZE_MAX when the buffer ends mid-frame (also resyncs, in
+    // case the STX was a stray byte).
+    size_t check(const uint8_t* p, size_t avail, MavlinkFrameView& view);
+
+    Stats stats_;
+};
+
+template <typename OnFrame>
+size_t MavlinkFrameScanner::scan(const uint8_t* buf, size_t len, OnFrame&& on_frame) {
+    size_t delivered = 0;
+    size_t i = 0;
+
+    while (i < len) {
+        const uint8_t b = buf[i];
+        if (b != MAVLINK_STX && b != MAVLINK_STX_MAVLINK1) {
+            stats_.bytes_skipped++;
+            i++;
+            continue;
+        }
+
+        MavlinkFrameView view;
+        const size_t n = check(buf + i, len - i, view);
+
+        if (n == SIZE_MAX)
+            stats_.truncated++;
+
+        if (n == 0 || n == SIZE_MAX) {
+            i++;
+            continue;
+        }
+
+        stats_.frames_ok++;
+        delivered++;
+        on_frame(static_cast<const MavlinkFrameView&>(view));
+        i += n;
+    }
+
+    return delivered;
+}
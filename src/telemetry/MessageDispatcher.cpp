@@ -0,0 +1,59 @@
+#include "telemetry/MessageDispatcher.h"
+#include "telemetry/TelemetryHandlers.h"
+
+MessageDispatcher& MessageDispatcher::shared() {
+    static MessageDispatcher dispatcher(builtinTelemetryHandlers());
+    return dispatcher;
+}
+
+bool MessageDispatcher::registerHandler(uint32_t msgid, MessageHandler handler) {
+    if (msgid < DISPATCH_TABLE_SIZE) {
+        table_[msgid] = handler;
+        return true;
+    }
+
+    for (size_t i = 0; i < extended_count_; i++) {
+        if (extended_[i].msgid == msgid) {
+            extended_[i].handler = handler;
+            return true;
+        }
+    }
+
+    if (extended_count_ >= DISPATCH_EXTENDED_MAX)
+        return false;
+
+    extended_[extended_count_++] = Extended{msgid, handler, 0};
+    return true;
+}
+
+bool MessageDispatcher::dispatchExtended(
+    const MavlinkFrameView& frame,
+    TelemetryContext& ctx) {
+
+    for (size_t i = 0; i < extended_count_; i++) {
+        Extended& e = extended_[i];
+        if (e.msgid != frame.msgid)
+            continue;
+
+        e.hits++;
+        if (!e.handler)
+            break;
+
+        e.handler(frame, ctx);
+        return true;
+    }
+
+    unhandled_++;
+    return false;
+}
+
+uint64_t MessageDispatcher::hits(uint32_t msgid) const {
+    if (msgid < DISPATCH_TABLE_SIZE)
+        return hits_[msgid];
+
+    for (size_t i = 0; i < extended_count_; i++) {
+        if (extended_[i].msgid == msgid)
+            return extended_[i].hits;
+    }
+    return 0;
+}
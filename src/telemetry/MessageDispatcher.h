@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "telemetry/MavlinkFrameScanner.h"
+#include "telemetry/TelemetryData.h"
+
+class StateManager;
+class TelemetryHistory;
+
+// Per-vehicle storage a handler decodes into
+struct TelemetryContext {
+    TelemetryData& telemetry;
+    StateManager& stateManager;
+    TelemetryHistory& history;
+    CommandAckQueue& acks;
+    MissionEventQueue& missions;
+    ParamEventQueue& params;
+    StreamAckQueue& stream_acks;
+};
+
+using MessageHandler = void (*)(const MavlinkFrameView&, TelemetryContext&);
+
+struct HandlerBinding {
+    uint32_t msgid;
+    MessageHandler handler;
+};
+
+// Common-dialect ids are all below this; anything higher goes to the
+// small extended list (e.g. 12900+ OPEN_DRONE_ID).
+static constexpr size_t DISPATCH_TABLE_SIZE = 512;
+static constexpr size_t DISPATCH_EXTENDED_MAX = 16;
+
+using DispatchTable = std::array<MessageHandler, DISPATCH_TABLE_SIZE>;
+
+// Builds a msgid-indexed table at compile time from a binding list
+template <size_t N>
+constexpr DispatchTable makeDispatchTable(const HandlerBinding (&bindings)[N]) {
+    DispatchTable table{};
+    for (size_t i = 0; i < N; i++) {
+        if (bindings[i].msgid < DISPATCH_TABLE_SIZE)
+            table[bindings[i].msgid] = bindings[i].handler;
+    }
+    return table;
+}
+
+// -------------------------------------------------
+// msgid -> handler dispatch with per-msgid hit counters.
+// Frames without a handler are counted and dropped
+// before any payload decoding happens.
+// -------------------------------------------------
+class MessageDispatcher {
+public:
+    MessageDispatcher() = default;
+    explicit MessageDispatcher(const DispatchTable& table) : table_(table) {}
+
+    // Process-wide dispatcher preloaded with the built-in telemetry handlers
+    static MessageDispatcher& shared();
+
+    // Startup-time registration; replaces any existing handler
+    bool registerHandler(uint32_t msgid, MessageHandler handler);
+
+    bool dispatch(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+        if (frame.msgid < DISPATCH_TABLE_SIZE) {
+            hits_[frame.msgid]++;
+
+            MessageHandler h = table_[frame.msgid];
+            if (!h) {
+                unhandled_++;
+                return false;
+            }
+            h(frame, ctx);
+            return true;
+        }
+        return dispatchExtended(frame, ctx);
+    }
+
+    // Frames seen for msgid, handled or not (ids past the table only
+    // count once a handler is registered; see unhandled())
+    uint64_t hits(uint32_t msgid) const;
+    uint64_t unhandled() const { return unhandled_; }
+
+private:
+    struct Extended {
+        uint32_t msgid;
+        MessageHandler handler;
+        uint64_t hits;
+    };
+
+    bool dispatchExtended(const MavlinkFrameView& frame, TelemetryContext& ctx);
+
+    DispatchTable table_{};
+    std::array<uint64_t, DISPATCH_TABLE_SIZE> hits_{};
+
+    Extended extended_[DISPATCH_EXTENDED_MAX]{};
+    size_t extended_count_ = 0;
+
+    uint64_t unhandled_ = 0;
+};
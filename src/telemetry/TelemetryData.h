@@ -1,8 +1,11 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 
+#include "core/SpscRing.h"
+
 extern "C" {
 #include "mavlink/common/mavlink.h"
 }
@@ -11,8 +14,47 @@ extern "C" {
 struct CommandAckData {
     uint16_t command_id = 0;
     uint8_t result = MAV_RESULT_FAILED;
-    bool valid = false;
+    uint8_t source_sysid = 0;
+    uint8_t source_compid = 0;
+};
+
+// Parser -> CommandManager hand-off: one producer, one consumer,
+// every ACK delivered exactly once.
+static constexpr size_t COMMAND_ACK_QUEUE_DEPTH = 16;
+using CommandAckQueue = SpscRing<CommandAckData, COMMAND_ACK_QUEUE_DEPTH>;
+
+/* ---------- Mission transfer ---------- */
+// Mission protocol traffic addressed to the GCS, parser -> MissionTransfer
+enum class MissionEventType : uint8_t {
+    REQUEST,    // vehicle wants item `value` (upload)
+    COUNT,      // vehicle holds `value` items (download)
+    ITEM,       // one item (download)
+    ACK         // transfer finished with MAV_MISSION_RESULT `value`
+};
+
+struct MissionEvent {
+    MissionEventType type = MissionEventType::ACK;
+    uint16_t value = 0;
+    mavlink_mission_item_int_t item{};      // ITEM only
 };
+
+// Deeper than the download window, so a full window of replies fits
+static constexpr size_t MISSION_EVENT_QUEUE_DEPTH = 64;
+using MissionEventQueue = SpscRing<MissionEvent, MISSION_EVENT_QUEUE_DEPTH>;
+
+/* ---------- Parameters ---------- */
+// Every PARAM_VALUE from the vehicle, parser -> ParamTransfer. Deep
+// enough for a streamed list to pile up between two control passes;
+// whatever is dropped shows up as a gap and gets read again.
+static constexpr size_t PARAM_EVENT_QUEUE_DEPTH = 256;
+using ParamEventQueue = SpscRing<mavlink_param_value_t, PARAM_EVENT_QUEUE_DEPTH>;
+
+/* ---------- Stream rates ---------- */
+// COMMAND_ACKs for SET_MESSAGE_INTERVAL, parser -> StreamRates. Kept
+// apart from the command queue: one command id, many streams.
+static constexpr size_t STREAM_ACK_QUEUE_DEPTH = 8;
+using StreamAckQueue = SpscRing<CommandAckData, STREAM_ACK_QUEUE_DEPTH>;
+
 enum class ArmState {
     DISARMED,
     ARMED
@@ -42,14 +84,37 @@ enum class CommandBlockReason {
     FAILSAFE_ACTIVE,
     VEHICLE_NOT_ARMED,
     VEHICLE_NOT_LANDED,
+    NO_HEARTBEAT,
+    VEHICLE_ARMED,
+    VEHICLE_NOT_AIRBORNE,
     UNKNOWN
 };
 
+// Readiness packed into one word, kept in step with the fields of
+// TelemetryData by the parser. Bit order is block-reason priority:
+// when several preconditions fail, the lowest bit is reported.
+struct VehicleStatus {
+    static constexpr uint32_t LINK_LOST          = 1u << 0;   // control side only
+    static constexpr uint32_t FAILSAFE           = 1u << 1;
+    static constexpr uint32_t HEARTBEAT          = 1u << 2;
+    static constexpr uint32_t EKF_OK             = 1u << 3;
+    static constexpr uint32_t BATTERY_OK         = 1u << 4;
+    static constexpr uint32_t LANDED             = 1u << 5;
+    static constexpr uint32_t AIRBORNE           = 1u << 6;
+    static constexpr uint32_t ARMED              = 1u << 7;
+
+    static constexpr uint32_t EKF_RECEIVED       = 1u << 8;
+    static constexpr uint32_t BATTERY_RECEIVED   = 1u << 9;
+    static constexpr uint32_t EXT_STATE_RECEIVED = 1u << 10;
+
+    static constexpr int BITS = 11;
+
+    static constexpr uint32_t READY =
+        HEARTBEAT | EKF_RECEIVED | BATTERY_RECEIVED | EXT_STATE_RECEIVED;
+};
 
-struct TelemetryData {
 
-    // ---------- Command ACK ----------
-    CommandAckData last_command_ack;
+struct TelemetryData {
 
     // ---------- Connection ----------
     bool heartbeat_received = false;
@@ -73,9 +138,6 @@ struct TelemetryData {
     FlightPhase flight_phase = FlightPhase::UNKNOWN;
     bool extended_state_received = false;
 
-    // ✅ Phase 5: WHY command is blocked
-    CommandBlockReason last_block_reason =
-        CommandBlockReason::NONE;
     // ---------- Phase 5: STATUSTEXT ----------
     bool preflight_ok = false;
     std::chrono::steady_clock::time_point last_preflight_clear_time;
@@ -83,13 +145,37 @@ struct TelemetryData {
     // Last human-readable reason from PX4
     char last_status_text[50] = {0};
 
+    // ---------- High-rate streams (decoded in place) ----------
+    mavlink_attitude_t attitude{};
+    mavlink_global_position_int_t position{};
+    mavlink_radio_status_t radio{};
+    bool attitude_received = false;
+    bool position_received = false;
+    bool radio_received = false;
+
+    // ---------- Mission / parameter progress ----------
+    mavlink_mission_current_t mission_current{};
+    uint16_t mission_count = 0;
+    uint8_t last_mission_ack = MAV_MISSION_ACCEPTED;
+    bool mission_ack_received = false;
+
+    mavlink_param_value_t last_param{};
+    uint32_t param_values_received = 0;
+
+    // Firmware identity; keys the parameter cache
+    mavlink_autopilot_version_t autopilot_version{};
+    bool autopilot_version_received = false;
+
 
     // ---------- Derived ----------
+    uint32_t status = 0;    // VehicleStatus bits
+
+    void setStatus(uint32_t bits, bool on) {
+        status = on ? (status | bits) : (status & ~bits);
+    }
+
     bool isTelemetryReady() const {
-        return heartbeat_received &&
-               ekf_received &&
-               battery_received &&
-               extended_state_received;
+        return (status & VehicleStatus::READY) == VehicleStatus::READY;
     }
 
     bool isAirborne() const {
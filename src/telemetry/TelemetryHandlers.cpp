@@ -0,0 +1,367 @@
+#include "telemetry/TelemetryHandlers.h"
+#include "telemetry/TelemetryData.h"
+#include "telemetry/TelemetryHistory.h"
+#include "core/GcsClock.h"
+#include "core/StateManager.h"
+#include "core/Logger.h"
+#include "core/Metrics.h"
+#include "comm/GcsIdentity.h"
+
+#include <chrono>
+#include <cstring>
+
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+static float asSample(bool v) { return v ? 1.0f : 0.0f; }
+
+template <typename E>
+static float asSample(E v) { return static_cast<float>(static_cast<int>(v)); }
+
+// ================= HEARTBEAT =================
+void handleHeartbeat(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+
+    // ❌ Ignore our own GCS heartbeat
+    if (isGcsSystemId(frame.sysid))
+        return;
+
+    TelemetryData& telemetry = ctx.telemetry;
+
+    mavlink_heartbeat_t hb;
+    decodePayload(frame, hb);
+
+    telemetry.system_id = frame.sysid;
+    telemetry.component_id = frame.compid;
+    telemetry.heartbeat_received = true;
+    telemetry.last_heartbeat_time =
+        GcsClock::now();
+
+    const int64_t now_us = GcsClock::micros(telemetry.last_heartbeat_time);
+
+    // ---- ARM STATE ----
+    telemetry.arm_state =
+        (hb.base_mode & MAV_MODE_FLAG_SAFETY_ARMED)
+            ? ArmState::ARMED
+            : ArmState::DISARMED;
+
+    // ---- FAILSAFE ----
+    telemetry.in_failsafe =
+        (hb.system_status == MAV_STATE_CRITICAL ||
+         hb.system_status == MAV_STATE_EMERGENCY);
+
+    telemetry.setStatus(VehicleStatus::HEARTBEAT, true);
+    telemetry.setStatus(VehicleStatus::ARMED, telemetry.arm_state == ArmState::ARMED);
+    telemetry.setStatus(VehicleStatus::FAILSAFE, telemetry.in_failsafe);
+
+    ctx.history.record(HistoryField::ARM_STATE, now_us, asSample(telemetry.arm_state));
+    ctx.history.record(HistoryField::IN_FAILSAFE, now_us, asSample(telemetry.in_failsafe));
+
+    // DISCONNECTED -> CONNECTED is taken by the control path once it
+    // sees heartbeat_received, so the parser never writes SystemState.
+    // Registration is logged once by the fleet; this is per heartbeat.
+    LOG_DEBUG("HEARTBEAT", "SysID {} heartbeat", frame.sysid);
+}
+
+// ================= BATTERY =================
+void handleSysStatus(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+
+    TelemetryData& telemetry = ctx.telemetry;
+
+    mavlink_sys_status_t sys;
+    decodePayload(frame, sys);
+
+    telemetry.battery_ok =
+        (sys.battery_remaining > 20) ||
+        (sys.battery_remaining == -1);
+
+    telemetry.battery_received = true;
+
+    telemetry.setStatus(VehicleStatus::BATTERY_OK, telemetry.battery_ok);
+    telemetry.setStatus(VehicleStatus::BATTERY_RECEIVED, true);
+
+    const int64_t now_us = GcsClock::micros(GcsClock::now());
+    ctx.history.record(HistoryField::BATTERY_OK, now_us, asSample(telemetry.battery_ok));
+    ctx.history.record(HistoryField::BATTERY_REMAINING, now_us, sys.battery_remaining);
+}
+
+// ================= EKF =================
+void handleEstimatorStatus(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+
+    TelemetryData& telemetry = ctx.telemetry;
+
+    mavlink_estimator_status_t est;
+    decodePayload(frame, est);
+
+    constexpr uint16_t EST_ATT_OK = 1 << 0;
+    constexpr uint16_t EST_VEL_OK = 1 << 1;
+
+    telemetry.ekf_ok =
+        (est.flags & EST_ATT_OK) &&
+        (est.flags & EST_VEL_OK);
+
+    telemetry.ekf_received = true;
+
+    telemetry.setStatus(VehicleStatus::EKF_OK, telemetry.ekf_ok);
+    telemetry.setStatus(VehicleStatus::EKF_RECEIVED, true);
+
+    ctx.history.record(HistoryField::EKF_OK,
+        GcsClock::micros(GcsClock::now()), asSample(telemetry.ekf_ok));
+}
+
+// ================= LANDED / AIRBORNE =================
+void handleExtendedSysState(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+
+    TelemetryData& telemetry = ctx.telemetry;
+
+    mavlink_extended_sys_state_t ext;
+    decodePayload(frame, ext);
+
+    telemetry.extended_state_received = true;
+
+    switch (ext.landed_state) {
+    case MAV_LANDED_STATE_ON_GROUND:
+        telemetry.flight_phase = FlightPhase::ON_GROUND;
+        break;
+
+    case MAV_LANDED_STATE_TAKEOFF:
+        telemetry.flight_phase = FlightPhase::TAKING_OFF;
+        break;
+
+    case MAV_LANDED_STATE_IN_AIR:
+        telemetry.flight_phase = FlightPhase::IN_AIR;
+        break;
+
+    case MAV_LANDED_STATE_LANDING:
+        telemetry.flight_phase = FlightPhase::LANDING;
+        break;
+
+    default:
+        telemetry.flight_phase = FlightPhase::UNKNOWN;
+        break;
+    }
+
+    telemetry.setStatus(VehicleStatus::LANDED, telemetry.isLanded());
+    telemetry.setStatus(VehicleStatus::AIRBORNE, telemetry.isAirborne());
+    telemetry.setStatus(VehicleStatus::EXT_STATE_RECEIVED, true);
+
+    ctx.history.record(HistoryField::FLIGHT_PHASE,
+        GcsClock::micros(GcsClock::now()), asSample(telemetry.flight_phase));
+}
+
+// ================= COMMAND ACK =================
+// Router clients command the same vehicles; their ACKs are not ours.
+// Autopilots that predate the target fields leave them 0.
+static bool isOurCommandAck(const mavlink_command_ack_t& ack) {
+    return ack.target_system == GCS_COMMAND_SYS_ID || ack.target_system == 0;
+}
+
+void handleCommandAck(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+
+    mavlink_command_ack_t ack;
+    decodePayload(frame, ack);
+
+    if (!isOurCommandAck(ack))
+        return;
+
+    CommandAckData data;
+    data.command_id = ack.command;
+    data.result = ack.result;
+    data.source_sysid = frame.sysid;
+    data.source_compid = frame.compid;
+
+    // Interval ACKs belong to StreamRates, not the command table
+    if (ack.command == MAV_CMD_SET_MESSAGE_INTERVAL) {
+        if (!ctx.stream_acks.push(data))
+            Metrics::local().add(Counter::ACK_QUEUE_DROPS);
+        return;
+    }
+
+    if (!ctx.acks.push(data)) {
+        Metrics::local().add(Counter::ACK_QUEUE_DROPS);
+        LOG_WARN("ACK", "Queue full, CMD={} dropped", ack.command);
+        return;
+    }
+
+    LOG_INFO("ACK", "CMD={} RESULT={}", ack.command, ack.result);
+}
+
+// ================= STATUSTEXT (LOGGING ONLY) =================
+void handleStatusText(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+
+    TelemetryData& telemetry = ctx.telemetry;
+
+    mavlink_statustext_t st;
+    decodePayload(frame, st);
+
+    std::strncpy(
+        telemetry.last_status_text,
+        reinterpret_cast<char*>(st.text),
+        sizeof(telemetry.last_status_text) - 1
+    );
+
+    telemetry.last_status_text[
+        sizeof(telemetry.last_status_text) - 1] = '\0';
+
+    LOG_INFO("PX4", "{}", telemetry.last_status_text);
+}
+
+// ================= ATTITUDE / POSITION / RADIO =================
+// Wire layout equals the struct, so these decode straight into
+// TelemetryData without an intermediate copy. The history store
+// decimates altitude and RSSI, so recording every frame is cheap.
+void handleAttitude(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+    decodePayload(frame, ctx.telemetry.attitude);
+    ctx.telemetry.attitude_received = true;
+}
+
+void handleGlobalPositionInt(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+    decodePayload(frame, ctx.telemetry.position);
+    ctx.telemetry.position_received = true;
+
+    ctx.history.record(HistoryField::RELATIVE_ALT,
+        GcsClock::micros(GcsClock::now()),
+        ctx.telemetry.position.relative_alt * 1e-3f);
+}
+
+void handleRadioStatus(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+    decodePayload(frame, ctx.telemetry.radio);
+    ctx.telemetry.radio_received = true;
+
+    ctx.history.record(HistoryField::RSSI,
+        GcsClock::micros(GcsClock::now()), ctx.telemetry.radio.rssi);
+}
+
+// ================= MISSION =================
+// Transfer traffic meant for another GCS, or for fence/rally
+// lists, is left alone; the rest is handed to MissionTransfer.
+static bool isOurMissionReply(uint8_t target_system, uint8_t mission_type) {
+    return (target_system == GCS_COMMAND_SYS_ID || target_system == 0) &&
+           mission_type == MAV_MISSION_TYPE_MISSION;
+}
+
+static void pushMissionEvent(TelemetryContext& ctx, const MissionEvent& ev) {
+    if (!ctx.missions.push(ev)) {
+        Metrics::local().add(Counter::MISSION_EVENT_DROPS);
+        LOG_WARN("MISSION", "Event queue full, type {} dropped", static_cast<int>(ev.type));
+    }
+}
+
+void handleMissionCurrent(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+    decodePayload(frame, ctx.telemetry.mission_current);
+}
+
+void handleMissionCount(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+    mavlink_mission_count_t count;
+    decodePayload(frame, count);
+    ctx.telemetry.mission_count = count.count;
+
+    if (!isOurMissionReply(count.target_system, count.mission_type))
+        return;
+
+    MissionEvent ev;
+    ev.type = MissionEventType::COUNT;
+    ev.value = count.count;
+    pushMissionEvent(ctx, ev);
+}
+
+void handleMissionAck(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+    mavlink_mission_ack_t ack;
+    decodePayload(frame, ack);
+    ctx.telemetry.last_mission_ack = ack.type;
+    ctx.telemetry.mission_ack_received = true;
+
+    if (!isOurMissionReply(ack.target_system, ack.mission_type))
+        return;
+
+    MissionEvent ev;
+    ev.type = MissionEventType::ACK;
+    ev.value = ack.type;
+    pushMissionEvent(ctx, ev);
+}
+
+// MISSION_REQUEST and MISSION_REQUEST_INT share a wire layout;
+// either way the reply is a MISSION_ITEM_INT
+void handleMissionRequest(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+    mavlink_mission_request_int_t req;
+    decodePayload(frame, req);
+
+    if (!isOurMissionReply(req.target_system, req.mission_type))
+        return;
+
+    MissionEvent ev;
+    ev.type = MissionEventType::REQUEST;
+    ev.value = req.seq;
+    pushMissionEvent(ctx, ev);
+}
+
+void handleMissionItemInt(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+    MissionEvent ev;
+    ev.type = MissionEventType::ITEM;
+    decodePayload(frame, ev.item);
+
+    if (!isOurMissionReply(ev.item.target_system, ev.item.mission_type))
+        return;
+
+    ev.value = ev.item.seq;
+    pushMissionEvent(ctx, ev);
+}
+
+// ================= PARAMETERS =================
+// PARAM_VALUE is broadcast: every one goes to ParamTransfer
+void handleParamValue(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+    decodePayload(frame, ctx.telemetry.last_param);
+    ctx.telemetry.param_values_received++;
+
+    if (!ctx.params.push(ctx.telemetry.last_param))
+        Metrics::local().add(Counter::PARAM_EVENT_DROPS);
+}
+
+void handleAutopilotVersion(const MavlinkFrameView& frame, TelemetryContext& ctx) {
+    decodePayload(frame, ctx.telemetry.autopilot_version);
+    ctx.telemetry.autopilot_version_received = true;
+}
+
+// -------------------------------------------------
+static constexpr HandlerBinding BUILTIN_HANDLERS[] = {
+    { MAVLINK_MSG_ID_HEARTBEAT,           handleHeartbeat },
+    { MAVLINK_MSG_ID_SYS_STATUS,          handleSysStatus },
+    { MAVLINK_MSG_ID_ESTIMATOR_STATUS,    handleEstimatorStatus },
+    { MAVLINK_MSG_ID_EXTENDED_SYS_STATE,  handleExtendedSysState },
+    { MAVLINK_MSG_ID_COMMAND_ACK,         handleCommandAck },
+    { MAVLINK_MSG_ID_STATUSTEXT,          handleStatusText },
+    { MAVLINK_MSG_ID_ATTITUDE,            handleAttitude },
+    { MAVLINK_MSG_ID_GLOBAL_POSITION_INT, handleGlobalPositionInt },
+    { MAVLINK_MSG_ID_RADIO_STATUS,        handleRadioStatus },
+    { MAVLINK_MSG_ID_MISSION_CURRENT,     handleMissionCurrent },
+    { MAVLINK_MSG_ID_MISSION_COUNT,       handleMissionCount },
+    { MAVLINK_MSG_ID_MISSION_ACK,         handleMissionAck },
+    { MAVLINK_MSG_ID_MISSION_REQUEST,     handleMissionRequest },
+    { MAVLINK_MSG_ID_MISSION_REQUEST_INT, handleMissionRequest },
+    { MAVLINK_MSG_ID_MISSION_ITEM_INT,    handleMissionItemInt },
+    { MAVLINK_MSG_ID_PARAM_VALUE,         handleParamValue },
+    { MAVLINK_MSG_ID_AUTOPILOT_VERSION,   handleAutopilotVersion },
+};
+
+static constexpr DispatchTable BUILTIN_TABLE = makeDispatchTable(BUILTIN_HANDLERS);
+
+const DispatchTable& builtinTelemetryHandlers() {
+    return BUILTIN_TABLE;
+}
+
+// What the handlers above decode, and how fresh it has to be.
+// Landed state gates the launch sequence, so it runs fastest.
+void requestTelemetryStreams(StreamPlan& plan) {
+    static constexpr struct { uint32_t msgid; float hz; } STREAMS[] = {
+        { MAVLINK_MSG_ID_SYS_STATUS,          2.0f },
+        { MAVLINK_MSG_ID_ESTIMATOR_STATUS,    2.0f },
+        { MAVLINK_MSG_ID_EXTENDED_SYS_STATE,  5.0f },
+        { MAVLINK_MSG_ID_ATTITUDE,            5.0f },
+        { MAVLINK_MSG_ID_GLOBAL_POSITION_INT, 5.0f },
+        { MAVLINK_MSG_ID_RADIO_STATUS,        1.0f },
+        { MAVLINK_MSG_ID_MISSION_CURRENT,     1.0f },
+    };
+
+    for (const auto& s : STREAMS)
+        plan.request(StreamConsumer::PARSER, s.msgid, s.hz);
+}
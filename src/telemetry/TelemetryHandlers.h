@@ -0,0 +1,28 @@
+#pragma once
+
+#include "stream/StreamPlan.h"
+#include "telemetry/MessageDispatcher.h"
+
+// Built-in handlers, one per telemetry message the GCS consumes
+void handleHeartbeat(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleSysStatus(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleEstimatorStatus(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleExtendedSysState(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleCommandAck(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleStatusText(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleAttitude(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleGlobalPositionInt(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleRadioStatus(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleMissionCurrent(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleMissionCount(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleMissionAck(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleMissionRequest(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleMissionItemInt(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleParamValue(const MavlinkFrameView& frame, TelemetryContext& ctx);
+void handleAutopilotVersion(const MavlinkFrameView& frame, TelemetryContext& ctx);
+
+// Compile-time table of the handlers above
+const DispatchTable& builtinTelemetryHandlers();
+
+// Declares the periodic messages those handlers consume
+void requestTelemetryStreams(StreamPlan& plan);
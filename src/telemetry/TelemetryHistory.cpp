@@ -0,0 +1,166 @@
+#include "telemetry/TelemetryHistory.h"
+
+#include <algorithm>
+
+static size_t nextPow2(size_t n) {
+    size_t p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+void TelemetryHistory::configure(const HistoryConfig& config) {
+    cap = config.capacity ? nextPow2(config.capacity) : 0;
+    mask = cap ? cap - 1 : 0;
+    analog_interval_us = config.analog_interval_us;
+
+    times.reset(cap ? new int64_t[cap * HISTORY_FIELD_COUNT] : nullptr);
+    values.reset(cap ? new float[cap * HISTORY_FIELD_COUNT] : nullptr);
+
+    for (Series& s : series)
+        s = Series{};
+}
+
+void TelemetryHistory::append(
+    HistoryField field,
+    Series& s,
+    int64_t t_us,
+    float value) {
+
+    // Virtual time may stall but never goes back; keep the column sorted
+    if (s.count != 0 && t_us < s.last_us)
+        t_us = s.last_us;
+
+    const size_t base = static_cast<size_t>(field) * cap;
+    times[base + s.next] = t_us;
+    values[base + s.next] = value;
+
+    s.next = (s.next + 1) & mask;
+    if (s.count < cap)
+        s.count++;
+
+    s.last_us = t_us;
+    s.last_value = value;
+}
+
+int64_t TelemetryHistory::timeAt(HistoryField field, const Series& s, size_t i) const {
+    return times[static_cast<size_t>(field) * cap + physical(s, i)];
+}
+
+float TelemetryHistory::valueOf(HistoryField field, const Series& s, size_t i) const {
+    return values[static_cast<size_t>(field) * cap + physical(s, i)];
+}
+
+size_t TelemetryHistory::upperBound(
+    HistoryField field,
+    const Series& s,
+    int64_t t_us) const {
+
+    size_t lo = 0;
+    size_t hi = s.count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (timeAt(field, s, mid) <= t_us)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+bool TelemetryHistory::valueAt(HistoryField field, int64_t t_us, float* out) const {
+    if (cap == 0)
+        return false;
+
+    const Series& s = series[static_cast<size_t>(field)];
+    size_t i = upperBound(field, s, t_us);
+    if (i == 0)
+        return false;
+
+    *out = valueOf(field, s, i - 1);
+    return true;
+}
+
+size_t TelemetryHistory::query(
+    HistoryField field,
+    int64_t from_us,
+    int64_t to_us,
+    int64_t bucket_us,
+    HistoryBucket* out,
+    size_t max_buckets) const {
+
+    if (cap == 0 || bucket_us <= 0 || to_us <= from_us || max_buckets == 0)
+        return 0;
+
+    const Series& s = series[static_cast<size_t>(field)];
+    if (s.count == 0)
+        return 0;
+
+    // Sample in force at from_us (if any), then walk forward once
+    size_t i = upperBound(field, s, from_us);
+    bool have = i > 0;
+    float held = have ? valueOf(field, s, i - 1) : 0.0f;
+
+    size_t written = 0;
+    for (int64_t start = from_us; start < to_us && written < max_buckets;
+         start += bucket_us) {
+
+        const int64_t end = std::min(start + bucket_us, to_us);
+
+        HistoryBucket b{start, held, held, held, 0};
+
+        for (; i < s.count && timeAt(field, s, i) < end; i++) {
+            float v = valueOf(field, s, i);
+            if (!have) {
+                b.min = b.max = v;
+                have = true;
+            }
+            b.min = std::min(b.min, v);
+            b.max = std::max(b.max, v);
+            b.last = v;
+            b.samples++;
+        }
+
+        if (!have)
+            continue;
+
+        held = b.last;
+        out[written++] = b;
+    }
+
+    return written;
+}
+
+int64_t TelemetryHistory::timeAtValue(
+    HistoryField field,
+    float value,
+    int64_t from_us,
+    int64_t to_us) const {
+
+    if (cap == 0 || to_us <= from_us)
+        return 0;
+
+    const Series& s = series[static_cast<size_t>(field)];
+
+    size_t i = upperBound(field, s, from_us);
+    bool have = i > 0;
+    float held = have ? valueOf(field, s, i - 1) : 0.0f;
+    int64_t since = from_us;
+    int64_t total = 0;
+
+    for (; i < s.count; i++) {
+        int64_t t = timeAt(field, s, i);
+        if (t >= to_us)
+            break;
+        if (have && held == value)
+            total += t - since;
+        held = valueOf(field, s, i);
+        have = true;
+        since = t;
+    }
+
+    if (have && held == value)
+        total += to_us - since;
+
+    return total;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Tracked fields; each gets its own timestamp + value column
+enum class HistoryField : uint8_t {
+    EKF_OK,
+    BATTERY_OK,
+    BATTERY_REMAINING,    // %
+    ARM_STATE,            // ArmState
+    IN_FAILSAFE,
+    FLIGHT_PHASE,         // FlightPhase
+    RELATIVE_ALT,         // m
+    RSSI,
+    COUNT
+};
+
+static constexpr size_t HISTORY_FIELD_COUNT =
+    static_cast<size_t>(HistoryField::COUNT);
+
+struct HistoryConfig {
+    // Samples kept per field (rounded up to a power of two); 0 disables
+    size_t capacity = 4096;
+
+    // Continuous fields (altitude, battery %, RSSI) are also decimated
+    // to at most one sample per interval: a change inside the interval
+    // replaces the newest sample's value. Discrete fields never are.
+    int64_t analog_interval_us = 2'000'000;
+};
+
+// One downsampled window. Values are step-held: a bucket
+// without samples repeats the value carried in from before.
+struct HistoryBucket {
+    int64_t start_us;
+    float min;
+    float max;
+    float last;
+    uint32_t samples;     // samples that fell inside the bucket
+};
+
+// -------------------------------------------------
+// Per-vehicle columnar ring store. Every field owns a
+// fixed-capacity timestamp column and value column,
+// allocated once at registration; writes are change-
+// driven and never allocate. Timestamps only grow, so
+// range queries binary-search the ring.
+// -------------------------------------------------
+class TelemetryHistory {
+public:
+    TelemetryHistory() = default;
+
+    // Allocates the columns; called once per vehicle, off the hot path
+    void configure(const HistoryConfig& config);
+
+    bool enabled() const { return cap != 0; }
+
+    // Appends only when the value differs from the newest sample
+    void record(HistoryField field, int64_t t_us, float value) {
+        if (cap == 0)
+            return;
+
+        Series& s = series[static_cast<size_t>(field)];
+        if (s.count != 0) {
+            if (value == s.last_value)
+                return;
+
+            // Keep the value in force rather than the interval's first
+            if (isAnalog(field) && t_us - s.last_us < analog_interval_us) {
+                values[static_cast<size_t>(field) * cap + physical(s, s.count - 1)] = value;
+                s.last_value = value;
+                return;
+            }
+        }
+        append(field, s, t_us, value);
+    }
+
+    size_t size(HistoryField field) const {
+        return series[static_cast<size_t>(field)].count;
+    }
+
+    // Step-held value at t_us; false before the first sample
+    bool valueAt(HistoryField field, int64_t t_us, float* out) const;
+
+    // Downsamples [from_us, to_us) into buckets of bucket_us.
+    // Buckets before the first sample are skipped. Returns the
+    // number of buckets written (at most max_buckets).
+    size_t query(
+        HistoryField field,
+        int64_t from_us,
+        int64_t to_us,
+        int64_t bucket_us,
+        HistoryBucket* out,
+        size_t max_buckets) const;
+
+    // Total time in [from_us, to_us) the field held exactly value
+    int64_t timeAtValue(
+        HistoryField field,
+        float value,
+        int64_t from_us,
+        int64_t to_us) const;
+
+    // Bytes held by the columns
+    size_t memoryBytes() const {
+        return cap * HISTORY_FIELD_COUNT * (sizeof(int64_t) + sizeof(float));
+    }
+
+private:
+    struct Series {
+        size_t next = 0;          // physical write position
+        size_t count = 0;
+        int64_t last_us = 0;
+        float last_value = 0.0f;
+    };
+
+    static bool isAnalog(HistoryField field) {
+        return field == HistoryField::BATTERY_REMAINING ||
+               field == HistoryField::RELATIVE_ALT ||
+               field == HistoryField::RSSI;
+    }
+
+    void append(HistoryField field, Series& s, int64_t t_us, float value);
+
+    // Logical index 0 = oldest sample
+    size_t physical(const Series& s, size_t i) const {
+        return (s.next - s.count + i) & mask;
+    }
+    int64_t timeAt(HistoryField field, const Series& s, size_t i) const;
+    float valueOf(HistoryField field, const Series& s, size_t i) const;
+
+    // First logical index with timestamp > t_us
+    size_t upperBound(HistoryField field, const Series& s, int64_t t_us) const;
+
+    size_t cap = 0;
+    size_t mask = 0;
+    int64_t analog_interval_us = 0;
+
+    // Column f occupies [f * cap, (f + 1) * cap)
+    std::unique_ptr<int64_t[]> times;
+    std::unique_ptr<float[]> values;
+
+    Series series[HISTORY_FIELD_COUNT];
+};
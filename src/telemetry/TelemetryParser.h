@@ -1,13 +1,37 @@
 #pragma once
 #include "TelemetryData.h"
+#include "MavlinkFrameScanner.h"
+#include "MessageDispatcher.h"
+#include "TelemetryHistory.h"
 #include "core/StateManager.h"
 
+extern "C" {
+#include "mavlink/common/mavlink.h"
+}
+
+// One parser per vehicle: framing state lives in the instance,
+// so interleaved links never share a MAVLink channel.
 class TelemetryParser {
 public:
-    TelemetryParser(TelemetryData& data, StateManager& stateMgr);
+    explicit TelemetryParser(
+        const TelemetryContext& context,
+        MessageDispatcher& dispatch = MessageDispatcher::shared());
+
+    // Byte-wise fallback for stream transports
     void parse(uint8_t byte);
+    void parse(const uint8_t* data, size_t len);
+
+    // Fast path: frames already validated by MavlinkFrameScanner.
+    // Routed through the msgid dispatch table; unhandled ids are
+    // counted and never decoded.
+    void handleFrame(const MavlinkFrameView& frame);
 
 private:
-    TelemetryData& telemetry;
-    StateManager& stateManager;
+    TelemetryContext ctx;
+    MessageDispatcher* dispatcher;
+
+    mavlink_message_t rx_frame{};     // in-progress frame
+    mavlink_status_t rx_status{};
+    mavlink_message_t msg{};          // last complete frame
+    mavlink_status_t msg_status{};
 };